@@ -1,12 +1,82 @@
 .section .init
 the_loading_address:
 
-mov.l main_addr, r0
+mov.l start_addr, r0
 jmp @r0
 nop
 
 .align 2
-main_addr:
-.long _main
+start_addr:
+.long _start
 load_addr:
 .long the_loading_address 
+
+!The header of the .bin (see sdk/calc/xip.hpp), the name, description, author and version follow it.
+!In a .hhk it's just data, xipBase stays 0 and the launcher only fills in appFile.
+.section .hollyhock_header, "aw"
+.align 2
+.global _xipBase
+.global _appFile
+bin_header:
+.long 0x00484842 !magic
+.long _bin_load_size
+.long _bin_bss_size
+.long _bin_xip_offset
+.long _bin_xip_size
+_xipBase:
+.long 0
+_appFile:
+.long -1 !no file
+
+.text
+.align 2
+!Copies the on-chip RAM sections (see sdk/calc/onchip.hpp and linker_bin.ld) from where they are
+!in the file to their addresses, then jumps to main. In a .hhk the launcher already did this.
+_start:
+	sts.l pr, @-r15
+	mov.l ilram_start, r4
+	mov.l ilram_load, r5
+	mov.l ilram_end, r6
+	mov.l memcpy_addr, r0
+	jsr @r0
+	sub r4, r6      !size
+	mov.l xram_start, r4
+	mov.l xram_load, r5
+	mov.l xram_end, r6
+	mov.l memcpy_addr, r0
+	jsr @r0
+	sub r4, r6
+	mov.l yram_start, r4
+	mov.l yram_load, r5
+	mov.l yram_end, r6
+	mov.l memcpy_addr, r0
+	jsr @r0
+	sub r4, r6
+	lds.l @r15+, pr
+	mov.l main_addr, r0
+	jmp @r0         !main returns straight to the launcher
+	nop
+
+.align 2
+main_addr:
+.long _main
+memcpy_addr:
+.long _memcpy
+ilram_start:
+.long _ilram_start
+ilram_end:
+.long _ilram_end
+ilram_load:
+.long _ilram_load
+xram_start:
+.long _xram_start
+xram_end:
+.long _xram_end
+xram_load:
+.long _xram_load
+yram_start:
+.long _yram_start
+yram_end:
+.long _yram_end
+yram_load:
+.long _yram_load
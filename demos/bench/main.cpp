@@ -0,0 +1,369 @@
+#include <appdef.hpp>
+#include <sdk/calc/calc.hpp>
+#include <sdk/calc/div.hpp>
+#include <sdk/calc/text.hpp>
+#include <sdk/calc/timer.hpp>
+#include <sdk/os/file.hpp>
+#include <sdk/os/input.hpp>
+#include <sdk/os/lcd.hpp>
+#include <sdk/os/mem.hpp>
+#include <sdk/os/serial.hpp>
+
+APP_NAME("Benchmark")
+APP_DESCRIPTION("Measures the speed of the SDK's drawing, memory, file and input functions. Writes the results to \\fls0\\bench.csv and the serial port.")
+APP_AUTHOR("Hollyhock contributors")
+APP_VERSION("1.0.0")
+
+#define COLOR_TEXT RGB_TO_RGB565(0, 0, 0)
+#define COLOR_BACKGROUND RGB_TO_RGB565(0x1F, 0x3F, 0x1F)
+
+const char *CSV_PATH = "\\\\fls0\\bench.csv";
+const char *TEMP_PATH = "\\\\fls0\\bench.tmp";
+
+const int MEMORY_SIZE = 64 * 1024;	// bytes per memcpy/memset
+const int FILE_SIZE = 64 * 1024;	// bytes of the temporary file
+const int FILE_BLOCK = 4096;
+
+struct Result {
+	const char *name;
+	const char *unit;	// what count counts
+	uint32_t count;
+	uint32_t micros;
+};
+
+const int MAX_RESULTS = 20;
+Result results[MAX_RESULTS];
+int numResults;
+
+// The same random numbers every run, so the runs can be compared
+uint32_t randomState;
+
+uint32_t nextRandom() {
+	randomState ^= randomState << 13;
+	randomState ^= randomState >> 17;
+	randomState ^= randomState << 5;
+	return randomState;
+}
+
+// A random number from 0 to range-1 (without a division)
+int randomBelow(int range) {
+	return ((nextRandom() & 0xFFFF) * range) >> 16;
+}
+
+void addResult(const char *name, const char *unit, uint32_t count, uint32_t start) {
+	if (numResults == MAX_RESULTS) {
+		return;
+	}
+
+	Result &result = results[numResults++];
+	result.name = name;
+	result.unit = unit;
+	result.count = count;
+	result.micros = timerMicros() - start;
+}
+
+uint32_t perSecond(const Result &result) {
+	if (result.micros == 0) {
+		return 0;
+	}
+	return udiv64((uint64_t) result.count * 1000000, result.micros);
+}
+
+void benchSetPixel() {
+	const int count = 100000;
+	randomState = 1;
+	uint32_t start = timerMicros();
+	for (int i = 0; i < count; ++i) {
+		setPixel(randomBelow(width), randomBelow(height), nextRandom());
+	}
+	addResult("setPixel", "pixels", count, start);
+}
+
+void benchOSSetPixel() {
+	const int count = 20000;
+	randomState = 1;
+	uint32_t start = timerMicros();
+	for (int i = 0; i < count; ++i) {
+		LCD_SetPixel(randomBelow(width), randomBelow(height), nextRandom());
+	}
+	addResult("LCD_SetPixel", "pixels", count, start);
+}
+
+void benchLine() {
+	randomState = 2;
+	uint32_t pixels = 0;
+	uint32_t start = timerMicros();
+	for (int i = 0; i < 2000; ++i) {
+		int x1 = randomBelow(width), y1 = randomBelow(height);
+		int x2 = randomBelow(width), y2 = randomBelow(height);
+		line(x1, y1, x2, y2, nextRandom());
+
+		int dx = x2 > x1 ? x2 - x1 : x1 - x2;
+		int dy = y2 > y1 ? y2 - y1 : y1 - y2;
+		pixels += (dx > dy ? dx : dy) + 1;
+	}
+	addResult("line", "pixels", pixels, start);
+}
+
+void benchTriangle() {
+	randomState = 3;
+	uint32_t pixels = 0;
+	uint32_t start = timerMicros();
+	for (int i = 0; i < 500; ++i) {
+		int x0 = randomBelow(width), y0 = randomBelow(height);
+		int x1 = randomBelow(width), y1 = randomBelow(height);
+		int x2 = randomBelow(width), y2 = randomBelow(height);
+		fillTriangle(x0, y0, x1, y1, x2, y2, nextRandom());
+
+		// about area pixels are filled
+		int area2 = (x1 - x0) * (y2 - y0) - (x2 - x0) * (y1 - y0);
+		pixels += (area2 < 0 ? -area2 : area2) >> 1;
+	}
+	addResult("fillTriangle", "pixels", pixels, start);
+}
+
+void benchFillScreen() {
+	const int frames = 50;
+	uint32_t start = timerMicros();
+	for (int i = 0; i < frames; ++i) {
+		fillScreen(i & 1 ? 0xFFFF : 0x0000);
+	}
+	addResult("fillScreen", "pixels", frames * width * height, start);
+}
+
+void benchRefresh() {
+	const int frames = 20;
+	uint32_t start = timerMicros();
+	for (int i = 0; i < frames; ++i) {
+		LCD_Refresh();
+	}
+	addResult("LCD_Refresh", "frames", frames, start);
+}
+
+void benchMemory() {
+	const int repeat = 16;
+	uint8_t *a = (uint8_t *) malloc(MEMORY_SIZE);
+	uint8_t *b = (uint8_t *) malloc(MEMORY_SIZE);
+	memset(a, 0x55, MEMORY_SIZE);
+
+	uint32_t start = timerMicros();
+	for (int i = 0; i < repeat; ++i) {
+		memcpy(b, a, MEMORY_SIZE);
+	}
+	addResult("memcpy", "bytes", repeat * MEMORY_SIZE, start);
+
+	start = timerMicros();
+	for (int i = 0; i < repeat; ++i) {
+		OS_memcpy(b, a, MEMORY_SIZE);
+	}
+	addResult("OS_memcpy", "bytes", repeat * MEMORY_SIZE, start);
+
+	start = timerMicros();
+	for (int i = 0; i < repeat; ++i) {
+		memset(b, i, MEMORY_SIZE);
+	}
+	addResult("memset", "bytes", repeat * MEMORY_SIZE, start);
+
+	start = timerMicros();
+	for (int i = 0; i < repeat; ++i) {
+		OS_memset(b, i, MEMORY_SIZE);
+	}
+	addResult("OS_memset", "bytes", repeat * MEMORY_SIZE, start);
+
+	free(b);
+	free(a);
+}
+
+void benchFile() {
+	uint8_t *buffer = (uint8_t *) malloc(FILE_BLOCK);
+	memset(buffer, 0xA5, FILE_BLOCK);
+
+	int fd = open(TEMP_PATH, OPEN_WRITE | OPEN_CREATE);
+	if (fd < 0) {
+		free(buffer);
+		return;
+	}
+	for (int i = 0; i < FILE_SIZE; i += FILE_BLOCK) {
+		write(fd, buffer, FILE_BLOCK);
+	}
+	close(fd);
+
+	// read() copies the data into our buffer
+	uint32_t sum = 0;
+	uint32_t start = timerMicros();
+	fd = open(TEMP_PATH, OPEN_READ);
+	if (fd >= 0) {
+		int length;
+		while ((length = read(fd, buffer, FILE_BLOCK)) > 0) {
+			sum += buffer[length - 1];
+		}
+		close(fd);
+		addResult("read", "bytes", FILE_SIZE, start);
+	}
+
+	// getAddr() points into the flash, the data is read where it is
+	start = timerMicros();
+	fd = open(TEMP_PATH, OPEN_READ);
+	if (fd >= 0) {
+		for (int offset = 0; offset < FILE_SIZE; offset += FILE_BLOCK) {
+			const void *addr;
+			if (getAddr(fd, offset, &addr) < 0) {
+				break;
+			}
+			const uint32_t *words = (const uint32_t *) addr;
+			for (int i = 0; i < FILE_BLOCK / 4; ++i) {
+				sum += words[i];
+			}
+		}
+		close(fd);
+		addResult("getAddr", "bytes", FILE_SIZE, start);
+	}
+
+	// keep the compiler from removing the loops
+	buffer[0] = sum;
+	free(buffer);
+	remove(TEMP_PATH);
+}
+
+void benchInput() {
+	const int count = 1000;
+	struct InputEvent event;
+	uint32_t start = timerMicros();
+	for (int i = 0; i < count; ++i) {
+		memset(&event, 0, sizeof(event));
+		GetInput(&event, 0, 0x12);
+	}
+	addResult("GetInput", "calls", count, start);
+}
+
+// The results as CSV, in text (which has to be long enough)
+int formatCSV(char *text) {
+	char *p = text;
+	const char *header = "name,count,unit,micros,per_second\n";
+	while (*header) {
+		*p++ = *header++;
+	}
+
+	for (int i = 0; i < numResults; ++i) {
+		const Result &result = results[i];
+		uint32_t numbers[] = { result.count, 0, result.micros, perSecond(result) };
+		const char *strings[] = { result.name, 0, result.unit, 0, 0 };
+
+		for (int column = 0; column < 5; ++column) {
+			if (column > 0) {
+				*p++ = ',';
+			}
+
+			if (column == 0 || column == 2) {
+				for (const char *s = strings[column]; *s; ++s) {
+					*p++ = *s;
+				}
+				continue;
+			}
+
+			uint32_t n = numbers[column - 1];
+			char digits[10];
+			int numDigits = 0;
+			do {
+				digits[numDigits++] = '0' + umod32(n, 10);
+				n = udiv32(n, 10);
+			} while (n);
+			while (numDigits) {
+				*p++ = digits[--numDigits];
+			}
+		}
+		*p++ = '\n';
+	}
+
+	*p = '\0';
+	return p - text;
+}
+
+void showResults(const char *csv) {
+	fillScreen(COLOR_BACKGROUND);
+	drawText("Benchmark results (per second)", 4, 4, COLOR_TEXT);
+
+	// One line per result, the columns separated by commas like in the file
+	int y = 24;
+	const char *line = csv;
+	while (*line) {
+		char text[80];
+		int length = 0;
+		while (line[length] && line[length] != '\n' && length < (int) sizeof(text) - 1) {
+			text[length] = line[length];
+			++length;
+		}
+		text[length] = '\0';
+		drawText(text, 4, y, COLOR_TEXT);
+		y += textHeight(text) + 4;
+
+		line += length;
+		while (*line && *line != '\n') {
+			++line;
+		}
+		if (*line == '\n') {
+			++line;
+		}
+	}
+
+	drawText("Press any key to exit.", 4, height - 16, COLOR_TEXT);
+	LCD_Refresh();
+}
+
+void main() {
+	calcInit();
+	fillScreen(COLOR_BACKGROUND);
+	drawText("Running the benchmarks...", 4, 4, COLOR_TEXT);
+	LCD_Refresh();
+
+	if (!timerInit()) {
+		drawText("The timer isn't working.", 4, 24, COLOR_TEXT);
+		LCD_Refresh();
+		timerEnd();
+		calcEnd();
+		return;
+	}
+
+	numResults = 0;
+	benchSetPixel();
+	benchOSSetPixel();
+	benchLine();
+	benchTriangle();
+	benchFillScreen();
+	benchRefresh();
+	benchMemory();
+	benchFile();
+	benchInput();
+	timerEnd();
+
+	static char csv[2048];
+	int length = formatCSV(csv);
+
+	int fd = open(CSV_PATH, OPEN_WRITE | OPEN_CREATE);
+	if (fd >= 0) {
+		write(fd, csv, length);
+		close(fd);
+	}
+
+	if (!Serial_IsOpen()) {
+		unsigned char mode[6] = {0, 9, 0, 0, 0, 0}; // 115200 baud, 8N1
+		Serial_Open(mode);
+	}
+	for (int i = 0; i < length; i += 64) {
+		int chunk = length - i < 64 ? length - i : 64;
+		// 2 means the transmit buffer is full
+		while (Serial_Write((const unsigned char *) csv + i, chunk) == 2);
+	}
+
+	showResults(csv);
+
+	uint32_t key1, key2;
+	do {
+		getKey(&key1, &key2);
+	} while (key1 || key2);
+	do {
+		getKey(&key1, &key2);
+	} while (!key1 && !key2);
+
+	calcEnd();
+}
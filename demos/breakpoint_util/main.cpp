@@ -1,5 +1,8 @@
 #include <appdef.hpp>
 #include <stdint.h>
+#include <sdk/calc/div.hpp>
+#include <sdk/calc/hitCounter.hpp>
+#include <sdk/calc/timer.hpp>
 #include <sdk/cpu/ubc.hpp>
 #include <sdk/os/debug.hpp>
 #include <sdk/os/gui.hpp>
@@ -147,10 +150,46 @@ void RemoveBreakpoint() {
 	UBC_REG_CBR0 = 0 << UBC_CBR_CE;
 }
 
+/**
+ * Converts timer ticks to microseconds.
+ *
+ * @param ticks The number of ticks.
+ * @return The time in microseconds.
+ */
+uint32_t TicksToMicros(uint32_t ticks) {
+	return udiv64((uint64_t) ticks * 1000000, timerRate());
+}
+
+/**
+ * Shows the results of the hit counter, without stopping it.
+ */
+void ShowHitCounts() {
+	Debug_SetCursorPosition(0, 0);
+	Debug_PrintString("Hit counts", true);
+
+	Debug_Printf(0, 1, false, 0, "1st %08X: %d", hitCounter.address[0], hitCounter.hits[0]);
+	if (hitCounter.untilReturn) {
+		Debug_Printf(0, 2, false, 0, "returns:      %d", hitCounter.hits[1]);
+	} else {
+		Debug_Printf(0, 2, false, 0, "2nd %08X: %d", hitCounter.address[1], hitCounter.hits[1]);
+	}
+
+	if (hitCounter.latencyCount > 0) {
+		Debug_Printf(0, 4, false, 0, "1st to 2nd: %d times", hitCounter.latencyCount);
+		Debug_Printf(0, 5, false, 0, "avg %d us", TicksToMicros(
+			udiv32(hitCounter.latencyTotal, hitCounter.latencyCount)
+		));
+		Debug_Printf(0, 6, false, 0, "min %d us", TicksToMicros(hitCounter.latencyMin));
+		Debug_Printf(0, 7, false, 0, "max %d us", TicksToMicros(hitCounter.latencyMax));
+	}
+
+	LCD_Refresh();
+}
+
 class BreakpointDialog : public GUIDialog {
 public:
 	BreakpointDialog() : GUIDialog(
-		Height55, AlignCenter,
+		Height75, AlignCenter,
 		"Breakpoint Utility",
 		KeyboardStateABC
 	), m_breakpointAddressLabel(
@@ -159,33 +198,58 @@ public:
 	), m_breakpointAddress(
 		GetLeftX() + 10, GetTopY() + 30, GetRightX() - GetLeftX() - 20,
 		8, true 
+	), m_secondAddressLabel(
+		GetLeftX() + 10, GetTopY() + 60,
+		"2nd address to count (empty: return)"
+	), m_secondAddress(
+		GetLeftX() + 10, GetTopY() + 80, GetRightX() - GetLeftX() - 20,
+		8, true
 	), m_setBreakpoint(
-		GetLeftX() + 10, GetTopY() + 60, GetRightX() - 10, GetTopY() + 90,
+		GetLeftX() + 10, GetTopY() + 110, GetRightX() - 10, GetTopY() + 140,
 		"Set breakpoint", BUTTON_SET_BREAKPOINT_EVENT_ID
+	), m_countHits(
+		GetLeftX() + 10, GetTopY() + 145, GetLeftX() + 10 + 140, GetTopY() + 175,
+		"Count hits", BUTTON_COUNT_HITS_EVENT_ID
+	), m_showHits(
+		GetRightX() - 10 - 140, GetTopY() + 145, GetRightX() - 10, GetTopY() + 175,
+		"Show counts", BUTTON_SHOW_HITS_EVENT_ID
 	), m_removeBreakpoint(
-		GetLeftX() + 10, GetTopY() + 95, GetRightX() - 10, GetTopY() + 125,
+		GetLeftX() + 10, GetTopY() + 180, GetRightX() - 10, GetTopY() + 210,
 		"Remove breakpoint", BUTTON_REMOVE_BREAKPOINT_EVENT_ID
 	), m_close(
-		GetLeftX() + 10, GetTopY() + 130, GetRightX() - 10, GetTopY() + 160,
+		GetLeftX() + 10, GetTopY() + 215, GetRightX() - 10, GetTopY() + 245,
 		"Close", BUTTON_CLOSE_EVENT_ID
 	) {
+		m_counting = false;
+
 		AddElement(m_breakpointAddressLabel);
 		AddElement(m_breakpointAddress);
+		AddElement(m_secondAddressLabel);
+		AddElement(m_secondAddress);
 		AddElement(m_setBreakpoint);
+		AddElement(m_countHits);
+		AddElement(m_showHits);
 		AddElement(m_removeBreakpoint);
 		AddElement(m_close);
 	}
 
+	~BreakpointDialog() {
+		// The hit counter's handler is part of this app, so it can't stay
+		// installed after the app exits
+		StopCounting();
+	}
+
 	/**
 	 * Returns the integer representation of the address the user entered.
 	 * 
 	 * Accepts both uppercase and lowercase hexidecimal.
 	 * 
+	 * @param textBox The text box the address was entered into.
 	 * @return The integer representation of the address the user entered, or 0
 	 * if the address was invalid in some way.
 	 */
-	uint32_t GetBreakpointAddress() {
-		const char *text = m_breakpointAddress.GetText();
+	static uint32_t GetAddress(GUITextBox &textBox) {
+		const char *text = textBox.GetText();
 
 		if (text == 0) {
 			return 0;
@@ -231,7 +295,8 @@ public:
 		// TODO: Add a label to indicate the status -> requires finding a
 		// SetText function for labels.
 		if (event->GetEventID() == BUTTON_SET_BREAKPOINT_EVENT_ID) {
-			uint32_t address = GetBreakpointAddress();
+			StopCounting();
+			uint32_t address = GetAddress(m_breakpointAddress);
 
 			if (address != 0) {
 				SetBreakpoint(address);
@@ -245,8 +310,43 @@ public:
 			return 0;
 		}
 
+		if (event->GetEventID() == BUTTON_COUNT_HITS_EVENT_ID) {
+			uint32_t first = GetAddress(m_breakpointAddress);
+
+			// Without a second address, count until the first function
+			// returns
+			uint32_t second = HIT_COUNTER_RETURN;
+			const char *secondText = m_secondAddress.GetText();
+			if (secondText != 0 && secondText[0] != '\0') {
+				second = GetAddress(m_secondAddress);
+			}
+
+			if (first != 0 && second != 0) {
+				StopCounting();
+				if (timerInit()) {
+					hitCounterStart(first, second);
+					m_counting = true;
+					m_breakpointAddress.SetText("Counting!");
+				} else {
+					m_breakpointAddress.SetText("No timer.");
+					timerEnd();
+				}
+			} else {
+				m_breakpointAddress.SetText("Invalid.");
+			}
+
+			Refresh();
+			return 0;
+		}
+
+		if (event->GetEventID() == BUTTON_SHOW_HITS_EVENT_ID) {
+			ShowHitCounts();
+			return 0;
+		}
+
 		if (event->GetEventID() == BUTTON_REMOVE_BREAKPOINT_EVENT_ID) {
 			RemoveBreakpoint();
+			StopCounting();
 
 			m_breakpointAddress.SetText("Removed.");
 			Refresh();
@@ -257,12 +357,31 @@ public:
 	}
 
 private:
+	void StopCounting() {
+		if (m_counting) {
+			hitCounterStop();
+			timerEnd();
+			m_counting = false;
+		}
+	}
+
+	bool m_counting;
+
 	GUILabel m_breakpointAddressLabel;
 	GUITextBox m_breakpointAddress;
 
+	GUILabel m_secondAddressLabel;
+	GUITextBox m_secondAddress;
+
 	static const int BUTTON_SET_BREAKPOINT_EVENT_ID = 1;
 	GUIButton m_setBreakpoint;
 
+	static const int BUTTON_COUNT_HITS_EVENT_ID = 3;
+	GUIButton m_countHits;
+
+	static const int BUTTON_SHOW_HITS_EVENT_ID = 4;
+	GUIButton m_showHits;
+
 	static const int BUTTON_REMOVE_BREAKPOINT_EVENT_ID = 2;
 	GUIButton m_removeBreakpoint;
 
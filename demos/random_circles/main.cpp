@@ -1,4 +1,5 @@
 #include <appdef.hpp>
+#include <sdk/calc/calc.hpp>
 #include <sdk/os/input.hpp>
 #include <sdk/os/lcd.hpp>
 #include <sdk/os/mem.hpp>
@@ -8,29 +9,8 @@ APP_DESCRIPTION("Draw random circles at tapped locations on the display.")
 APP_AUTHOR("The6P4C")
 APP_VERSION("1.0.0")
 
-#define PIXEL(x, y) (vram[(x) + (y) * width])
-
-uint16_t *vram;
-int width, height;
 uint16_t lfsr;
 
-void drawCircle(int32_t x0, int32_t y0, int radius) {
-	for (int32_t dx = -radius; dx < radius; ++dx) {
-		for (int32_t dy = -radius; dy < radius; ++dy) {
-			if (dx * dx + dy * dy < radius * radius) {
-				int32_t x = x0 + dx;
-				int32_t y = y0 + dy;
-
-				if (x < 0 || x > width || y < 0 || y > height) {
-					continue;
-				}
-
-				PIXEL(x, y) = lfsr;
-			}
-		}
-	}
-}
-
 void main() {
 	LCD_VRAMBackup();
 
@@ -70,7 +50,7 @@ void main() {
 				}
 
 				uint16_t radius = (lfsr ^ (lfsr >> 4) ^ (lfsr >> 8) ^ (lfsr >> 12)) & 0xF;
-				drawCircle(x, y, radius + 10);
+				fillCircle(x, y, radius + 10, lfsr);
 
 				uint16_t bit = ((lfsr >> 0) ^ (lfsr >> 2) ^ (lfsr >> 3) ^ (lfsr >> 5)) & 1;
 				lfsr = (lfsr >> 1) | (bit << 15);
@@ -1,4 +1,8 @@
 #include <appdef.hpp>
+#include <sdk/calc/calc.hpp>
+#include <sdk/calc/stringBuilder.hpp>
+#include <sdk/calc/text.hpp>
+#include <sdk/calc/tilemap.hpp>
 #include <sdk/os/debug.hpp>
 #include <sdk/os/input.hpp>
 #include <sdk/os/lcd.hpp>
@@ -11,6 +15,8 @@ APP_VERSION("1.0.0")
 #define COLOR_BACKGROUND RGB_TO_RGB565(0, 0, 0)
 #define COLOR_SNAKE RGB_TO_RGB565(0x1F, 0, 0)
 #define COLOR_FRUIT RGB_TO_RGB565(0, 0x3F, 0)
+#define COLOR_SCORE RGB_TO_RGB565(0, 0, 0)
+#define COLOR_SCORE_BACKGROUND RGB_TO_RGB565(0x1F, 0x3F, 0x1F)
 
 #define BLOCK_SIZE 20
 #define MAX_SNAKE_LENGTH 50
@@ -21,10 +27,17 @@ APP_VERSION("1.0.0")
 #define DIRECTION_SOUTH 2
 #define DIRECTION_WEST 3
 
-uint16_t *vram;
-int lcdWidth, lcdHeight;
+#define TILE_BACKGROUND 0
+#define TILE_SNAKE 1
+#define TILE_FRUIT 2
+
+const uint16_t tileColors[] = {COLOR_BACKGROUND, COLOR_SNAKE, COLOR_FRUIT};
+
 int numBlocksX, numBlocksY;
 
+// the playing field, only the blocks that change are drawn
+TileMap board;
+
 // the snake's head is at position 0 in our list
 int snakeLength;
 int snakeX[MAX_SNAKE_LENGTH];
@@ -39,41 +52,42 @@ uint32_t fruitYLFSR;
 int fruitX;
 int fruitY;
 
-void drawBlock(int blockX, int blockY, uint16_t color) {
-	for (int x = blockX * BLOCK_SIZE; x < (blockX + 1) * BLOCK_SIZE; ++x) {
-		for (int y = blockY * BLOCK_SIZE; y < (blockY + 1) * BLOCK_SIZE; ++y) {
-			vram[x + (y + 24) * lcdWidth] = color;
-		}
-	}
+void drawScore() {
+	char num[20];
+	StringBuilder sb;
+	stringBuilderInit(sb, num);
+	appendString(sb, "Score: ");
+	appendInt(sb, snakeLength, 4, '0');
+	drawText(num, 4, 8, COLOR_SCORE, COLOR_SCORE_BACKGROUND);
 }
 
-void draw() {
-	Debug_SetCursorPosition(0, 0);
-	Debug_PrintString("Score: ", false);
-
-	char *num = "0000";
-	num[0] = (snakeLength / 1000) % 10 + '0';
-	num[1] = (snakeLength / 100) % 10 + '0';
-	num[2] = (snakeLength / 10) % 10 + '0';
-	num[3] = snakeLength % 10 + '0';
-	Debug_PrintString(num, false);
-
-	// Draw the background
-	for (int blockY = 0; blockY < numBlocksY; ++blockY) {
-		for (int blockX = 0; blockX < numBlocksX; ++blockX) {
-			drawBlock(blockX, blockY, COLOR_BACKGROUND);
-		}
-	}
+// Draws the whole playing field, only needed once at the start
+void drawAll() {
+	drawScore();
 
-	// Draw the snake
+	// The background, the snake and the fruit
+	tileMapFill(board, TILE_BACKGROUND);
 	for (int i = 0; i < snakeLength; ++i) {
-		drawBlock(snakeX[i], snakeY[i], COLOR_SNAKE);
+		tileMapSet(board, snakeX[i], snakeY[i], TILE_SNAKE);
 	}
-
-	// Draw the fruit
-	drawBlock(fruitX, fruitY, COLOR_FRUIT);
+	tileMapSet(board, fruitX, fruitY, TILE_FRUIT);
+	tileMapDraw(board);
 
 	LCD_Refresh();
+	clearDirty();
+}
+
+// Only draws the blocks which changed since the last call
+void draw() {
+	// The score is far from most tiles, send it on its own so the dirty rectangle stays small
+	drawScore();
+	LCD_RefreshDirty();
+
+	tileMapSet(board, snakeX[0], snakeY[0], TILE_SNAKE);
+	tileMapSet(board, fruitX, fruitY, TILE_FRUIT);
+	tileMapDraw(board);
+
+	LCD_RefreshDirty();
 }
 
 bool moveSnake() {
@@ -110,6 +124,9 @@ bool moveSnake() {
 	if (numBlocksToAdd > 0) {
 		--numBlocksToAdd;
 		++snakeLength;
+	} else {
+		// the old tail is now behind the end of the list
+		tileMapSet(board, snakeX[snakeLength], snakeY[snakeLength], TILE_BACKGROUND);
 	}
 
 	return true;
@@ -176,10 +193,17 @@ void main() {
 	LCD_ClearScreen();
 
 	vram = LCD_GetVRAMAddress();
-	LCD_GetSize(&lcdWidth, &lcdHeight);
+	LCD_GetSize(&width, &height);
+
+	numBlocksX = width / BLOCK_SIZE;
+	numBlocksY = (height - 24) / BLOCK_SIZE;
 
-	numBlocksX = lcdWidth / BLOCK_SIZE;
-	numBlocksY = (lcdHeight - 24) / BLOCK_SIZE;
+	if (!tileMapInit(board, numBlocksX, numBlocksY, BLOCK_SIZE, BLOCK_SIZE)) {
+		LCD_VRAMRestore();
+		return;
+	}
+	board.y = 24;
+	board.colors = tileColors;
 
 	snakeLength = 3;
 	for (int i = 0; i < snakeLength; ++i) {
@@ -192,6 +216,8 @@ void main() {
 	fruitYLFSR = 0xAF05432A;
 	moveFruit();
 
+	drawAll();
+
 	struct InputEvent event;
 
 	bool lost = false;
@@ -246,6 +272,7 @@ void main() {
 	}
 
 	Debug_WaitKey();
+	tileMapFree(board);
 
 	LCD_VRAMRestore();
 	LCD_Refresh();
@@ -1,4 +1,6 @@
 #include <appdef.hpp>
+#include <sdk/calc/stringBuilder.hpp>
+#include <sdk/calc/tilemap.hpp>
 #include <sdk/os/debug.hpp>
 #include <sdk/os/input.hpp>
 #include <sdk/os/lcd.hpp>
@@ -10,19 +12,31 @@ APP_DESCRIPTION("A simple implementation of the game Tetris.")
 APP_AUTHOR("De_Coder")
 APP_VERSION("1.0.0")
 
+//generous upper bound of the size of a debug text cell, the score ("Score: 0000" from column 7) is marked with it
+const int DEBUG_CELL_WIDTH = 12;
+const int DEBUG_CELL_HEIGHT = 24;
+
 void print_score(uint32_t score){	//prints to score to the top of the screen
 	Debug_SetCursorPosition(7, 0);
 	Debug_PrintString("Score: ", false);
 
-	char *num = "0000";
-	num[0] = (score / 1000) % 10 + '0';
-	num[1] = (score / 100) % 10 + '0';
-	num[2] = (score / 10) % 10 + '0';
-	num[3] = score % 10 + '0';
+	char num[11];
+	StringBuilder sb;
+	stringBuilderInit(sb, num);
+	appendUInt(sb, score, 4, '0');
 	Debug_SetCursorPosition(14, 0);
 	Debug_PrintString(num, false);
+	markDirty(7*DEBUG_CELL_WIDTH, 0, 18*DEBUG_CELL_WIDTH-1, DEBUG_CELL_HEIGHT-1);	//Debug_PrintString doesn't mark what it draws
 }
 
+//the colors of the palette (see sdk/os/lcd.hpp), tile i is drawn like LCD_SetPixelFromPalette(..., i)
+const uint16_t palette[8] = {
+	RGB_TO_RGB565(0, 0, 0), RGB_TO_RGB565(0, 0, 0x1F), RGB_TO_RGB565(0, 0x3F, 0), RGB_TO_RGB565(0, 0x3F, 0x1F),
+	RGB_TO_RGB565(0x1F, 0, 0), RGB_TO_RGB565(0x1F, 0, 0x1F), RGB_TO_RGB565(0x1F, 0x3F, 0), RGB_TO_RGB565(0x1F, 0x3F, 0x1F)
+};
+
+TileMap board;	//the squares of the field, only the ones that change are drawn
+
 uint32_t random(uint32_t rand){ //generates a pseudo random number
   rand ^= (rand << 13);
   rand ^= (rand >> 17);
@@ -30,16 +44,8 @@ uint32_t random(uint32_t rand){ //generates a pseudo random number
   return rand;
 }
 
-void draw_square(unsigned int x, unsigned int y, uint8_t color_index){	//draws one square at x,y in the color given by color_index
-	if(x <= 12 && y <= 22){
-		x = x * 20 + 41;
-		y = y * 20 + 41;
-		for(int i = 0; i < 18; i++){
-			for(int j = 0; j < 18; j++){
-				LCD_SetPixelFromPalette(x + i, y + j, color_index);
-			}
-		}
-	}
+void draw_square(unsigned int x, unsigned int y, uint8_t color_index){	//sets one square at x,y to the color given by color_index, drawn by tileMapDraw()
+	tileMapSet(board, x, y, color_index);
 }
 
 void main() {
@@ -113,6 +119,18 @@ void main() {
 	
 	LCD_VRAMBackup();
 
+	vram = LCD_GetVRAMAddress();
+	LCD_GetSize(&width, &height);
+	if(!tileMapInit(board, 12, 22, 18, 18)){
+		LCD_VRAMRestore();
+		return;
+	}
+	board.x = 41;	//18x18 squares every 20 pixels, the lines are between them
+	board.y = 41;
+	board.spacing = 2;
+	board.colors = palette;
+	tileMapFill(board, 7);
+
 	LCD_ClearScreen();
 	LCD_Refresh();
 	
@@ -154,6 +172,8 @@ void main() {
 	}
 	
 	LCD_Refresh();
+	tileMapDraw(board);
+	clearDirty();
 	
 	rot = 0;	//get first block
 	pos_x = 6;
@@ -313,7 +333,8 @@ void main() {
 		for(int i = 0; i < 4; i++){	//draw fields of the active block
 			draw_square(active_block[i][0], active_block[i][1], block_type);
 		}
-		LCD_Refresh();	//update screen
+		tileMapDraw(board);	//update screen, only the squares that changed
+		LCD_RefreshDirty();
 		for(int i = 0; i < 4; i++){		//draw fields of the active block in white so the block dosnt leave a colored trail
 			draw_square(active_block[i][0], active_block[i][1], 7);
 		}
@@ -391,6 +412,7 @@ void main() {
 		}
 	}
 	
+	tileMapFree(board);
 	LCD_ClearScreen();// print score and wait
 	print_score(score);
 	LCD_Refresh();
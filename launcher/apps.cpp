@@ -1,82 +1,32 @@
+#include <sdk/calc/xip.hpp>
+#include <sdk/cpu/cache.hpp>
+#include <sdk/os/dirWalker.hpp>
 #include <sdk/os/file.hpp>
+#include <sdk/os/fileStream.hpp>
+#include <sdk/os/mappedFile.hpp>
 #include <sdk/os/mem.hpp>
 #include <sdk/os/string.hpp>
 #include "apps.hpp"
+#include "array.hpp"
+#include "index.hpp"
+#include "reloc.hpp"
 #include "elf.h"
 #include <sdk/os/serial.hpp>
 
 #define hex2asc(x) ((x)>9?((x)+'A'-10):((x)+'0'))
 
-class File {
-public:
-	File() : m_opened(false), m_fd(-1) {
-
-	}
-
-	~File() {
-		if (m_opened) {
-			close(m_fd);
-		}
-	}
-
-	int open(const char *path, int flags) {
-		m_fd = ::open(path, flags);
-		m_opened = true;
-		return m_fd;
-	}
-
-	int getAddr(int offset, const void **addr) {
-		return ::getAddr(m_fd, offset, addr);
-	}
-
-private:
-	bool m_opened;
-	int m_fd;
-};
-
-class Find {
-public:
-	Find() : m_opened(false), m_findHandle(-1) {
-
-	}
-
-	~Find() {
-		if (m_opened) {
-			findClose(m_findHandle);
-		}
-	}
-
-	int findFirst(const wchar_t *path, wchar_t *name, struct findInfo *findInfoBuf) {
-		int ret = ::findFirst(path, &m_findHandle, name, findInfoBuf);
-		m_opened = true;
-		return ret;
-	}
-
-	int findNext(wchar_t *name, struct findInfo *findInfoBuf) {
-		return ::findNext(m_findHandle, name, findInfoBuf);
-	}
-
-private:
-	bool m_opened;
-	int m_findHandle;
-};
-
 namespace Apps {
-	const char *HHK_FOLDER[] = {
-		"\\fls0\\",
-		"\\fls0\\bin"
-	};
-	const char FILE_MASK[] = "*.hhk";
-
-    struct AppInfo g_apps[MAX_APPS];
+    struct AppInfo *g_apps;
     int g_numApps;
+    int g_capacity;
 
-    const Elf32_Ehdr *LoadELF(File f, const Elf32_Shdr **sectionHeaders) {
-        const Elf32_Ehdr *elf;
-        int ret = f.getAddr(0, (const void **) &elf);
-        if (ret < 0) {
-            return nullptr;
-        }
+    // The file descriptor of the app that was started last, if it needs its
+    // file for the overlays. Closed by CloseFile.
+    int g_appFile = -1;
+
+    // Checks the ELF header of a file at file (in the memory) and returns it
+    const Elf32_Ehdr *CheckELF(const void *file, const Elf32_Shdr **sectionHeaders) {
+        const Elf32_Ehdr *elf = reinterpret_cast<const Elf32_Ehdr *>(file);
 
         // Check magic number
         if (!(
@@ -130,27 +80,84 @@ namespace Apps {
         return elf;
     }
 
-	void LoadApp(const char *folder, wchar_t *fileName) {
-		struct AppInfo app;
-		memset(&app, 0, sizeof(app));
-
-		// copy the file name (converting to a non-wide string in the
-		// process)
-		for (int i = 0; i < 100; ++i) {
-			wchar_t c = fileName[i];
-			app.fileName[i] = c;
-			if (c == 0x0000) {
-				break;
+    const Elf32_Ehdr *LoadELF(FileStream &f, const Elf32_Shdr **sectionHeaders) {
+        const void *file;
+        int ret = f.GetAddr(0, &file);
+        if (ret < 0) {
+            return nullptr;
+        }
+        return CheckELF(file, sectionHeaders);
+    }
+
+	// Returns the header of the section called name, or nullptr
+	const Elf32_Shdr *FindSectionHeader(const Elf32_Ehdr *elf, const Elf32_Shdr *sectionHeaders, const char *name) {
+		const Elf32_Shdr *sectionHeaderStringTable = &sectionHeaders[elf->e_shstrndx];
+		for (int i = 0; i < elf->e_shnum; ++i) {
+			const Elf32_Shdr *sectionHeader = &sectionHeaders[i];
+
+			// skip the first empty section header
+			if (sectionHeader->sh_type == SHT_NULL) {
+				continue;
 			}
+
+			const char *sectionName = reinterpret_cast<const char *>(
+				reinterpret_cast<const uint8_t *>(elf) +
+				sectionHeaderStringTable->sh_offset +
+				sectionHeader->sh_name
+			);
+
+			if (strcmp(sectionName, name) == 0) {
+				return sectionHeader;
+			}
+		}
+
+		return nullptr;
+	}
+
+	// Returns the contents of the section called name, or nullptr
+	const char *FindSection(const Elf32_Ehdr *elf, const Elf32_Shdr *sectionHeaders, const char *name) {
+		const Elf32_Shdr *sectionHeader = FindSectionHeader(elf, sectionHeaders, name);
+		if (sectionHeader == nullptr) {
+			return nullptr;
+		}
+		return reinterpret_cast<const char *>(
+			reinterpret_cast<const uint8_t *>(elf) +
+			sectionHeader->sh_offset
+		);
+	}
+
+	Strings::Offset AddSection(const Elf32_Ehdr *elf, const Elf32_Shdr *sectionHeaders, const char *name) {
+		const char *sectionData = FindSection(elf, sectionHeaders, name);
+		if (sectionData == nullptr) {
+			return 0;
+		}
+		return Strings::Add(sectionData);
+	}
+
+	void LoadApp(const char *path, const struct findInfo &info, void *context) {
+		(void) info;
+		(void) context;
+
+		struct AppInfo *app = Array::Reserve(g_apps, g_numApps, g_capacity);
+		if (app == nullptr) {
+			return;
 		}
 
-		// build the path
-		//strcat(app.path, "\\fls0\\");
-		strcat(app.path, folder);
-		strcat(app.path, app.fileName);
+		// take the info from the index if the file hasn't changed
+		struct stat st;
+		if (stat(path, &st) == 0) {
+			app->fileSize = st.fileSize;
+			app->lastModifiedDate = st.lastModifiedDate;
+			app->lastModifiedTime = st.lastModifiedTime;
+
+			if (Index::Lookup(*app, path)) {
+				g_numApps++;
+				return;
+			}
+		}
 
-		File f;
-		int ret = f.open(app.path, OPEN_READ);
+		FileStream f;
+		int ret = f.Open(path, OPEN_READ);
 		if (ret < 0) {
 			return;
 		}
@@ -162,7 +169,47 @@ namespace Apps {
 			return;
 		}
 
-		const Elf32_Shdr *sectionHeaderStringTable = &sectionHeaders[elf->e_shstrndx];
+		app->path = Strings::Add(path);
+		app->name = AddSection(elf, sectionHeaders, ".hollyhock_name");
+		app->author = AddSection(elf, sectionHeaders, ".hollyhock_author");
+		app->version = AddSection(elf, sectionHeaders, ".hollyhock_version");
+		g_numApps++;
+	}
+
+	void LoadDescription(int i, char *buf, int size) {
+		Strings::Copy(buf, size, "");
+
+		FileStream f;
+		int ret = f.Open(Strings::Get(g_apps[i].path), OPEN_READ);
+		if (ret < 0) {
+			return;
+		}
+
+		const Elf32_Shdr *sectionHeaders;
+		const Elf32_Ehdr *elf = LoadELF(f, &sectionHeaders);
+
+		if (elf == nullptr) {
+			return;
+		}
+
+		const char *description = FindSection(elf, sectionHeaders, ".hollyhock_description");
+		if (description != nullptr) {
+			Strings::Copy(buf, size, description);
+		}
+	}
+
+	void AddPatterns(DirWalker &walker) {
+		g_numApps = 0;
+		walker.AddPattern(".hhk", LoadApp);
+	}
+
+	void Free() {
+		Array::Free(g_apps, g_numApps, g_capacity);
+	}
+
+	// Copies every SHF_ALLOC section to its address, for ELFs without
+	// program headers
+	void LoadSections(const Elf32_Ehdr *elf, const Elf32_Shdr *sectionHeaders) {
 		for (int i = 0; i < elf->e_shnum; ++i) {
 			const Elf32_Shdr *sectionHeader = &sectionHeaders[i];
 
@@ -171,102 +218,199 @@ namespace Apps {
 				continue;
 			}
 
-			const char *sectionName = reinterpret_cast<const char *>(
-				reinterpret_cast<const uint8_t *>(elf) +
-				sectionHeaderStringTable->sh_offset +
-				sectionHeader->sh_name
-			);
-
-			const char *sectionData = reinterpret_cast<const char *>(
+			const void *sectionData = reinterpret_cast<const void *>(
 				reinterpret_cast<const uint8_t *>(elf) +
 				sectionHeader->sh_offset
 			);
 
-			if (strcmp(sectionName, ".hollyhock_name") == 0) {
-				strcat(app.name, sectionData);
-			} else if (strcmp(sectionName, ".hollyhock_description") == 0) {
-				strcat(app.description, sectionData);
-			} else if (strcmp(sectionName, ".hollyhock_author") == 0) {
-				strcat(app.author, sectionData);
-			} else if (strcmp(sectionName, ".hollyhock_version") == 0) {
-				strcat(app.version, sectionData);
+			if ((sectionHeader->sh_flags & SHF_ALLOC) == SHF_ALLOC) {
+				void *dest = reinterpret_cast<void *>(sectionHeader->sh_addr);
+
+				if (sectionHeader->sh_type == SHT_PROGBITS) {
+					memcpy(dest, sectionData, sectionHeader->sh_size);
+				} else if (sectionHeader->sh_type == SHT_NOBITS) {
+					memset(dest, 0, sectionHeader->sh_size);
+				}
 			}
 		}
-
-		g_apps[g_numApps++] = app;
 	}
 
-	void LoadAppInfo() {
-		g_numApps = 0;
+	// Copies every PT_LOAD segment to its address and clears the rest of it
+	// (the .bss). Segments which continue each other both in the file and in
+	// memory are done in one copy.
+	// This includes the on-chip RAM sections (.ilram, .xram, .yram, see
+	// sdk/calc/onchip.hpp), which are linked to their final addresses just
+	// like everything else.
+	// The segments in the normal RAM are moved by delta (see reloc.hpp).
+	void LoadSegments(const Elf32_Ehdr *elf, int32_t delta) {
+		const uint8_t *file = reinterpret_cast<const uint8_t *>(elf);
+		const Elf32_Phdr *programHeaders = reinterpret_cast<const Elf32_Phdr *>(
+			file + elf->e_phoff
+		);
+
+		int i = 0;
+		while (i < elf->e_phnum) {
+			const Elf32_Phdr *segment = &programHeaders[i++];
+			if (segment->p_type != PT_LOAD) {
+				continue;
+			}
 
-		for (unsigned int dirNr=0; dirNr<sizeof(HHK_FOLDER)/sizeof(HHK_FOLDER[0]);dirNr++){
-			Find find;
+			// Stored somewhere else than where it runs: an overlay, which
+			// the app loads itself (see sdk/calc/overlay.hpp)
+			if (segment->p_vaddr != segment->p_paddr) {
+				continue;
+			}
 
-			wchar_t fileName[100];
-			struct findInfo findInfoBuf;
+			uint32_t address = segment->p_vaddr;
+			uint32_t offset = segment->p_offset;
+			uint32_t fileSize = segment->p_filesz;
+			uint32_t memorySize = segment->p_memsz;
+
+			while (i < elf->e_phnum && memorySize == fileSize) {
+				const Elf32_Phdr *next = &programHeaders[i];
+				if (
+					next->p_type != PT_LOAD ||
+					next->p_vaddr != address + fileSize ||
+					next->p_offset != offset + fileSize
+				) {
+					break;
+				}
 
-			wchar_t findDir[100];
-			int i=0;
-			while (HHK_FOLDER[dirNr][i]!=0){
-				findDir[i] = (wchar_t)HHK_FOLDER[dirNr][i]; 
+				memorySize = fileSize + next->p_memsz;
+				fileSize += next->p_filesz;
 				i++;
 			}
-			int j=0;
-			while (FILE_MASK[j]!=0){
-				findDir[i] = (wchar_t)FILE_MASK[j];
-				i++; j++;
+
+			if (Reloc::Moves(address)) {
+				address += delta;
+			}
+
+			uint8_t *dest = reinterpret_cast<uint8_t *>(address);
+			memcpy(dest, file + offset, fileSize);
+			if (memorySize > fileSize) {
+				memset(dest + fileSize, 0, memorySize - fileSize);
 			}
-			findDir[i] = 0;
-			int ret = find.findFirst(findDir, fileName, &findInfoBuf);
-			while (ret >= 0) {
-				if (findInfoBuf.type == findInfoBuf.EntryTypeFile) {
-					LoadApp(HHK_FOLDER[dirNr],fileName);
+		}
+	}
+
+	// The loaded code (with the relocations applied) is still in the
+	// operand cache, and the instruction cache may hold the app that ran
+	// there before: write back what was copied from the file and drop
+	// those lines, so the CPU fetches the new code (the .bss is only data).
+	// The on-chip RAM isn't cached, CACHE_SyncCode() skips it.
+	void SyncCode(const Elf32_Ehdr *elf, const Elf32_Shdr *sectionHeaders, bool hasSegments, int32_t delta) {
+		const uint8_t *file = reinterpret_cast<const uint8_t *>(elf);
+		if (hasSegments) {
+			const Elf32_Phdr *programHeaders = reinterpret_cast<const Elf32_Phdr *>(
+				file + elf->e_phoff
+			);
+			for (int i = 0; i < elf->e_phnum; ++i) {
+				const Elf32_Phdr *segment = &programHeaders[i];
+				if (segment->p_type != PT_LOAD || segment->p_vaddr != segment->p_paddr) {
+					continue;
 				}
-				ret = find.findNext(fileName, &findInfoBuf);
+				uint32_t address = segment->p_vaddr;
+				if (Reloc::Moves(address)) {
+					address += delta;
+				}
+				CACHE_SyncCode(reinterpret_cast<const void *>(address), segment->p_filesz);
+			}
+			return;
+		}
+
+		for (int i = 0; i < elf->e_shnum; ++i) {
+			const Elf32_Shdr *sectionHeader = &sectionHeaders[i];
+			if (sectionHeader->sh_type == SHT_PROGBITS && (sectionHeader->sh_flags & SHF_ALLOC) == SHF_ALLOC) {
+				CACHE_SyncCode(reinterpret_cast<const void *>(sectionHeader->sh_addr), sectionHeader->sh_size);
 			}
 		}
 	}
 
-    EntryPoint RunApp(int i) {
-        struct AppInfo *app = &g_apps[i];
+	// Whether the app has overlays that it reads from its file (all but
+	// .overlay0, which is stored where it runs, see sdk/calc/overlay.hpp)
+	bool HasOverlays(const Elf32_Ehdr *elf, const Elf32_Shdr *sectionHeaders) {
+		char name[] = ".overlay1";
+		for (char id = '1'; id <= '7'; ++id) {
+			name[sizeof(name) - 2] = id;
+			if (FindSectionHeader(elf, sectionHeaders, name) != nullptr) {
+				return true;
+			}
+		}
+		return false;
+	}
 
-        File f;
-        int ret = f.open(app->path, OPEN_READ);
+    EntryPoint RunApp(int i, uint32_t base) {
+        const char *path = Strings::Get(g_apps[i].path);
+        MappedFile f;
+        int ret = f.Open(path);
         if (ret < 0) {
             return nullptr;
         }
 
+        // Everything below copies straight out of the mapping, which only
+        // works if the file is in one piece in the flash
+        if (f.GetNumFragments() != 1) {
+            return nullptr;
+        }
+
         const Elf32_Shdr *sectionHeaders;
-        const Elf32_Ehdr *elf = LoadELF(f, &sectionHeaders);
+        const Elf32_Ehdr *elf = CheckELF(f.begin()->data, &sectionHeaders);
 
 		if (elf == nullptr) {
 			return nullptr;
 		}
 
-		for (int i = 0; i < elf->e_shnum; ++i) {
-			const Elf32_Shdr *sectionHeader = &sectionHeaders[i];
+		bool hasSegments = elf->e_phnum > 0 && elf->e_phentsize == sizeof(Elf32_Phdr);
 
-			// skip the first empty section header
-			if (sectionHeader->sh_type == SHT_NULL) {
-				continue;
+		int32_t delta = 0;
+		if (base != 0) {
+			if (!hasSegments || !Reloc::IsRelocatable(elf, sectionHeaders)) {
+				return nullptr;
 			}
+			delta = base - Reloc::LinkBase(elf, sectionHeaders);
+		}
 
-			const void *sectionData = reinterpret_cast<const void *>(
-				reinterpret_cast<const uint8_t *>(elf) +
-				sectionHeader->sh_offset
-			);
+		if (hasSegments) {
+			LoadSegments(elf, delta);
+		} else {
+			LoadSections(elf, sectionHeaders);
+		}
 
-			if ((sectionHeader->sh_flags & SHF_ALLOC) == SHF_ALLOC) {
-				void *dest = reinterpret_cast<void *>(sectionHeader->sh_addr);
+		if (delta != 0 && !Reloc::Apply(elf, sectionHeaders, delta)) {
+			return nullptr;
+		}
 
-				if (sectionHeader->sh_type == SHT_PROGBITS) {
-					memcpy(dest, sectionData, sectionHeader->sh_size);
-				} else if (sectionHeader->sh_type == SHT_NOBITS) {
-					memset(dest, 0, sectionHeader->sh_size);
-				}
+		// Keep the file open for the overlays and tell the app about it. The
+		// overlays read it through the file functions, the mapping above is
+		// only valid until f is closed. Overlays only work at the link
+		// address.
+		const Elf32_Shdr *headerSection = FindSectionHeader(elf, sectionHeaders, ".hollyhock_header");
+		if (
+			delta == 0 && headerSection != nullptr &&
+			headerSection->sh_size >= sizeof(struct BinHeader) &&
+			HasOverlays(elf, sectionHeaders)
+		) {
+			struct BinHeader *header = reinterpret_cast<struct BinHeader *>(headerSection->sh_addr);
+			if (header->magic == BIN_HEADER_MAGIC) {
+				CloseFile();
+				g_appFile = open(path, OPEN_READ);
+				header->appFile = g_appFile;
 			}
 		}
 
-		return reinterpret_cast<EntryPoint>(elf->e_entry);
+		SyncCode(elf, sectionHeaders, hasSegments, delta);
+
+		uint32_t entry = elf->e_entry;
+		if (Reloc::Moves(entry)) {
+			entry += delta;
+		}
+		return reinterpret_cast<EntryPoint>(entry);
     }
+
+	void CloseFile() {
+		if (g_appFile >= 0) {
+			close(g_appFile);
+			g_appFile = -1;
+		}
+	}
 }
@@ -0,0 +1,40 @@
+#include <sdk/os/mem.hpp>
+#include "array.hpp"
+
+namespace Array {
+    const int INITIAL_CAPACITY = 16;
+
+    void *Reserve(void **items, int count, int *capacity, int itemSize) {
+        uint8_t *array = static_cast<uint8_t *>(*items);
+
+        if (count >= *capacity) {
+            int newCapacity = *capacity == 0 ? INITIAL_CAPACITY : *capacity * 2;
+            uint8_t *newArray = static_cast<uint8_t *>(malloc(newCapacity * itemSize));
+            if (newArray == nullptr) {
+                return nullptr;
+            }
+
+            if (array != nullptr) {
+                memcpy(newArray, array, count * itemSize);
+                free(array);
+            }
+
+            array = newArray;
+            *items = array;
+            *capacity = newCapacity;
+        }
+
+        uint8_t *item = array + count * itemSize;
+        memset(item, 0, itemSize);
+        return item;
+    }
+
+    void Free(void **items, int *count, int *capacity) {
+        if (*items != nullptr) {
+            free(*items);
+        }
+        *items = nullptr;
+        *count = 0;
+        *capacity = 0;
+    }
+}
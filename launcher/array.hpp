@@ -0,0 +1,24 @@
+#pragma once
+
+// Growable malloc'd arrays, for the app, bin and exec tables
+namespace Array {
+    // Makes sure there's room for item number count in items (an array of
+    // capacity items, or nullptr before the first one), doubling it when it
+    // is full. Returns the item, cleared to zero, or nullptr if there's not
+    // enough memory.
+    void *Reserve(void **items, int count, int *capacity, int itemSize);
+
+    template<typename T>
+    T *Reserve(T *&items, int count, int &capacity) {
+        return static_cast<T *>(
+            Reserve(reinterpret_cast<void **>(&items), count, &capacity, sizeof(T))
+        );
+    }
+
+    void Free(void **items, int *count, int *capacity);
+
+    template<typename T>
+    void Free(T *&items, int &count, int &capacity) {
+        Free(reinterpret_cast<void **>(&items), &count, &capacity);
+    }
+};
@@ -1,198 +1,362 @@
+#include <sdk/os/dirWalker.hpp>
 #include <sdk/os/file.hpp>
+#include <sdk/os/fileStream.hpp>
+#include <sdk/os/mappedFile.hpp>
 #include <sdk/os/mem.hpp>
 #include <sdk/os/string.hpp>
+#include <sdk/calc/lz4.hpp>
+#include <sdk/calc/xip.hpp>
+#include <sdk/cpu/cache.hpp>
 #include "bins.hpp"
+#include "array.hpp"
+#include "index.hpp"
 #include <sdk/os/serial.hpp>
 
 #define hex2asc(x) ((x)>9?((x)+'A'-10):((x)+'0'))
 
 #define Serial_print(s) Serial_Write((const unsigned char*)s,sizeof(s)-1)
 
-#define Serial_printhex(x)	Serial_WriteSingle( hex2asc( ((x)>>28)&0xf ) );\
-							Serial_WriteSingle( hex2asc( ((x)>>24)&0xf ) );\
-							Serial_WriteSingle( hex2asc( ((x)>>20)&0xf ) );\
-							Serial_WriteSingle( hex2asc( ((x)>>16)&0xf ) );\
-							Serial_WriteSingle( hex2asc( ((x)>>12)&0xf ) );\
-							Serial_WriteSingle( hex2asc( ((x)>> 8)&0xf ) );\
-							Serial_WriteSingle( hex2asc( ((x)>> 4)&0xf ) );\
-							Serial_WriteSingle( hex2asc( ((x)>> 0)&0xf ) );
+#define Serial_printhex(x)	{ \
+							unsigned char hex[8]; \
+							for (int digit = 0; digit < 8; digit++) \
+								hex[digit] = hex2asc( ((x) >> (28 - digit * 4)) & 0xf ); \
+							Serial_Write(hex, sizeof(hex)); \
+						}
 
-class File {
-public:
-	File() : m_opened(false), m_fd(-1) {
-
-	}
-
-	~File() {
-		if (m_opened) {
-			close(m_fd);
-		}
-	}
-
-	int open(const char *path, int flags) {
-		m_fd = ::open(path, flags);
-		m_opened = true;
-		return m_fd;
-	}
+namespace Bins {
+	// .hhz are compressed bins, see tools/hhz.py
+	const char *FILE_EXTENSION[] = {
+		".bin",
+		".hhz"
+	};
+	// not an app, it's the launcher itself
+	const char EXCLUDE[] = "run.bin";
 
-	int getAddr(int offset, const void **addr) {
-		return ::getAddr(m_fd, offset, addr);
-	}
+	// A bin can be loaded anywhere up to RAM_END, which leaves 128 KiB from
+	// the default load address 0x8CFF0000 (see doc/user/developing.md)
+	const uint32_t RAM_START = 0x8C000000;
+	const uint32_t RAM_END = 0x8D010000;
+	const uint32_t LOAD_CHUNK = 0x8000;
 
-	int read(void *buf, int count) {
-		return ::read(m_fd, buf, count);
-	}
+    struct AppInfo *g_apps;
+    int g_numApps;
+    int g_capacity;
 
-private:
-	bool m_opened;
-	int m_fd;
-};
+	// The header of a .hhz, followed by the name, description, author and
+	// version. See tools/hhz.py.
+	const uint32_t HHZ_MAGIC = 0x48485A31; // "HHZ1"
+	const uint32_t HHZ_FLAG_BIN_HEADER = 1;
 
-class Find {
-public:
-	Find() : m_opened(false), m_findHandle(-1) {
+	struct HhzHeader {
+		uint32_t magic;
+		uint32_t loadAddress;
+		uint32_t loadSize;
+		uint32_t blockOffset;
+		uint32_t blockSize;
+		uint32_t bssSize;
+		uint32_t xipOffset;
+		uint32_t xipSize;
+		uint32_t flags;
+	};
 
+	// Returns the header of a .hhz, or nullptr if it's a plain bin
+	const struct HhzHeader *FindHhzHeader(FileStream &f) {
+		const struct HhzHeader *header;
+		if (f.GetAddr(0, (const void**)&header) < 0) {
+			return nullptr;
+		}
+		if (header->magic != HHZ_MAGIC) {
+			return nullptr;
+		}
+		return header;
 	}
 
-	~Find() {
-		if (m_opened) {
-			findClose(m_findHandle);
+	// Returns the header at 0x10 (see sdk/calc/xip.hpp), or nullptr if the
+	// bin is older than it.
+	const struct BinHeader *FindHeader(FileStream &f) {
+		const struct BinHeader *header;
+		if (f.GetAddr(0x10, (const void**)&header) < 0) {
+			return nullptr;
+		}
+		if (header->magic != BIN_HEADER_MAGIC) {
+			return nullptr;
 		}
+		return header;
 	}
 
-	int findFirst(const wchar_t *path, wchar_t *name, struct findInfo *findInfoBuf) {
-		int ret = ::findFirst(path, &m_findHandle, name, findInfoBuf);
-		m_opened = true;
-		return ret;
+	// The name, description, author and version follow each other from 0x10
+	// (or after the header) in the file, with zeros in between. Returns
+	// nullptr if there are none.
+	const char *FindBinInfo(FileStream &f) {
+		const char *binInfo;
+		int offset = 0x10;
+		if (FindHhzHeader(f) != nullptr) {
+			offset = sizeof(struct HhzHeader);
+		} else if (FindHeader(f) != nullptr) {
+			offset = 0x10 + sizeof(struct BinHeader);
+		}
+		if (f.GetAddr(offset, (const void**)&binInfo) < 0) {
+			return nullptr;
+		}
+		if (!(*binInfo>=32&&*binInfo<127)) {
+			return nullptr;
+		}
+		return binInfo;
 	}
 
-	int findNext(wchar_t *name, struct findInfo *findInfoBuf) {
-		return ::findNext(m_findHandle, name, findInfoBuf);
+	const char *NextBinInfo(const char *binInfo) {
+		while(*binInfo!=0)binInfo++;
+		while(*binInfo==0)binInfo++;
+		return binInfo;
 	}
 
-private:
-	bool m_opened;
-	int m_findHandle;
-};
+	void LoadApp(const char *path, const struct findInfo &info, void *context) {
+		(void) info;
+		(void) context;
 
-namespace Bins {
-	const char *BIN_FOLDER[] = {
-		"\\fls0\\",
-		"\\fls0\\bin\\"
-	};
-	const char FILE_MASK[] = "*.bin";
+		const char *fileName = path;
+		for (const char *c = path; *c != '\0'; ++c) {
+			if (*c == '\\') {
+				fileName = c + 1;
+			}
+		}
+		if (strcmp(fileName, EXCLUDE) == 0) {
+			return;
+		}
 
-    struct AppInfo g_apps[MAX_APPS];
-    int g_numApps;
+		struct AppInfo *app = Array::Reserve(g_apps, g_numApps, g_capacity);
+		if (app == nullptr) {
+			return;
+		}
 
-	void LoadApp(const char *folder, wchar_t *fileName) {
-		struct AppInfo app;
-		memset(&app, 0, sizeof(app));
+		// take the info from the index if the file hasn't changed
+		struct stat st;
+		if (stat(path, &st) == 0) {
+			app->fileSize = st.fileSize;
+			app->lastModifiedDate = st.lastModifiedDate;
+			app->lastModifiedTime = st.lastModifiedTime;
 
-		// copy the file name (converting to a non-wide string in the
-		// process)
-		for (int i = 0; i < 100; ++i) {
-			wchar_t c = fileName[i];
-			app.fileName[i] = c;
-			if (c == 0x0000) {
-				break;
+			if (Index::Lookup(*app, path)) {
+				g_numApps++;
+				return;
 			}
 		}
 
-		// build the path
-		//strcat(app.path, "\\fls0\\");
-		strcat(app.path, folder);
-		strcat(app.path, app.fileName);
+		FileStream f;
+		int ret = f.Open(path, OPEN_READ);
+		if (ret < 0) {
+			return;
+		}
+
+		app->path = Strings::Add(path);
+
+		const char *binInfo = FindBinInfo(f);
+		if (binInfo != nullptr) {
+			app->name = Strings::Add(binInfo);
+			binInfo = NextBinInfo(binInfo); // the description is loaded when it's shown
+			binInfo = NextBinInfo(binInfo);
+			app->author = Strings::Add(binInfo);
+			binInfo = NextBinInfo(binInfo);
+			app->version = Strings::Add(binInfo);
+		}
+		g_numApps++;
+	}
+
+	void LoadDescription(int i, char *buf, int size) {
+		Strings::Copy(buf, size, "");
 
-		File f;
-		int ret = f.open(app.path, OPEN_READ);
+		FileStream f;
+		int ret = f.Open(Strings::Get(g_apps[i].path), OPEN_READ);
 		if (ret < 0) {
 			return;
 		}
-		char *binInfo;
-		f.getAddr(0x10, (const void**)&binInfo);
-
-		if(*binInfo>=32&&*binInfo<127){
-			for(int i=0;*binInfo!=0;i++)
-				app.name[i] = *(binInfo++);
-			while(*binInfo==0)binInfo++;
-			for(int i=0;*binInfo!=0;i++)
-				app.description[i] = *(binInfo++);
-			while(*binInfo==0)binInfo++;
-			for(int i=0;*binInfo!=0;i++)
-				app.author[i] = *(binInfo++);
-			while(*binInfo==0)binInfo++;
-			for(int i=0;*binInfo!=0;i++)
-				app.version[i] = *(binInfo++);
-		}
-		g_apps[g_numApps++] = app;
+
+		const char *binInfo = FindBinInfo(f);
+		if (binInfo != nullptr) {
+			Strings::Copy(buf, size, NextBinInfo(binInfo));
+		}
 	}
 
-	void LoadAppInfo() {
+	void AddPatterns(DirWalker &walker) {
 		g_numApps = 0;
+		for (unsigned int i = 0; i < sizeof(FILE_EXTENSION) / sizeof(FILE_EXTENSION[0]); ++i) {
+			walker.AddPattern(FILE_EXTENSION[i], LoadApp);
+		}
+	}
 
-		for (unsigned int dirNr=0; dirNr<sizeof(BIN_FOLDER)/sizeof(BIN_FOLDER[0]);dirNr++){
-			Find find;
+	void Free() {
+		Array::Free(g_apps, g_numApps, g_capacity);
+	}
+
+	// Reads count bytes to dest in chunks, so any size works. Returns the
+	// number of bytes read, less at the end of the file.
+	uint32_t Stream(FileStream &f, uint8_t *dest, uint32_t count) {
+		uint32_t done = 0;
+		while (done < count) {
+			uint32_t chunk = count - done;
+			if (chunk > LOAD_CHUNK) {
+				chunk = LOAD_CHUNK;
+			}
 
-			wchar_t fileName[100];
-			struct findInfo findInfoBuf;
+			int ret = f.Read(dest + done, chunk);
+			if (ret <= 0) {
+				break;
+			}
+			done += ret;
+			if (static_cast<uint32_t>(ret) < chunk) {
+				break;
+			}
+		}
+		return done;
+	}
 
-			wchar_t findDir[100];
-			int i=0;
-			while (BIN_FOLDER[dirNr][i]!=0){
-				findDir[i] = (wchar_t)BIN_FOLDER[dirNr][i]; 
-				i++;
+	// Tells the app loaded at dest where its .xip section is. That's the
+	// flash if the section is in one fragment of the file there (see
+	// mappedFile.hpp). Otherwise the app would read whatever follows the
+	// first fragment, so the section is copied into the RAM after the loaded
+	// bytes and the .bss (loadedSize), if it fits.
+	bool SetXipBase(const char *path, uint8_t *dest, uint32_t loadedSize, uint32_t xipOffset, uint32_t xipSize) {
+		const uint8_t *xip = nullptr;
+		if (xipSize > 0) {
+			MappedFile file;
+			if (file.Open(path) < 0) {
+				return false;
 			}
-			int j=0;
-			while (FILE_MASK[j]!=0){
-				findDir[i] = (wchar_t)FILE_MASK[j];
-				i++; j++;
+			if (xipOffset > file.GetSize() || xipSize > file.GetSize() - xipOffset) {
+				return false;
 			}
-			findDir[i] = 0;
-			int ret = find.findFirst(findDir, fileName, &findInfoBuf);
-			while (ret >= 0) {
-				if (findInfoBuf.type == findInfoBuf.EntryTypeFile) {
-					const char* exclude = "run.bin";
-					char different = 0;
-					for(unsigned int i=0;i<sizeof(exclude);i++) different|=(exclude[i]^fileName[i]);
-					if(different){
-						LoadApp(BIN_FOLDER[dirNr],fileName);
-					}
+
+			const MappedFragment *fragment = file.FindFragment(xipOffset);
+			if (xipOffset + xipSize <= fragment->offset + fragment->size) {
+				xip = fragment->data + (xipOffset - fragment->offset);
+			} else {
+				uint8_t *copy = dest + ((loadedSize + 15) & ~15);
+				if (reinterpret_cast<uint32_t>(copy) > RAM_END || xipSize > RAM_END - reinterpret_cast<uint32_t>(copy)) {
+					return false;
 				}
-				ret = find.findNext(fileName, &findInfoBuf);
+				if (static_cast<uint32_t>(file.Read(xipOffset, copy, xipSize)) != xipSize) {
+					return false;
+				}
+				xip = copy;
 			}
 		}
+		struct BinHeader *loadedHeader = reinterpret_cast<struct BinHeader *>(dest + 0x10);
+		loadedHeader->xipBase = reinterpret_cast<uint32_t>(xip);
+		return true;
 	}
 
-	EntryPoint RunApp(int i) {
-		struct AppInfo *app = &g_apps[i];
+	// Decompresses the .hhz straight from the flash to its load address. If
+	// the flash stores the block in pieces, it's read to the end of the RAM
+	// first, above what it's decompressed to.
+	EntryPoint RunHhz(const char *path, const struct HhzHeader *header) {
+		uint8_t *dest = reinterpret_cast<uint8_t *>(header->loadAddress);
+		if (
+			header->loadAddress < RAM_START ||
+			header->loadAddress >= RAM_END ||
+			header->loadSize + header->bssSize > RAM_END - header->loadAddress
+		) {
+			return nullptr;
+		}
+
+		MappedFile file;
+		if (file.Open(path) < 0) {
+			return nullptr;
+		}
+		if (header->blockOffset >= file.GetSize() || header->blockSize > file.GetSize() - header->blockOffset) {
+			return nullptr;
+		}
+
+		const uint8_t *block;
+		const MappedFragment *fragment = file.FindFragment(header->blockOffset);
+		if (header->blockOffset + header->blockSize <= fragment->offset + fragment->size) {
+			block = fragment->data + (header->blockOffset - fragment->offset);
+		} else {
+			uint32_t copy = (RAM_END - header->blockSize) & ~3;
+			if (header->blockSize > RAM_END - header->loadAddress || copy < header->loadAddress + header->loadSize) {
+				return nullptr;
+			}
+			if (static_cast<uint32_t>(file.Read(header->blockOffset, reinterpret_cast<uint8_t *>(copy), header->blockSize)) != header->blockSize) {
+				return nullptr;
+			}
+			block = reinterpret_cast<const uint8_t *>(copy);
+		}
+		int size = lz4Decompress(dest, header->loadSize, block, header->blockSize);
+		if (size < 0 || static_cast<uint32_t>(size) != header->loadSize) {
+			return nullptr;
+		}
+		memset(dest + header->loadSize, 0, header->bssSize);
+
+		if (
+			(header->flags & HHZ_FLAG_BIN_HEADER) &&
+			!SetXipBase(path, dest, header->loadSize + header->bssSize, header->xipOffset, header->xipSize)
+		) {
+			return nullptr;
+		}
+
+		CACHE_SyncCode(dest, header->loadSize);
+		return reinterpret_cast<EntryPoint>(dest);
+	}
 
-		File f;
-		int ret = f.open(app->path, OPEN_READ);
+	EntryPoint RunApp(int i) {
+		const char *path = Strings::Get(g_apps[i].path);
+		FileStream f;
+		int ret = f.Open(path, OPEN_READ);
 		if (ret < 0) {
 		    return nullptr;
 		}
+		const struct HhzHeader *hhz = FindHhzHeader(f);
+		if (hhz != nullptr) {
+			return RunHhz(path, hhz);
+		}
+
 		//get address where the program should be loaded
 		unsigned char* address;
-		f.getAddr(0x0c, (const void**)&address);
+		if (f.GetAddr(0x0c, (const void**)&address) < 0) {
+			return nullptr;
+		}
 		EntryPoint entrypoint = (EntryPoint)0x8cff0000;
 		if (address[0]==0x8c)
 				entrypoint = (EntryPoint)((address[0]<<24) + (address[1]<<16) + (address[2]<<8) + (address[3]));
 
-		int length = f.read((void*)entrypoint,0x20000);
-		//unsigned char mode[] = {0,5,0,0,0,0};
-		//Serial_Open(mode);
-		//Serial_print("The length is: 0x");
-		//Serial_printhex(length);
-		//unsigned char c;
-		//while(c!='\n') {
-		//		Serial_ReadSingle(&c);
-		//		if(c=='.'){
-		//				Serial_Close(0);
-		//				return nullptr;
-		//		}
-		//}
-		//Serial_Close(0);
+		uint8_t *dest = reinterpret_cast<uint8_t *>(entrypoint);
+		if (reinterpret_cast<uint32_t>(dest) >= RAM_END) {
+			return nullptr;
+		}
+		uint32_t room = RAM_END - reinterpret_cast<uint32_t>(dest);
+
+		const struct BinHeader *header = FindHeader(f);
+		if (header == nullptr) {
+			// an older bin: all of it goes into the RAM, a part of it would
+			// crash
+			struct stat st;
+			if (fstat(f.GetFD(), &st) < 0 || st.fileSize > room) {
+				return nullptr;
+			}
+			uint32_t size = Stream(f, dest, st.fileSize);
+			if (size != st.fileSize) {
+				return nullptr;
+			}
+			CACHE_SyncCode(dest, size);
+			return entrypoint;
+		}
+
+		// copy everything but the .xip section, clear the .bss, and tell
+		// the app where the .xip section is
+		if (header->loadSize + header->bssSize > room) {
+			return nullptr;
+		}
+		if (Stream(f, dest, header->loadSize) != header->loadSize) {
+			return nullptr;
+		}
+		memset(dest + header->loadSize, 0, header->bssSize);
+
+		if (!SetXipBase(path, dest, header->loadSize + header->bssSize, header->xipOffset, header->xipSize)) {
+			return nullptr;
+		}
+
+		// the code is still in the operand cache, and the instruction cache
+		// may hold the bin that ran there before
+		CACHE_SyncCode(dest, header->loadSize);
 		return entrypoint;
     }
 }
@@ -1,22 +1,35 @@
 #pragma once
+#include <stdint.h>
+#include <sdk/os/dirWalker.hpp>
+#include "strings.hpp"
 
 namespace Bins {
+    // The strings are in the string pool, see strings.hpp. The description
+    // isn't kept, LoadDescription reads it from the file when it's needed.
     struct AppInfo {
-        char fileName[100];
-        char path[200];
-        char name[100];
-        char description[100];
-        char author[100];
-        char version[100];
+        Strings::Offset path;
+        Strings::Offset name;
+        Strings::Offset author;
+        Strings::Offset version;
+
+        // from stat, to tell if the index (see index.hpp) is still valid
+        uint32_t fileSize;
+        uint16_t lastModifiedDate;
+        uint16_t lastModifiedTime;
     };
 
     typedef void (*EntryPoint)();
 
-    const int MAX_APPS = 64;
-
-    extern struct AppInfo g_apps[MAX_APPS];
+    // a malloc'd array, see array.hpp
+    extern struct AppInfo *g_apps;
     extern int g_numApps;
 
-    void LoadAppInfo();
+    // Clears the list and adds the extensions of the apps to walker. The apps
+    // are loaded while it walks (see Registry::Load).
+    void AddPatterns(DirWalker &walker);
+    void Free();
+    // Copies the description of app i into buf (at most size - 1 characters
+    // and the terminator), or an empty string if it has none.
+    void LoadDescription(int i, char *buf, int size);
     EntryPoint RunApp(int i);
 };
@@ -1,13 +1,16 @@
 #include <sdk/os/mem.hpp>
 #include <sdk/os/string.hpp>
+#include <sdk/calc/mcsDirectory.hpp>
 #include "execs.hpp"
+#include "array.hpp"
 
 #include <sdk/os/debug.hpp>
 #include <sdk/os/lcd.hpp>
 
 namespace Execs {
-    struct ExecInfo g_execs[MAX_EXECS];
+    struct ExecInfo *g_execs;
     int g_numExecs;
+    int g_capacity;
 /*
 	void LoadExec(wchar_t *fileName) {
 		struct ExecInfo exec;
@@ -28,284 +31,266 @@ namespace Execs {
 	}
 */
 
+	//Reads a line starting with ' at offset j of the var (up to 100 characters), and moves j to the next line
+	bool ReadField(const char *file, int &j, const char **text, int *length) {
+		if (*(file+j) != '\'') return false;
+		j++;
+		*text = file+j;
+		int i = 0;
+		for (; i<100; i++){
+			char ch = *(file+j);
+			j++;
+			if( ch==0 || ch=='\n' || ch=='\r') break; //End of the text
+		}
+		*length = i;
+		if (*(file+j) == '\n' || *(file+j) == '\r' ) j++;
+		return true;
+	}
+
+	const char *GetVar(struct ExecInfo *exec) {
+		return (const char*)((exec->fp[0]<<24)+(exec->fp[1]<<16)+(exec->fp[2]<<8)+(exec->fp[3]));
+	}
+
+	void LoadDescription(int i, char *buf, int size) {
+		Strings::Copy(buf, size, "");
+
+		const char *file = GetVar(&g_execs[i]);
+		int j = 0;
+		const char *text;
+		int length;
+		if (ReadField(file, j, &text, &length) && ReadField(file, j, &text, &length)){
+			Strings::Copy(buf, size, text, length);
+		}
+	}
+
     void LoadExecInfo() {
 		g_numExecs = 0;
 
-		//Check if the folder hhk exists
-		char *hhk = 0; //the address of the hhk folder
-		char *ram = (char*) 0x8cf80100; //The first folder name is at 8cf80100
-		while( *(ram+8) != 0 ) { //The first byte of the folder address can't be 0, if it is we've searched all folders
-			if(*ram=='h'){
-				if(*(ram+1)=='h'){
-					if(*(ram+2)=='k'){
-						if(*(ram+3)==0){
-							//we've found the folder
-							hhk = ram; //hhk points now to the foldername of hhk
-							break;
-						}
-					}
-				}
-			}
-			ram += 0x10;
-		}
-		
 		//Return if folder hhk is not present
-		if ( hhk == 0 ) return;
-		
-		int hhk_entries = *((uint16_t*)(hhk+12)) ; //0-7 is the folder name, 8-11 is the position of the first directory table entry, 12-13 is the amount of entries in that direcory
-		hhk = *((char**)(hhk+8)); //hhk points now to the first diretory table entry in the folder hhk
-		char *directoryEntry = hhk; //points to the directory table entry of the file we are currently checking
-		char *file = 0; //The actual address of the file
-
-		int current = 0;
-		while (current < hhk_entries ) {
-		
-		//the file starts at the location:  first directory table entry location + the offset stored in the file's directory table entry + 0x0d
-			file = hhk + 0x0d + *((uint32_t*)(directoryEntry+8)); 
-			//The name is stored from 0-7, the offset from 8-11, the size from 12-15 and the type at 16 
-
-			//Check if the type is 'program' (aka 0x47)
-			if ( *(directoryEntry+16) == 0x47 ) {
-
-				struct ExecInfo exec;
-				memset(&exec, 0, sizeof(exec));
-				
-				for(int i = 0; i<8 ; i++){
-					exec.fileName[i]=*(directoryEntry+i);
-				}
-		
-				exec.fp[0] = ((uint32_t)file & 0xff000000) >> 24;
-				exec.fp[1] = ((uint32_t)file & 0x00ff0000) >> 16;
-				exec.fp[2] = ((uint32_t)file & 0x0000ff00) >> 8;
-				exec.fp[3] = ((uint32_t)file & 0x000000ff);
-/*
-        Debug_Printf(0,0,false,0,"Address %02x %02x %02x %02x",exec.fp[0],exec.fp[1],exec.fp[2],exec.fp[3]);
-        Debug_Printf(0,1,false,0,"%x",((exec.fp[0]<<24)+(exec.fp[1]<<16)+(exec.fp[2]<<8)+(exec.fp[3])));
-        LCD_Refresh();
-        Debug_WaitKey();
-*/
-				int j = 0; //offset in file
-				//Extract Name from the var
-				if (*(file+j) == '\''){ //If it contains a name, add it to hollyhock
-					j++;
-					for (int i = 0; i<100; i++){
-						char ch = *(file+j);
-						j++;
-						if( ch==0 || ch=='\n' || ch=='\r') break; //End of the text
-						exec.name[i] = ch;
-					}
-					if (*(file+j) == '\n' || *(file+j) == '\r' ) j++;
-					if (*(file+j) == '\''){ //If it contains a description, add it to hollyhock
-						j++;
-						for (int i = 0; i<100; i++){
-							char ch = *(file+j);
-							j++;
-							if( ch==0 || ch=='\n' || ch=='\r') break; //End of the text
-							exec.description[i] = ch;
-						}
-						if (*(file+j) == '\n' || *(file+j) == '\r' ) j++;
-						if (*(file+j) == '\''){ //If it contains an author, add it to hollyhock
-							j++;
-							for (int i = 0; i<100; i++){
-								char ch = *(file+j);
-								j++;
-								if( ch==0 || ch=='\n' || ch=='\r') break; //End of the text
-								exec.author[i] = ch;
-							}
-							if (*(file+j) == '\n' || *(file+j) == '\r' ) j++;
-							if (*(file+j) == '\''){ //If it contains a version, add it to hollyhock
-								j++;
-								for (int i = 0; i<100; i++){
-									char ch = *(file+j);
-									j++;
-									if( ch==0 || ch=='\n' || ch=='\r') break; //End of the text
-									exec.version[i] = ch;
-								}
-							}
+		const McsFolder *hhk = mcsFindFolder("hhk");
+		if (hhk == nullptr) return;
+
+		int position = 0;
+		const McsVariable *variable;
+		while (mcsNextVariable(*hhk, VARTYPE_PRGM, position, variable)) {
+			const char *file = (const char*)mcsVariableData(*hhk, *variable);
+
+			struct ExecInfo exec;
+			memset(&exec, 0, sizeof(exec));
+			memcpy(exec.fileName, variable->name, MCS_NAME_LENGTH);
+
+			exec.fp[0] = ((uint32_t)file & 0xff000000) >> 24;
+			exec.fp[1] = ((uint32_t)file & 0x00ff0000) >> 16;
+			exec.fp[2] = ((uint32_t)file & 0x0000ff00) >> 8;
+			exec.fp[3] = ((uint32_t)file & 0x000000ff);
+			exec.size = variable->size;
+
+			int j = 0; //offset in file
+			const char *text;
+			int length;
+			//Extract Name from the var
+			if (ReadField(file, j, &text, &length)){ //If it contains a name, add it to hollyhock
+				exec.name = Strings::Add(text, length);
+				if (ReadField(file, j, &text, &length)){ //If it contains a description, it's loaded when it's shown
+					if (ReadField(file, j, &text, &length)){ //If it contains an author, add it to hollyhock
+						exec.author = Strings::Add(text, length);
+						if (ReadField(file, j, &text, &length)){ //If it contains a version, add it to hollyhock
+							exec.version = Strings::Add(text, length);
 						}
 					}
 				}
-			
-				g_execs[g_numExecs++] = exec;
 			}
-			//go to the next entry
-			current++;
-			directoryEntry = directoryEntry + 20 ; //Yes, 16+4 = 20
-        }
+
+			struct ExecInfo *slot = Array::Reserve(g_execs, g_numExecs, g_capacity);
+			if (slot != nullptr) {
+				memcpy(slot, &exec, sizeof(exec));
+				g_numExecs++;
+			}
+		}
     }
     
 	void test(){
     }
+
+	void Free() {
+		Array::Free(g_execs, g_numExecs, g_capacity);
+	}
     
+    // The character classes of the decoder: 0 to 15 is the value of a hex
+    // digit, everything else is one of these.
+    enum CharClass {
+        CLASS_SKIP = 16,  // spaces, new lines, anything else
+        CLASS_COMMENT,    // ' to the end of the line
+        CLASS_STRING,     // "...", copied as it is
+        CLASS_SYMBOL,     // #, an address, see g_symbols
+        CLASS_END         // the terminator or *
+    };
+
+    uint8_t g_classes[256];
+
+    void InitClasses() {
+        if (g_classes[0] == CLASS_END) return;
+        memset(g_classes, CLASS_SKIP, sizeof(g_classes));
+        for (int c = 0; c < 10; c++) g_classes['0' + c] = c;
+        for (int c = 0; c < 6; c++) {
+            g_classes['a' + c] = 10 + c;
+            g_classes['A' + c] = 10 + c;
+        }
+        g_classes['\''] = CLASS_COMMENT;
+        g_classes['"'] = CLASS_STRING;
+        g_classes['#'] = CLASS_SYMBOL;
+        g_classes['*'] = CLASS_END;
+        g_classes[0] = CLASS_END;
+    }
+
+    uint32_t VramAddress() {
+        return (uint32_t)LCD_GetVRAMAddress();
+    }
+
+    uint32_t VramWidth() {
+        int width, height;
+        LCD_GetSize(&width, &height);
+        return width;
+    }
+
+    uint32_t VramHeight() {
+        int width, height;
+        LCD_GetSize(&width, &height);
+        return height;
+    }
+
+    // #<name> in a var is replaced by size bytes of the address (or of what
+    // value returns, if it's set), big endian
+    struct Symbol {
+        const char *name;
+        int size;
+        uintptr_t address;
+        uint32_t (*value)();
+    };
+
+    const struct Symbol g_symbols[] = {
+        {"C", 4, (uintptr_t)&LCD_ClearScreen, nullptr},
+        {"R", 4, (uintptr_t)&LCD_Refresh, nullptr},
+        {"V", 4, 0, VramAddress},
+        {"X", 2, 0, VramWidth},
+        {"Y", 2, 0, VramHeight},
+        {"S", 4, (uintptr_t)&Debug_SetCursorPosition, nullptr},
+        {"G", 4, (uintptr_t)&Debug_GetCursorPosition, nullptr},
+        {"W", 4, (uintptr_t)&Debug_WaitKey, nullptr},
+        {"PS", 4, (uintptr_t)&Debug_PrintString, nullptr},
+        {"PF", 4, (uintptr_t)&Debug_Printf, nullptr},
+        {"PN", 4, (uintptr_t)&Debug_PrintNumberHex_Nibble, nullptr},
+        {"PB", 4, (uintptr_t)&Debug_PrintNumberHex_Byte, nullptr},
+        {"PW", 4, (uintptr_t)&Debug_PrintNumberHex_Word, nullptr},
+        {"PL", 4, (uintptr_t)&Debug_PrintNumberHex_Dword, nullptr},
+        {"PD", 4, (uintptr_t)&Debug_PrintNumberHex_Dword, nullptr},
+    };
+
+    // Writes the symbol at var (after the #) to buf. Moves var to its last
+    // character, or leaves it if there's no such symbol.
+    char *WriteSymbol(const char *&var, char *buf) {
+        for (const struct Symbol &symbol : g_symbols) {
+            int length = 0;
+            while (symbol.name[length] != 0 && symbol.name[length] == var[length]) length++;
+            if (symbol.name[length] != 0) continue;
+
+            uint32_t value = symbol.value != nullptr ? symbol.value() : symbol.address;
+            for (int shift = (symbol.size - 1) * 8; shift >= 0; shift -= 8) {
+                *buf = value >> shift; buf++;
+            }
+            var += length - 1;
+            break;
+        }
+        return buf;
+    }
+
+    // Converts the text of a var to the binary at buf, returns the end of it
+    char *Decode(const char *var, char *buf) {
+        InitClasses();
+        //0 searching first nibble; 1 searching 2nd nibble
+        int currentNibble = 0;
+        uint8_t currentByte = 0;
+        while (true) {
+            uint8_t charClass = g_classes[(uint8_t)*var];
+            if (charClass < 16) {
+                currentByte = (currentByte << 4) | charClass;
+                if (++currentNibble == 2) { //read whole byte
+                    *buf = currentByte; buf++;
+                    currentNibble = 0;
+                }
+            } else if (charClass == CLASS_COMMENT) {
+                while (*var != '\r' && *var != '\n' && *var != 0) var++;
+                continue;
+            } else if (charClass == CLASS_STRING) {
+                var++;
+                while (*var != '"' && *var != 0) {
+                    *buf = *var; buf++;
+                    var++;
+                }
+                if (*var == 0) break;
+            } else if (charClass == CLASS_SYMBOL) {
+                var++;
+                if (*var == 0) break;
+                buf = WriteSymbol(var, buf);
+            } else if (charClass == CLASS_END) {
+                break;
+            }
+            var++;
+        }
+        return buf;
+    }
+
+    // The last few execs that were decoded, so starting one again is just
+    // a copy. An entry is only used if the var is still at the same place,
+    // has the same size and its bytes add up to the same sum (it might have
+    // been edited in place).
+    const int CACHE_SIZE = 4;
+
+    struct CacheEntry {
+        const char *var;
+        uint32_t size;
+        uint32_t sum;
+        char *data;
+        int length;
+    };
+
+    struct CacheEntry g_cache[CACHE_SIZE];
+    int g_nextCache;
+
+    uint32_t Sum(const char *var, uint32_t size) {
+        uint32_t sum = 0;
+        for (uint32_t i = 0; i < size; i++) sum = (sum << 1 | sum >> 31) + (uint8_t)var[i];
+        return sum;
+    }
+
     EntryPoint RunExec(int i) {
         struct ExecInfo *exec = &g_execs[i];
         //Execute the exec. First load it from the var into the ram at 8CFF0000
         char *buf = (char*) 0x8CFF0000;
-        /*
-        Debug_Printf(0,0,false,0,"Address %02x %02x %02x %02x",exec->fp[0],exec->fp[1],exec->fp[2],exec->fp[3]);
-        Debug_Printf(0,1,false,0,"%x",((exec->fp[0]<<24)+(exec->fp[1]<<16)+(exec->fp[2]<<8)+(exec->fp[3])));
-        LCD_Refresh();
-        Debug_WaitKey();
-        */
-        char *var = (char*)((exec->fp[0]<<24)+(exec->fp[1]<<16)+(exec->fp[2]<<8)+(exec->fp[3]));
-        //Debug_Printf(0,0,false,0,var);
-        //Convert from hex to bin
-        char currentNibble = 0; //0 searching first nibble; 1 searching 2nd nibble; 2 read whole byte
-        char currentByte = 0;
-        while(1==1){
-        	//char ch = *var;
-            if (*var=='\''){ //Comment
-                while(*var!='\r' && *var!='\n' && *var!=0) var++;
-                continue;
-            }
-            if (*var=='"'){ //String
-                var++;
-                while(*var!='"' && *var!=0 ){
-                    *buf = *var; buf++;
-        	        var++;
-        	    }
-        	}
-        	if (*var>='0' && *var<='9'){
-        		currentByte = (currentByte << 4) + (*var - '0');
-        		currentNibble++;
-        	}
-        	if (*var>='a' && *var<='f'){
-        		currentByte = (currentByte << 4) + (*var +(10 - 'a'));
-        		currentNibble++;
-        	}
-        	if (*var>='A' && *var<='F'){
-        		currentByte = (currentByte << 4) + (*var +(10 - 'A'));
-        		currentNibble++;
-        	}
-        	if (*var=='#'){ //An address value. 
-        	    var++;
-            	if (*var=='C'){ //LCD_ClearScreen();
-            	    uint32_t addr = (uint32_t)LCD_ClearScreen;
-            	    *buf = (addr & 0xff000000) >> 24; buf++;
-            	    *buf = (addr & 0x00ff0000) >> 16; buf++;
-            	    *buf = (addr & 0x0000ff00) >>  8; buf++;
-            	    *buf = (addr & 0x000000ff)      ; buf++;
-            	}
-            	if (*var=='R'){ //LCD_Refresh();
-            	    uint32_t addr = (uint32_t)LCD_Refresh;
-            	    *buf = (addr & 0xff000000) >> 24; buf++;
-            	    *buf = (addr & 0x00ff0000) >> 16; buf++;
-            	    *buf = (addr & 0x0000ff00) >>  8; buf++;
-            	    *buf = (addr & 0x000000ff)      ; buf++;
-            	}
-            	if (*var=='V'){ //The actual address of the VRAM;
-            	    uint32_t addr = (uint32_t)LCD_GetVRAMAddress();
-            	    *buf = (addr & 0xff000000) >> 24; buf++;
-            	    *buf = (addr & 0x00ff0000) >> 16; buf++;
-            	    *buf = (addr & 0x0000ff00) >>  8; buf++;
-            	    *buf = (addr & 0x000000ff)      ; buf++;
-            	}
-            	if (*var=='X'){ //The actual width of the VRAM
-            	    int width, height;
-            	    LCD_GetSize(&width, &height);
-            	    *buf = (((uint16_t)width) & 0xff00) >>  8; buf++;
-            	    *buf = (((uint16_t)width) & 0x00ff)      ; buf++;
-            	}
-            	if (*var=='Y'){ //The actual height of the VRAM
-            	    int width, height;
-            	    LCD_GetSize(&width, &height);
-            	    *buf = (((uint16_t)height) & 0xff00) >>  8; buf++;
-            	    *buf = (((uint16_t)height) & 0x00ff)      ; buf++;
-            	}
-            	if (*var=='S'){ //Debug_SetCursorPosition(int x, int y);*
-            	    uint32_t addr = (uint32_t)Debug_SetCursorPosition;
-            	    *buf = (addr & 0xff000000) >> 24; buf++;
-            	    *buf = (addr & 0x00ff0000) >> 16; buf++;
-            	    *buf = (addr & 0x0000ff00) >>  8; buf++;
-            	    *buf = (addr & 0x000000ff)      ; buf++;
-            	}
-            	if (*var=='G'){ //Debug_GetCursorPosition(int *x, int *y);
-            	    uint32_t addr = (uint32_t)Debug_GetCursorPosition;
-            	    *buf = (addr & 0xff000000) >> 24; buf++;
-            	    *buf = (addr & 0x00ff0000) >> 16; buf++;
-            	    *buf = (addr & 0x0000ff00) >>  8; buf++;
-            	    *buf = (addr & 0x000000ff)      ; buf++;
-            	}
-            	if (*var=='W'){ //Debug_WaitKey();
-            	    uint32_t addr = (uint32_t)Debug_WaitKey;
-            	    *buf = (addr & 0xff000000) >> 24; buf++;
-            	    *buf = (addr & 0x00ff0000) >> 16; buf++;
-            	    *buf = (addr & 0x0000ff00) >>  8; buf++;
-            	    *buf = (addr & 0x000000ff)      ; buf++;
-            	}
-            	if (*var=='P'){ //Debug_Print...
-            	    var++;
-                	if (*var=='S'){ //Debug_PrintString(const char *string, bool invert);
-            	    uint32_t addr = (uint32_t)Debug_PrintString;
-            	    *buf = (addr & 0xff000000) >> 24; buf++;
-            	    *buf = (addr & 0x00ff0000) >> 16; buf++;
-            	    *buf = (addr & 0x0000ff00) >>  8; buf++;
-            	    *buf = (addr & 0x000000ff)      ; buf++;
-                	}
-                	if (*var=='F'){ //Debug_Printf(int x, int y, bool invert, int zero, const char *format, ...);
-            	    uint32_t addr = (uint32_t)Debug_Printf;
-            	    *buf = (addr & 0xff000000) >> 24; buf++;
-            	    *buf = (addr & 0x00ff0000) >> 16; buf++;
-            	    *buf = (addr & 0x0000ff00) >>  8; buf++;
-            	    *buf = (addr & 0x000000ff)      ; buf++;
-                	}
-                	if (*var=='N'){ //Debug_PrintNumberHex_Nibble(uint8_t value, int x, int y);
-            	    uint32_t addr = (uint32_t)Debug_PrintNumberHex_Nibble;
-            	    *buf = (addr & 0xff000000) >> 24; buf++;
-            	    *buf = (addr & 0x00ff0000) >> 16; buf++;
-            	    *buf = (addr & 0x0000ff00) >>  8; buf++;
-            	    *buf = (addr & 0x000000ff)      ; buf++;
-                	}
-                	if (*var=='B'){ //Debug_PrintNumberHex_Byte(uint8_t value, int x, int y);
-            	    uint32_t addr = (uint32_t)Debug_PrintNumberHex_Byte;
-            	    *buf = (addr & 0xff000000) >> 24; buf++;
-            	    *buf = (addr & 0x00ff0000) >> 16; buf++;
-            	    *buf = (addr & 0x0000ff00) >>  8; buf++;
-            	    *buf = (addr & 0x000000ff)      ; buf++;
-                	}
-                	if (*var=='W'){ //Debug_PrintNumberHex_Word(uint16_t value, int x, int y);
-            	    uint32_t addr = (uint32_t)Debug_PrintNumberHex_Word;
-            	    *buf = (addr & 0xff000000) >> 24; buf++;
-            	    *buf = (addr & 0x00ff0000) >> 16; buf++;
-            	    *buf = (addr & 0x0000ff00) >>  8; buf++;
-            	    *buf = (addr & 0x000000ff)      ; buf++;
-                	}
-                	if (*var=='L' || *var=='D'){ //Debug_PrintNumberHex_Dword(uint32_t value, int x, int y);
-            	    uint32_t addr = (uint32_t)Debug_PrintNumberHex_Dword;
-            	    *buf = (addr & 0xff000000) >> 24; buf++;
-            	    *buf = (addr & 0x00ff0000) >> 16; buf++;
-            	    *buf = (addr & 0x0000ff00) >>  8; buf++;
-            	    *buf = (addr & 0x000000ff)      ; buf++;
-                	}
-            	}
+        const char *var = GetVar(exec);
+        uint32_t sum = Sum(var, exec->size);
+
+        for (struct CacheEntry &entry : g_cache) {
+            if (entry.data != nullptr && entry.var == var && entry.size == exec->size && entry.sum == sum) {
+                memcpy(buf, entry.data, entry.length);
+                return (EntryPoint) 0x8CFF0000;
             }
-           	if(currentNibble==2){ //read whole byte
-        		*buf = currentByte; buf++;
-        		currentByte = 0;
-        		currentNibble = 0;
-        	}
-        	if(*var==0 || *var=='*'){
-        	break;
-        	}
-        	var++;
         }
-		//return reinterpret_cast<EntryPoint> .....
-		//return (EntryPoint) ((exec->fp[0]<<24)+(exec->fp[1]<<16)+(exec->fp[2]<<8)+(exec->fp[3]));        
-		//return (EntryPoint) (test);
-		
-		
-        buf = (char*) 0x8CFF0000;
-		
-        //Debug_Printf(0,1,false,0,buf);
-        //LCD_Refresh();
-        //Debug_WaitKey();
-                
-        //*buf = 0x00; buf++; *buf = 0x0B; buf++; //000B RTS
-        //*buf = 0x00; buf++; *buf = 0x09; //0009 NOP
-        
+
+        int length = Decode(var, buf) - buf;
+
+        struct CacheEntry &entry = g_cache[g_nextCache];
+        g_nextCache = (g_nextCache + 1) % CACHE_SIZE;
+        if (entry.data != nullptr) free(entry.data);
+        entry.data = (char*) malloc(length > 0 ? length : 1);
+        if (entry.data != nullptr) {
+            memcpy(entry.data, buf, length);
+            entry.var = var;
+            entry.size = exec->size;
+            entry.sum = sum;
+            entry.length = length;
+        }
+
 		return (EntryPoint) 0x8CFF0000;
     }
-    
-    
 }
-
@@ -1,24 +1,32 @@
 #pragma once
+#include "strings.hpp"
 
 namespace Execs {
     struct ExecInfo {
         char fileName[9];
         //char path[200];
-        char name[100];
-        char description[100];
-        char author[100];
-        char version[100];
+        // in the string pool, see strings.hpp. The description is read
+        // from the var by LoadDescription when it's shown.
+        Strings::Offset name;
+        Strings::Offset author;
+        Strings::Offset version;
         //char* fp; //this throws linker error: undefined reference to `___movmem_i4_even'
         unsigned char fp[4]; //this is the address of the first byte. A pointer throws an assembler error... This has to work.
+        uint32_t size; // of the var, from its directory entry
     };
 
     typedef void (*EntryPoint)();
 
-    const int MAX_EXECS = 64;
-
-    extern struct ExecInfo g_execs[MAX_EXECS];
+    // a malloc'd array, see array.hpp
+    extern struct ExecInfo *g_execs;
     extern int g_numExecs;
 
     void LoadExecInfo();
+    void Free();
+    // Copies the description of exec i into buf (at most size - 1
+    // characters and the terminator), or an empty string if it has none.
+    void LoadDescription(int i, char *buf, int size);
+    // Decodes exec i into the RAM at 0x8CFF0000. The last few decoded
+    // execs are kept, so starting one again skips the decoding.
     EntryPoint RunExec(int i);
 };
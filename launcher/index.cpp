@@ -0,0 +1,167 @@
+#include <sdk/os/file.hpp>
+#include <sdk/os/mem.hpp>
+#include <sdk/os/string.hpp>
+#include "index.hpp"
+#include "strings.hpp"
+
+namespace Index {
+    const uint32_t MAGIC = 0x48494458; // "HIDX"
+    const uint16_t VERSION = 2;
+
+    // Apps and bins are stored as the same kind of record
+    static_assert(
+        sizeof(Apps::AppInfo) == sizeof(Bins::AppInfo),
+        "Apps::AppInfo and Bins::AppInfo must have the same layout"
+    );
+    typedef struct Apps::AppInfo Record;
+
+    // Followed by the records and then the string pool they point into
+    struct Header {
+        uint32_t magic;
+        uint16_t version;
+        uint16_t recordSize;
+        uint32_t numRecords;
+        uint32_t poolSize;
+    };
+
+    int g_fd = -1;
+    const Record *g_records;
+    int g_numRecords;
+    const char *g_pool;
+    uint32_t g_poolSize;
+    int g_next;
+    int g_hits;
+
+    void Open() {
+        g_records = nullptr;
+        g_numRecords = 0;
+        g_pool = nullptr;
+        g_poolSize = 0;
+        g_next = 0;
+        g_hits = 0;
+
+        g_fd = open(INDEX_PATH, OPEN_READ);
+        if (g_fd < 0) {
+            return;
+        }
+
+        const Header *header;
+        if (getAddr(g_fd, 0, (const void **) &header) < 0) {
+            return;
+        }
+
+        if (
+            header->magic != MAGIC ||
+            header->version != VERSION ||
+            header->recordSize != sizeof(Record) ||
+            header->poolSize == 0
+        ) {
+            return;
+        }
+
+        g_records = reinterpret_cast<const Record *>(header + 1);
+        g_numRecords = header->numRecords;
+        g_pool = reinterpret_cast<const char *>(g_records + g_numRecords);
+        g_poolSize = header->poolSize;
+    }
+
+    static Strings::Offset AddString(Strings::Offset offset) {
+        if (offset >= g_poolSize) {
+            return 0;
+        }
+        return Strings::Add(g_pool + offset);
+    }
+
+    static bool LookupRecord(Record &app, const char *path) {
+        if (app.fileSize == 0) {
+            return false;
+        }
+
+        // The folders are walked in the same order every time, so the next
+        // record is almost always the one we're looking for.
+        for (int n = 0; n < g_numRecords; ++n) {
+            const Record *record = &g_records[g_next];
+            if (++g_next == g_numRecords) {
+                g_next = 0;
+            }
+
+            if (record->path >= g_poolSize || strcmp(g_pool + record->path, path) != 0) {
+                continue;
+            }
+
+            if (
+                record->fileSize != app.fileSize ||
+                record->lastModifiedDate != app.lastModifiedDate ||
+                record->lastModifiedTime != app.lastModifiedTime
+            ) {
+                return false;
+            }
+
+            app.path = Strings::Add(path);
+            app.name = AddString(record->name);
+            app.author = AddString(record->author);
+            app.version = AddString(record->version);
+            g_hits++;
+            return true;
+        }
+
+        return false;
+    }
+
+    bool Lookup(struct Apps::AppInfo &app, const char *path) {
+        return LookupRecord(app, path);
+    }
+
+    bool Lookup(struct Bins::AppInfo &app, const char *path) {
+        return LookupRecord(reinterpret_cast<Record &>(app), path);
+    }
+
+    void Save() {
+        if (g_fd >= 0) {
+            close(g_fd);
+            g_fd = -1;
+        }
+        g_records = nullptr;
+        g_pool = nullptr;
+
+        // Every app was found unchanged and none were removed
+        int numApps = Apps::g_numApps + Bins::g_numApps;
+        if (g_hits == numApps && g_numRecords == numApps) {
+            return;
+        }
+
+        remove(INDEX_PATH);
+        int fd = open(INDEX_PATH, OPEN_WRITE | OPEN_CREATE);
+        if (fd < 0) {
+            return;
+        }
+
+        Header header;
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.recordSize = sizeof(Record);
+        header.numRecords = numApps;
+        header.poolSize = Strings::Size();
+
+        bool ok = write(fd, &header, sizeof(header)) == sizeof(header);
+        int size = Apps::g_numApps * sizeof(Record);
+        if (ok && size > 0) {
+            ok = write(fd, Apps::g_apps, size) == size;
+        }
+        size = Bins::g_numApps * sizeof(Record);
+        if (ok && size > 0) {
+            ok = write(fd, Bins::g_apps, size) == size;
+        }
+        size = Strings::Size();
+        if (ok && size > 0) {
+            ok = write(fd, Strings::Data(), size) == size;
+        }
+        close(fd);
+
+        // Better no index than a broken one. An empty pool can't be read
+        // back either, but then there's nothing to cache.
+        if (!ok || size == 0) {
+            remove(INDEX_PATH);
+        }
+    }
+}
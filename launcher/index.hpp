@@ -0,0 +1,26 @@
+#pragma once
+#include "apps.hpp"
+#include "bins.hpp"
+
+// The app index (\fls0\hhk.idx) remembers the info of every app and bin from
+// the last start, so only files that changed since then have to be opened
+// and parsed again. A file counts as unchanged if its size and last modified
+// date/time (from stat) are still the same.
+namespace Index {
+    const char INDEX_PATH[] = "\\fls0\\hhk.idx";
+
+    // Opens the index, if there is one and it's from this launcher version.
+    void Open();
+
+    // If path is in the index with the signature (fileSize,
+    // lastModifiedDate, lastModifiedTime) already in app, fills in the rest
+    // of app from the index, adding its strings to the string pool, and
+    // returns true.
+    bool Lookup(struct Apps::AppInfo &app, const char *path);
+    bool Lookup(struct Bins::AppInfo &app, const char *path);
+
+    // Closes the index and writes it again from Apps::g_apps, Bins::g_apps
+    // and the string pool, unless every app was found in it unchanged. Call
+    // it before anything else is added to the pool.
+    void Save();
+};
@@ -1,17 +1,30 @@
+#include <sdk/calc/alloc.hpp>
+#include <sdk/calc/stringBuilder.hpp>
+#include <sdk/calc/timer.hpp>
 #include <sdk/os/debug.hpp>
 #include <sdk/os/gui.hpp>
 #include <sdk/os/lcd.hpp>
 #include <sdk/os/mem.hpp>
 #include <sdk/os/string.hpp>
-#include "apps.hpp"
-#include "bins.hpp"
-#include "execs.hpp"
-
-class Launcher : public GUIDialog {
+#include "registry.hpp"
+#include "upload.hpp"
+
+// The dropdown only gets the items of one page of the registry, so opening
+// the launcher takes the same time no matter how many apps there are. The
+// last items of a page switch to the next or previous page when run.
+const int PAGE_SIZE = 32;
+const int SELECT_NEXT_PAGE = -2;
+const int SELECT_PREVIOUS_PAGE = -3;
+// Receives an app over the serial port instead, see upload.hpp
+const int SELECT_SERIAL_UPLOAD = -4;
+
+class Launcher final : public GUIDialog {
 public:
+    // The registry index of the selected entry, or SELECT_NEXT_PAGE /
+    // SELECT_PREVIOUS_PAGE / SELECT_SERIAL_UPLOAD
     int m_selectedProg;
 
-    Launcher() : GUIDialog(
+    Launcher(int page) : GUIDialog(
         GUIDialog::Height95, GUIDialog::AlignTop,
         "Hollyhock Launcher",
         GUIDialog::KeyboardStateNone
@@ -32,71 +45,34 @@ public:
         GetRightX() - 10 - 100, GetTopY() + 45, GetRightX() - 10, GetTopY() + 45 + 35,
         "Close", CLOSE_EVENT_ID
     ) {
-        m_selectedProg = 0;
-
-        Apps::LoadAppInfo();
-        Bins::LoadAppInfo();
-        Execs::LoadExecInfo();
-
-        //Add apps to dropdown
-        for (int i = 0; i < Apps::g_numApps; ++i) {
-            struct Apps::AppInfo *app = &Apps::g_apps[i];
-
-            const char *name = app->path;
-
-            // first char of the name will not be \0 if a name was included.
-            if (app->name[0] != '\0') {  
-                name = app->name;
-            }
-
-            m_appNames.AddMenuItem(*(
-                new GUIDropDownMenuItem(
-                    name, i + 1,
-                    GUIDropDownMenuItem::FlagEnabled |
-                    GUIDropDownMenuItem::FlagTextAlignLeft
-                )
-            ));
+        m_first = page * PAGE_SIZE;
+        m_count = Registry::g_numEntries - m_first;
+        if (m_count > PAGE_SIZE) {
+            m_count = PAGE_SIZE;
         }
-
-        //Add bins to dropdown
-        for (int i = 0; i < Bins::g_numApps; ++i) {
-            struct Bins::AppInfo *app = &Bins::g_apps[i];
-
-            const char *name = app->path;
-
-            // first char of the name will not be \0 if a name was included.
-            if (app->name[0] != '\0') {  
-                name = app->name;
-            }
-
-            m_appNames.AddMenuItem(*(
-                new GUIDropDownMenuItem(
-                    name, i + 1 + Apps::g_numApps, //Add bins after apps
-                    GUIDropDownMenuItem::FlagEnabled |
-                    GUIDropDownMenuItem::FlagTextAlignLeft
-                )
-            ));
+        if (m_count < 0) {
+            m_count = 0;
         }
+        bool hasNext = m_first + m_count < Registry::g_numEntries;
+        bool hasPrevious = page > 0;
 
-        //Add execs to dropdown
-        for (int i = 0; i < Execs::g_numExecs; ++i) {
-            struct Execs::ExecInfo *exec = &Execs::g_execs[i];
+        m_selectedProg = m_count > 0 ? m_first : (hasPrevious ? SELECT_PREVIOUS_PAGE : SELECT_SERIAL_UPLOAD);
 
-            const char *name = exec->fileName;
+        // The wrappers of the dropdown items live as long as the launcher,
+        // so take them all from one block instead of a malloc for every
+        // item. The OS allocates the items themselves.
+        arenaInit(m_menuItems, (m_count + 3) * sizeof(GUIDropDownMenuItem));
 
-            // first char of the name will not be \0 if a name was included.
-            if (exec->name[0] != '\0') {  
-                name = exec->name;
-            }
-
-            m_appNames.AddMenuItem(*(
-                new GUIDropDownMenuItem(
-                    name, i + 1 + Apps::g_numApps + Bins::g_numApps, //Add execs after apps and bins
-                    GUIDropDownMenuItem::FlagEnabled |
-                    GUIDropDownMenuItem::FlagTextAlignLeft
-                )
-            ));
+        for (int i = 0; i < m_count; ++i) {
+            AddItem(Registry::Name(m_first + i), i + 1);
+        }
+        if (hasNext) {
+            AddItem("More apps...", NEXT_PAGE_ITEM);
         }
+        if (hasPrevious) {
+            AddItem("Previous apps...", PREVIOUS_PAGE_ITEM);
+        }
+        AddItem("Receive over serial...", SERIAL_UPLOAD_ITEM);
 
         m_appNames.SetScrollBarVisibility(
             GUIDropDownMenu::ScrollBarVisibleWhenRequired
@@ -105,19 +81,40 @@ public:
 
         AddElement(m_progInfo);
 
-        // Only show the Run button if there's apps or execs to display
-        if (Apps::g_numApps+Bins::g_numApps+Execs::g_numExecs > 0) {
-            AddElement(m_run);
-        }
+        // There's always something to run, the serial upload
+        AddElement(m_run);
 
         AddElement(m_close);
 
-        UpdateAppInfo();
+        if (Registry::g_numEntries > 0) {
+            UpdateAppInfo();
+        }
+    }
+
+    void AddItem(const char *name, int index) {
+        GUIDropDownMenuItem *item = new (m_menuItems) GUIDropDownMenuItem(
+            name, index,
+            GUIDropDownMenuItem::FlagEnabled |
+            GUIDropDownMenuItem::FlagTextAlignLeft
+        );
+        // the arena is full (or arenaInit couldn't get it)
+        if (item == nullptr) {
+            return;
+        }
+        m_appNames.AddMenuItem(*item);
     }
 
     virtual int OnEvent(GUIDialog_Wrapped *dialog, GUIDialog_OnEvent_Data *event) {
         if (event->GetEventID() == APP_NAMES_EVENT_ID && (event->type & 0xF) == 0xD) {
-            m_selectedProg = event->data - 1;
+            if (event->data == NEXT_PAGE_ITEM) {
+                m_selectedProg = SELECT_NEXT_PAGE;
+            } else if (event->data == PREVIOUS_PAGE_ITEM) {
+                m_selectedProg = SELECT_PREVIOUS_PAGE;
+            } else if (event->data == SERIAL_UPLOAD_ITEM) {
+                m_selectedProg = SELECT_SERIAL_UPLOAD;
+            } else {
+                m_selectedProg = m_first + event->data - 1;
+            }
 
             UpdateAppInfo();
 
@@ -128,172 +125,117 @@ public:
     }
 
     void UpdateAppInfo() {
-        // If an invalid index is selected, don't do anything
-        if (m_selectedProg >= (Apps::g_numApps + Bins::g_numApps + Execs::g_numExecs)) return;
-        // Check if an exec is selecter or an app is selected
-        if (m_selectedProg >= (Apps::g_numApps + Bins::g_numApps)){
-
-            //An exec is selected
-            struct Execs::ExecInfo *exec = &Execs::g_execs[m_selectedProg-Apps::g_numApps-Bins::g_numApps];
-            bool hasName = exec->name[0] != '\0';
-            bool hasDescription = exec->description[0] != '\0';
-            bool hasAuthor = exec->author[0] != '\0';
-            bool hasVersion = exec->version[0] != '\0';
-
-            memset(m_progInfoString, 0, sizeof(m_progInfoString));
-
-            if (hasName) {
-                strcat(m_progInfoString, exec->name);
-            } else {
-                strcat(m_progInfoString, "hhk/");
-                strcat(m_progInfoString, exec->fileName);
-            }
-
-            if (hasAuthor || hasVersion) {
-                strcat(m_progInfoString, "\n(");
-
-                if (hasVersion) {
-                    strcat(m_progInfoString, "version ");
-                    strcat(m_progInfoString, exec->version);
-                }
-
-                if (hasAuthor) {
-                    if (hasVersion) {
-                        strcat(m_progInfoString, " by ");
-                    } else {
-                        strcat(m_progInfoString, "by ");
-                    }
-
-                    strcat(m_progInfoString, exec->author);
-                }
-
-                strcat(m_progInfoString, ")");
+        if (m_selectedProg == SELECT_NEXT_PAGE) {
+            strcpy(m_progInfoString, "Press Run to show the next apps.");
+        } else if (m_selectedProg == SELECT_PREVIOUS_PAGE) {
+            strcpy(m_progInfoString, "Press Run to show the previous apps.");
+        } else if (m_selectedProg == SELECT_SERIAL_UPLOAD) {
+            strcpy(m_progInfoString, "Press Run to receive a .bin over the serial port (115200 baud) and start it.\n\nSend it with tools/upload.py.");
+        } else {
+            struct Registry::Info info;
+            Registry::GetInfo(m_selectedProg, info);
+            SetProgInfo(info);
+            Registry::LoadDescription(m_selectedProg, AddDescription(), DescriptionSize());
+
+            // App Name (version 1.0.0 by Meme King)
+            // (from \fls0\meme.hhk)
+            //
+            // Meme to your heart's content.
+
+            // Only keep the blank line if there is a description
+            if (m_progInfoString[m_descriptionStart] == '\0') {
+                m_progInfoString[m_descriptionStart - 2] = '\0';
             }
+        }
 
-            if (hasName) {
-                strcat(m_progInfoString, "\n(from hhk/");
-                strcat(m_progInfoString, exec->fileName);
-                strcat(m_progInfoString, ")");
-            }
+        m_progInfo.SetText(m_progInfoString);
+        m_progInfo.Refresh();
+        Refresh();
+    }
 
-            if (hasDescription) {
-                strcat(m_progInfoString, "\n\n");
-                strcat(m_progInfoString, exec->description);
-            }
+    // Everything but the description, which is read from the file and
+    // placed at AddDescription()
+    void SetProgInfo(struct Registry::Info &info) {
+        const char *name = info.name;
+        const char *author = info.author;
+        const char *version = info.version;
+        const char *from = info.from;
+        bool hasName = name[0] != '\0';
+        bool hasAuthor = author[0] != '\0';
+        bool hasVersion = version[0] != '\0';
+
+        StringBuilder sb;
+        stringBuilderInit(sb, m_progInfoString);
+
+        if (hasName) {
+            appendString(sb, name);
+        } else {
+            appendString(sb, from);
         }
-        else
-        if (m_selectedProg >= (Apps::g_numApps)){
 
-            //A bin is selected
-            struct Bins::AppInfo *app = &Bins::g_apps[m_selectedProg-Apps::g_numApps];
-            bool hasName = app->name[0] != '\0';
-            bool hasDescription = app->description[0] != '\0';
-            bool hasAuthor = app->author[0] != '\0';
-            bool hasVersion = app->version[0] != '\0';
+        if (hasAuthor || hasVersion) {
+            appendString(sb, "\n(");
 
-            memset(m_progInfoString, 0, sizeof(m_progInfoString));
-
-            if (hasName) {
-                strcat(m_progInfoString, app->name);
-            } else {
-                strcat(m_progInfoString, app->path);
+            if (hasVersion) {
+                appendString(sb, "version ");
+                appendString(sb, version);
             }
 
-            if (hasAuthor || hasVersion) {
-                strcat(m_progInfoString, "\n(");
-
+            if (hasAuthor) {
                 if (hasVersion) {
-                    strcat(m_progInfoString, "version ");
-                    strcat(m_progInfoString, app->version);
+                    appendString(sb, " by ");
+                } else {
+                    appendString(sb, "by ");
                 }
 
-                if (hasAuthor) {
-                    if (hasVersion) {
-                        strcat(m_progInfoString, " by ");
-                    } else {
-                        strcat(m_progInfoString, "by ");
-                    }
-
-                    strcat(m_progInfoString, app->author);
-                }
-
-                strcat(m_progInfoString, ")");
-            }
-
-            if (hasName) {
-                strcat(m_progInfoString, "\n(from ");
-                strcat(m_progInfoString, app->path);
-                strcat(m_progInfoString, ")");
-            }
-
-            if (hasDescription) {
-                strcat(m_progInfoString, "\n\n");
-                strcat(m_progInfoString, app->description);
-            }
-		}
-		else
-        {
-
-            //An app is selected
-            struct Apps::AppInfo *app = &Apps::g_apps[m_selectedProg];
-            bool hasName = app->name[0] != '\0';
-            bool hasDescription = app->description[0] != '\0';
-            bool hasAuthor = app->author[0] != '\0';
-            bool hasVersion = app->version[0] != '\0';
-
-            memset(m_progInfoString, 0, sizeof(m_progInfoString));
-
-            if (hasName) {
-                strcat(m_progInfoString, app->name);
-            } else {
-                strcat(m_progInfoString, app->path);
+                appendString(sb, author);
             }
 
-            if (hasAuthor || hasVersion) {
-                strcat(m_progInfoString, "\n(");
-
-                if (hasVersion) {
-                    strcat(m_progInfoString, "version ");
-                    strcat(m_progInfoString, app->version);
-                }
-
-                if (hasAuthor) {
-                    if (hasVersion) {
-                        strcat(m_progInfoString, " by ");
-                    } else {
-                        strcat(m_progInfoString, "by ");
-                    }
+            appendChar(sb, ')');
+        }
 
-                    strcat(m_progInfoString, app->author);
-                }
+        if (hasName) {
+            appendString(sb, "\n(from ");
+            appendString(sb, from);
+            appendChar(sb, ')');
+        }
 
-                strcat(m_progInfoString, ")");
-            }
+        appendString(sb, "\n\n");
+        m_descriptionStart = sb.length;
+    }
 
-            if (hasName) {
-                strcat(m_progInfoString, "\n(from ");
-                strcat(m_progInfoString, app->path);
-                strcat(m_progInfoString, ")");
-            }
+    char *AddDescription() {
+        return m_progInfoString + m_descriptionStart;
+    }
 
-            if (hasDescription) {
-                strcat(m_progInfoString, "\n\n");
-                strcat(m_progInfoString, app->description);
-            }
+    int DescriptionSize() {
+        return sizeof(m_progInfoString) - m_descriptionStart;
+    }
 
-        // App Name (version 1.0.0 by Meme King)
-        // \fls0\meme.hhk
+private:
+    // Frees the block of the item wrappers once everything else of the
+    // launcher is gone, see m_menuItems.
+    struct ItemArena : Arena {
+        // empty until arenaInit, so the destructor also works if that failed
+        ItemArena() : Arena() {
+        }
+        ~ItemArena() {
+            arenaFree(*this);
+        }
+    };
 
-        // Meme to your heart's content.
+    // Before m_appNames, so it's destroyed after the dropdown that uses the
+    // items
+    ItemArena m_menuItems;
 
-        }
+    // the part of the registry on this page
+    int m_first;
+    int m_count;
 
-        m_progInfo.SetText(m_progInfoString);
-        m_progInfo.Refresh();
-        Refresh();
-    }
+    const int NEXT_PAGE_ITEM = PAGE_SIZE + 1;
+    const int PREVIOUS_PAGE_ITEM = PAGE_SIZE + 2;
+    const int SERIAL_UPLOAD_ITEM = PAGE_SIZE + 3;
 
-private:
     const uint16_t APP_NAMES_EVENT_ID = 1;
     GUIDropDownMenu m_appNames;
 
@@ -305,6 +247,7 @@ private:
     // because GUIDialog has the copy/move ctor deleted. This should therefore
     // be a safe solution.
     char m_progInfoString[500];
+    int m_descriptionStart;
 
     const uint16_t RUN_EVENT_ID = GUIDialog::DialogResultOK;
     GUIButton m_run;
@@ -314,29 +257,85 @@ private:
 };
 
 void main() {
-    Launcher launcher;
-    if (launcher.ShowDialog() == GUIDialog::DialogResultOK) {
-        if (launcher.m_selectedProg >= Apps::g_numApps+Bins::g_numApps){
-	        //Exec selected
-			Execs::EntryPoint epE = Execs::RunExec(launcher.m_selectedProg-Apps::g_numApps-Bins::g_numApps);
-			if (epE != nullptr) {
-				epE();
-			}
-		}
-		else if (launcher.m_selectedProg >= Apps::g_numApps){
-	        //Bin selected
-			Bins::EntryPoint epA = Bins::RunApp(launcher.m_selectedProg-Apps::g_numApps);
-			if (epA != nullptr) {
-				epA();
-			}
-		}
-
-		else{
-			//App selected
-			Apps::EntryPoint epA = Apps::RunApp(launcher.m_selectedProg);
-			if (epA != nullptr) {
-				epA();
-			}
-		}
+    Registry::Load();
+
+    // Every page is built once and shown again when the user comes back to
+    // it: the OS has no way to free a dialog and its elements, so building a
+    // page on every flip would lose them each time. The launchers are on the
+    // heap so their memory (and the registry) can be given back before the
+    // app is started.
+    int numPages = (Registry::g_numEntries + PAGE_SIZE - 1) / PAGE_SIZE;
+    if (numPages < 1) {
+        numPages = 1;
+    }
+    Launcher **pages = static_cast<Launcher **>(malloc(numPages * sizeof(Launcher *)));
+    if (pages == nullptr) {
+        Registry::Free();
+        return;
+    }
+    memset(pages, 0, numPages * sizeof(Launcher *));
+
+    int page = 0;
+    int selected;
+    while (true) {
+        if (pages[page] == nullptr) {
+            pages[page] = new (std::nothrow) Launcher(page);
+            if (pages[page] == nullptr) {
+                selected = -1;
+                break;
+            }
+        }
+        Launcher *launcher = pages[page];
+        bool ok = launcher->ShowDialog() == GUIDialog::DialogResultOK;
+        selected = launcher->m_selectedProg;
+
+        if (!ok) {
+            selected = -1;
+            break;
+        }
+
+        if (selected == SELECT_NEXT_PAGE) {
+            page++;
+        } else if (selected == SELECT_PREVIOUS_PAGE) {
+            page--;
+        } else if (selected == SELECT_SERIAL_UPLOAD) {
+            break;
+        } else {
+            break;
+        }
+    }
+
+    for (int i = 0; i < numPages; ++i) {
+        delete pages[i];
+    }
+    free(pages);
+
+    Registry::EntryPoint entryPoint = nullptr;
+    if (selected >= 0) {
+#ifdef LOAD_TIMING
+        // make LOAD_TIMING=1 shows how long loading the program took
+        timerInit();
+        uint32_t start = timerMicros();
+#endif
+        entryPoint = Registry::Run(selected);
+#ifdef LOAD_TIMING
+        uint32_t time = timerMicros() - start;
+        timerEnd();
+
+        LCD_ClearScreen();
+        Debug_Printf(0, 0, false, 0, "Loaded in %d.%03d ms", time / 1000, time % 1000);
+        Debug_Printf(0, 1, false, 0, "Press any key to start");
+        LCD_Refresh();
+        Debug_WaitKey();
+#endif
+    } else if (selected == SELECT_SERIAL_UPLOAD) {
+        entryPoint = Upload::Receive();
+    }
+
+    Registry::Free();
+
+    if (entryPoint != nullptr) {
+        entryPoint();
     }
+    Registry::Finish();
 }
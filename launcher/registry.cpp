@@ -0,0 +1,200 @@
+#include <sdk/os/dirWalker.hpp>
+#include <sdk/os/mem.hpp>
+#include <sdk/os/string.hpp>
+#include "registry.hpp"
+#include "apps.hpp"
+#include "array.hpp"
+#include "bins.hpp"
+#include "execs.hpp"
+#include "index.hpp"
+#include "strings.hpp"
+
+namespace Registry {
+    // Where the .hhk, .bin and .hhz are looked for. Apps in \fls0\bin can
+    // also be in folders of their own, two levels deep.
+    const struct DirWalkerFolder APP_FOLDERS[] = {
+        {"\\fls0\\", 0},
+        {"\\fls0\\bin\\", 2}
+    };
+
+    struct Entry *g_entries;
+    int g_numEntries;
+    int g_capacity;
+
+    static void Add(Kind kind, int index) {
+        struct Entry *entry = Array::Reserve(g_entries, g_numEntries, g_capacity);
+        if (entry == nullptr) {
+            return;
+        }
+        entry->kind = kind;
+        entry->index = index;
+        g_numEntries++;
+    }
+
+    static char Lower(char c) {
+        return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+    }
+
+    // By name ignoring the case, then by kind and index so the order is
+    // always the same
+    static int Compare(const struct Entry &a, const char *nameA, const struct Entry &b, const char *nameB) {
+        for (int i = 0; ; ++i) {
+            char ca = Lower(nameA[i]);
+            char cb = Lower(nameB[i]);
+            if (ca != cb) {
+                return ca < cb ? -1 : 1;
+            }
+            if (ca == '\0') {
+                break;
+            }
+        }
+
+        if (a.kind != b.kind) {
+            return a.kind < b.kind ? -1 : 1;
+        }
+        return a.index - b.index;
+    }
+
+    static const char *Name(const struct Entry &entry) {
+        switch (entry.kind) {
+        case KindApp: {
+            struct Apps::AppInfo *app = &Apps::g_apps[entry.index];
+            return Strings::Get(app->name != 0 ? app->name : app->path);
+        }
+        case KindBin: {
+            struct Bins::AppInfo *app = &Bins::g_apps[entry.index];
+            return Strings::Get(app->name != 0 ? app->name : app->path);
+        }
+        default: {
+            struct Execs::ExecInfo *exec = &Execs::g_execs[entry.index];
+            return exec->name != 0 ? Strings::Get(exec->name) : exec->fileName;
+        }
+        }
+    }
+
+    // Shell sort, it doesn't need any memory and the lists are short
+    static void Sort() {
+        int gap = 1;
+        while (gap < g_numEntries / 3) {
+            gap = gap * 3 + 1;
+        }
+
+        for (; gap > 0; gap = (gap - 1) / 3) {
+            for (int i = gap; i < g_numEntries; ++i) {
+                struct Entry entry = g_entries[i];
+                const char *name = Name(entry);
+
+                int j = i;
+                while (j >= gap && Compare(entry, name, g_entries[j - gap], Name(g_entries[j - gap])) < 0) {
+                    g_entries[j] = g_entries[j - gap];
+                    j -= gap;
+                }
+                g_entries[j] = entry;
+            }
+        }
+    }
+
+    void Load() {
+        Index::Open();
+        // one pass over the folders for all kinds of apps
+        DirWalker walker;
+        Apps::AddPatterns(walker);
+        Bins::AddPatterns(walker);
+        walker.Walk(APP_FOLDERS, sizeof(APP_FOLDERS) / sizeof(APP_FOLDERS[0]));
+        Index::Save();
+        Execs::LoadExecInfo();
+
+        g_numEntries = 0;
+        for (int i = 0; i < Apps::g_numApps; ++i) {
+            Add(KindApp, i);
+        }
+        for (int i = 0; i < Bins::g_numApps; ++i) {
+            Add(KindBin, i);
+        }
+        for (int i = 0; i < Execs::g_numExecs; ++i) {
+            Add(KindExec, i);
+        }
+
+        Sort();
+    }
+
+    const char *Name(int i) {
+        return Name(g_entries[i]);
+    }
+
+    void GetInfo(int i, struct Info &info) {
+        struct Entry *entry = &g_entries[i];
+
+        switch (entry->kind) {
+        case KindApp: {
+            struct Apps::AppInfo *app = &Apps::g_apps[entry->index];
+            info.name = Strings::Get(app->name);
+            info.author = Strings::Get(app->author);
+            info.version = Strings::Get(app->version);
+            info.from = Strings::Get(app->path);
+            break;
+        }
+        case KindBin: {
+            struct Bins::AppInfo *app = &Bins::g_apps[entry->index];
+            info.name = Strings::Get(app->name);
+            info.author = Strings::Get(app->author);
+            info.version = Strings::Get(app->version);
+            info.from = Strings::Get(app->path);
+            break;
+        }
+        case KindExec: {
+            struct Execs::ExecInfo *exec = &Execs::g_execs[entry->index];
+            info.name = Strings::Get(exec->name);
+            info.author = Strings::Get(exec->author);
+            info.version = Strings::Get(exec->version);
+            strcpy(info.fromBuffer, "hhk/");
+            strcat(info.fromBuffer, exec->fileName);
+            info.from = info.fromBuffer;
+            break;
+        }
+        }
+    }
+
+    void LoadDescription(int i, char *buf, int size) {
+        struct Entry *entry = &g_entries[i];
+
+        switch (entry->kind) {
+        case KindApp:
+            Apps::LoadDescription(entry->index, buf, size);
+            break;
+        case KindBin:
+            Bins::LoadDescription(entry->index, buf, size);
+            break;
+        case KindExec:
+            Execs::LoadDescription(entry->index, buf, size);
+            break;
+        }
+    }
+
+    EntryPoint Run(int i) {
+        struct Entry *entry = &g_entries[i];
+
+        switch (entry->kind) {
+        case KindApp:
+            return Apps::RunApp(entry->index);
+        case KindBin:
+            return Bins::RunApp(entry->index);
+        case KindExec:
+            return Execs::RunExec(entry->index);
+        }
+
+        return nullptr;
+    }
+
+    void Free() {
+        Array::Free(g_entries, g_numEntries, g_capacity);
+        Apps::Free();
+        Bins::Free();
+        Execs::Free();
+        Strings::Free();
+    }
+
+    void Finish() {
+        Apps::CloseFile();
+    }
+}
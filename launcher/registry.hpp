@@ -0,0 +1,53 @@
+#pragma once
+#include <stdint.h>
+
+// All apps, bins and execs in one list, sorted by name
+namespace Registry {
+    enum Kind : uint8_t {
+        KindApp,
+        KindBin,
+        KindExec
+    };
+
+    struct Entry {
+        Kind kind;
+        // into Apps::g_apps, Bins::g_apps or Execs::g_execs
+        uint16_t index;
+    };
+
+    // What the launcher shows about an entry, besides the description. The
+    // strings are empty if the entry doesn't have them.
+    struct Info {
+        const char *name;
+        const char *author;
+        const char *version;
+        // where it's from (the path, or hhk/ and the name of the var)
+        const char *from;
+        char fromBuffer[16];
+    };
+
+    typedef void (*EntryPoint)();
+
+    extern struct Entry *g_entries;
+    extern int g_numEntries;
+
+    // Loads the info of everything (using the index, see index.hpp) and
+    // sorts it.
+    void Load();
+
+    // The name to show in the list: the name, or where it's from if it has
+    // none.
+    const char *Name(int i);
+    void GetInfo(int i, struct Info &info);
+    // See Apps::LoadDescription
+    void LoadDescription(int i, char *buf, int size);
+    EntryPoint Run(int i);
+
+    // Frees the lists and the string pool. Entry points returned by Run stay
+    // valid.
+    void Free();
+
+    // Closes the files an app started by Run kept open while it ran (see
+    // Apps::RunApp). Call it once the app has returned.
+    void Finish();
+};
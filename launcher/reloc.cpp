@@ -0,0 +1,138 @@
+#include "reloc.hpp"
+
+namespace Reloc {
+    const uint32_t RAM_START = 0x8C000000;
+    const uint32_t RAM_END = 0x8D000000;
+
+    bool Moves(uint32_t address) {
+        return address >= RAM_START && address < RAM_END;
+    }
+
+    // The relocation sections that apply to a loaded section
+    static bool IsLoadedRelocations(const Elf32_Ehdr *elf, const Elf32_Shdr *sectionHeaders, const Elf32_Shdr *sectionHeader) {
+        if (sectionHeader->sh_type != SHT_RELA || sectionHeader->sh_info >= elf->e_shnum) {
+            return false;
+        }
+        return (sectionHeaders[sectionHeader->sh_info].sh_flags & SHF_ALLOC) == SHF_ALLOC;
+    }
+
+    bool IsRelocatable(const Elf32_Ehdr *elf, const Elf32_Shdr *sectionHeaders) {
+        for (int i = 0; i < elf->e_shnum; ++i) {
+            if (IsLoadedRelocations(elf, sectionHeaders, &sectionHeaders[i])) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    uint32_t LinkBase(const Elf32_Ehdr *elf, const Elf32_Shdr *sectionHeaders) {
+        uint32_t base = RAM_END;
+        for (int i = 0; i < elf->e_shnum; ++i) {
+            const Elf32_Shdr *sectionHeader = &sectionHeaders[i];
+            if (
+                (sectionHeader->sh_flags & SHF_ALLOC) == SHF_ALLOC &&
+                Moves(sectionHeader->sh_addr) &&
+                sectionHeader->sh_addr < base
+            ) {
+                base = sectionHeader->sh_addr;
+            }
+        }
+        return base;
+    }
+
+    // The words may not be aligned (in packed data)
+    static void Add32(uint8_t *p, int32_t value) {
+        uint32_t word = (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+        word += value;
+        p[0] = word >> 24;
+        p[1] = word >> 16;
+        p[2] = word >> 8;
+        p[3] = word;
+    }
+
+    bool Apply(const Elf32_Ehdr *elf, const Elf32_Shdr *sectionHeaders, int32_t delta) {
+        const uint8_t *file = reinterpret_cast<const uint8_t *>(elf);
+
+        for (int i = 0; i < elf->e_shnum; ++i) {
+            const Elf32_Shdr *relocations = &sectionHeaders[i];
+            if (!IsLoadedRelocations(elf, sectionHeaders, relocations)) {
+                continue;
+            }
+            if (relocations->sh_link >= elf->e_shnum) {
+                return false;
+            }
+
+            const Elf32_Shdr *symbolTable = &sectionHeaders[relocations->sh_link];
+            const Elf32_Sym *symbols = reinterpret_cast<const Elf32_Sym *>(file + symbolTable->sh_offset);
+            uint32_t numSymbols = symbolTable->sh_size / sizeof(Elf32_Sym);
+
+            const Elf32_Rela *rela = reinterpret_cast<const Elf32_Rela *>(file + relocations->sh_offset);
+            uint32_t count = relocations->sh_size / sizeof(Elf32_Rela);
+
+            for (uint32_t j = 0; j < count; ++j) {
+                uint32_t type = ELF32_R_TYPE(rela[j].r_info);
+                uint32_t symbol = ELF32_R_SYM(rela[j].r_info);
+                if (symbol >= numSymbols) {
+                    return false;
+                }
+
+                // how far the place and the symbol have moved
+                int32_t placeDelta = Moves(rela[j].r_offset) ? delta : 0;
+                int32_t symbolDelta = 0;
+                uint16_t section = symbols[symbol].st_shndx;
+                if (
+                    section != SHN_UNDEF && section != SHN_ABS && section < elf->e_shnum &&
+                    Moves(sectionHeaders[section].sh_addr)
+                ) {
+                    symbolDelta = delta;
+                }
+
+                uint8_t *place = reinterpret_cast<uint8_t *>(rela[j].r_offset + placeDelta);
+
+                switch (type) {
+                case R_SH_DIR32:
+                    Add32(place, symbolDelta);
+                    break;
+
+                case R_SH_REL32:
+                    Add32(place, symbolDelta - placeDelta);
+                    break;
+
+                // short displacements, only fine if they didn't change
+                case R_SH_DIR8WPN:
+                case R_SH_IND12W:
+                case R_SH_DIR8WPL:
+                case R_SH_DIR8WPZ:
+                case R_SH_DIR8BP:
+                case R_SH_DIR8W:
+                case R_SH_DIR8L:
+                    if (symbolDelta != placeDelta) {
+                        return false;
+                    }
+                    break;
+
+                // differences between labels and markers for linker
+                // relaxation, nothing to do
+                case R_SH_NONE:
+                case R_SH_SWITCH8:
+                case R_SH_SWITCH16:
+                case R_SH_SWITCH32:
+                case R_SH_USES:
+                case R_SH_COUNT:
+                case R_SH_ALIGN:
+                case R_SH_CODE:
+                case R_SH_DATA:
+                case R_SH_LABEL:
+                case R_SH_GNU_VTINHERIT:
+                case R_SH_GNU_VTENTRY:
+                    break;
+
+                default:
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <stdint.h>
+#include "elf.h"
+
+// Loading a .hhk somewhere else than where it was linked. This needs the
+// relocations, which the linker only keeps with --emit-relocs (make
+// RELOCATABLE=1 in the app template).
+//
+// Only the sections in the normal RAM move, the on-chip RAM sections (see
+// sdk/calc/onchip.hpp) stay at their addresses, and so do absolute symbols
+// like the OS functions. The whole image moves together, so jumps inside it
+// stay the same; R_SH_DIR32 gets the distance added, R_SH_REL32 only if it
+// points from the image to a symbol that doesn't move (or the other way).
+namespace Reloc {
+    // true if address is in the part of an app that moves
+    bool Moves(uint32_t address);
+
+    // true if the ELF has the relocations of its loaded sections
+    bool IsRelocatable(const Elf32_Ehdr *elf, const Elf32_Shdr *sectionHeaders);
+
+    // The lowest address of the loaded sections that move
+    uint32_t LinkBase(const Elf32_Ehdr *elf, const Elf32_Shdr *sectionHeaders);
+
+    // Fixes the loaded image, which has been copied delta bytes away from
+    // where it was linked. Returns false if a relocation can't be applied.
+    bool Apply(const Elf32_Ehdr *elf, const Elf32_Shdr *sectionHeaders, int32_t delta);
+};
@@ -0,0 +1,108 @@
+#include <sdk/os/mem.hpp>
+#include <sdk/os/string.hpp>
+#include "strings.hpp"
+
+namespace Strings {
+    const int INITIAL_CAPACITY = 4096;
+    const int MAX_CAPACITY = 0x10000;
+
+    char *g_pool;
+    int g_size;
+    int g_capacity;
+
+    static bool Grow(int needed) {
+        int capacity = g_capacity == 0 ? INITIAL_CAPACITY : g_capacity * 2;
+        while (capacity < needed) {
+            capacity *= 2;
+        }
+        if (capacity > MAX_CAPACITY) {
+            capacity = MAX_CAPACITY;
+        }
+        if (capacity < needed) {
+            return false;
+        }
+
+        char *pool = static_cast<char *>(malloc(capacity));
+        if (pool == nullptr) {
+            return false;
+        }
+
+        if (g_pool == nullptr) {
+            // offset 0 is the empty string
+            pool[0] = '\0';
+            g_size = 1;
+        } else {
+            memcpy(pool, g_pool, g_size);
+            free(g_pool);
+        }
+
+        g_pool = pool;
+        g_capacity = capacity;
+        return true;
+    }
+
+    Offset Add(const char *string, int length) {
+        if (length < 0) {
+            length = strlen(string);
+        } else {
+            // stop early at a terminator
+            for (int i = 0; i < length; ++i) {
+                if (string[i] == '\0') {
+                    length = i;
+                    break;
+                }
+            }
+        }
+
+        if (length == 0) {
+            return 0;
+        }
+
+        if (g_size + length + 1 > g_capacity && !Grow(g_size + length + 1)) {
+            return 0;
+        }
+
+        Offset offset = g_size;
+        memcpy(g_pool + g_size, string, length);
+        g_pool[g_size + length] = '\0';
+        g_size += length + 1;
+        return offset;
+    }
+
+    const char *Get(Offset offset) {
+        if (g_pool == nullptr) {
+            return "";
+        }
+        return g_pool + offset;
+    }
+
+    void Copy(char *buf, int size, const char *string, int length) {
+        if (size <= 0) {
+            return;
+        }
+
+        int i = 0;
+        while (i < size - 1 && (length < 0 || i < length) && string[i] != '\0') {
+            buf[i] = string[i];
+            i++;
+        }
+        buf[i] = '\0';
+    }
+
+    const char *Data() {
+        return g_pool;
+    }
+
+    int Size() {
+        return g_size;
+    }
+
+    void Free() {
+        if (g_pool != nullptr) {
+            free(g_pool);
+        }
+        g_pool = nullptr;
+        g_size = 0;
+        g_capacity = 0;
+    }
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include <stdint.h>
+
+// One pool for the names, paths, authors and versions of all apps, bins and
+// execs. They are kept as offsets into the pool rather than pointers, so the
+// pool can move when it grows. Offset 0 is always the empty string.
+namespace Strings {
+    typedef uint16_t Offset;
+
+    // Copies string (up to length characters, or up to the terminator if
+    // length is negative) into the pool. Returns 0 (the empty string) if the
+    // string is empty or there's no room left.
+    Offset Add(const char *string, int length = -1);
+
+    const char *Get(Offset offset);
+
+    // Copies string (like Add) into buf, cut off to fit size - 1 characters
+    // and the terminator.
+    void Copy(char *buf, int size, const char *string, int length = -1);
+
+    // The whole pool, as written to the index
+    const char *Data();
+    int Size();
+
+    void Free();
+};
@@ -0,0 +1,208 @@
+#include <sdk/calc/calc.hpp>
+#include <sdk/calc/timer.hpp>
+#include <sdk/calc/xip.hpp>
+#include <sdk/os/debug.hpp>
+#include <sdk/os/lcd.hpp>
+#include <sdk/os/mem.hpp>
+#include <sdk/os/serial.hpp>
+#include "upload.hpp"
+
+namespace Upload {
+    const uint32_t RAM_START = 0x8C000000;
+    const uint32_t RAM_END = 0x8D000000;
+    // where the launcher itself runs (see linker.ld), nothing may be
+    // received over it
+    const uint32_t LAUNCHER_START = 0x8CFE0000;
+    const uint32_t LAUNCHER_END = 0x8CFF0000;
+
+    // once a frame has started, the rest of it has to come within this
+    const uint32_t FRAME_TIMEOUT = 500000;
+
+    struct Header {
+        uint32_t magic;
+        uint32_t loadAddress;
+        uint32_t loadSize;
+        uint32_t bssSize;
+        uint32_t xipSize;
+        uint32_t flags;
+    };
+
+    bool g_cancelled;
+
+    bool Cancelled() {
+        uint32_t key1, key2;
+        getKey(&key1, &key2);
+        if (testKey(key1, key2, KEY_CLEAR)) {
+            g_cancelled = true;
+        }
+        return g_cancelled;
+    }
+
+    // Reads count bytes. With wait the first byte may take as long as it
+    // takes, otherwise everything has to arrive within FRAME_TIMEOUT.
+    bool ReadBytes(uint8_t *buf, int count, bool wait) {
+        int done = 0;
+        uint32_t start = timerMicros();
+        while (done < count) {
+            int waiting = Serial_PollRX();
+            if (waiting > 0) {
+                short got = 0;
+                Serial_Read(buf + done, waiting < count - done ? waiting : count - done, &got);
+                done += got;
+                start = timerMicros();
+                wait = false;
+                continue;
+            }
+            if (wait ? Cancelled() : timerMicros() - start > FRAME_TIMEOUT) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    uint32_t Adler32(const uint8_t *data, int count) {
+        // count is at most MAX_FRAME + 4, far from where the sums could
+        // overflow before the modulo
+        uint32_t a = 1, b = 0;
+        for (int i = 0; i < count; ++i) {
+            a += data[i];
+            b += a;
+        }
+        return ((b % 65521) << 16) | (a % 65521);
+    }
+
+    uint32_t GetU32(const uint8_t *p) {
+        return (p[0] << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+    }
+
+    // Checks where the image goes, returns false if it doesn't fit
+    bool CheckHeader(const struct Header &header) {
+        if (header.magic != MAGIC || header.loadAddress < RAM_START || header.loadAddress >= RAM_END) {
+            return false;
+        }
+        uint32_t room = RAM_END - header.loadAddress;
+        if (header.loadSize > room || header.bssSize > room - header.loadSize) {
+            return false;
+        }
+        uint32_t size = (header.loadSize + header.bssSize + 3) & ~3;
+        if (header.xipSize > room - size) {
+            return false;
+        }
+        uint32_t end = header.loadAddress + size + header.xipSize;
+        return end <= LAUNCHER_START || header.loadAddress >= LAUNCHER_END;
+    }
+
+    void Status(const char *text, uint32_t done, uint32_t total) {
+        LCD_ClearScreen();
+        Debug_Printf(0, 0, false, 0, "Serial upload (115200 baud)");
+        Debug_Printf(0, 2, false, 0, text);
+        if (total > 0) {
+            Debug_Printf(0, 3, false, 0, "%d of %d bytes", done, total);
+        }
+        Debug_Printf(0, 5, false, 0, "Press Clear to cancel");
+        LCD_Refresh();
+    }
+
+    EntryPoint Receive() {
+        if (!Serial_IsOpen()) {
+            unsigned char mode[6] = {0, 9, 0, 0, 0, 0}; //115200 baud, 8N1
+            Serial_Open(mode);
+        }
+        Serial_ClearRX();
+        timerInit();
+        g_cancelled = false;
+        Status("Waiting for tools/upload.py...", 0, 0);
+
+        uint8_t frame[4 + MAX_FRAME + 4];
+        struct Header header;
+        bool haveHeader = false;
+        uint16_t expected = 0;
+        uint32_t received = 0, total = 0;
+        uint8_t *dest = nullptr, *xip = nullptr;
+
+        while (!haveHeader || received < total) {
+            if (!ReadBytes(frame, 4, true)) {
+                if (g_cancelled) {
+                    break;
+                }
+                continue;
+            }
+            uint16_t sequence = (frame[0] << 8) | frame[1];
+            int length = (frame[2] << 8) | frame[3];
+            if (
+                length > MAX_FRAME ||
+                !ReadBytes(frame + 4, length + 4, false) ||
+                Adler32(frame, 4 + length) != GetU32(frame + 4 + length)
+            ) {
+                // out of step: wait until the sender stops, then ask again
+                while (ReadBytes(frame, 1, false));
+                Serial_WriteSingle(NAK);
+                continue;
+            }
+
+            if (sequence == (uint16_t) (expected - 1)) {
+                // our ACK was lost, the sender repeated the last frame
+                Serial_WriteSingle(ACK);
+                continue;
+            }
+            if (sequence != expected) {
+                Serial_WriteSingle(NAK);
+                continue;
+            }
+
+            const uint8_t *data = frame + 4;
+            if (!haveHeader) {
+                if (length != sizeof(header)) {
+                    Serial_WriteSingle(NAK);
+                    continue;
+                }
+                header.magic = GetU32(data);
+                header.loadAddress = GetU32(data + 4);
+                header.loadSize = GetU32(data + 8);
+                header.bssSize = GetU32(data + 12);
+                header.xipSize = GetU32(data + 16);
+                header.flags = GetU32(data + 20);
+                if (!CheckHeader(header)) {
+                    Status("The app doesn't fit into the RAM", 0, 0);
+                    g_cancelled = true;
+                    break;
+                }
+                haveHeader = true;
+                dest = reinterpret_cast<uint8_t *>(header.loadAddress);
+                xip = dest + ((header.loadSize + header.bssSize + 3) & ~3);
+                total = header.loadSize + header.xipSize;
+            } else {
+                uint32_t left = received < header.loadSize ? header.loadSize - received : total - received;
+                if (static_cast<uint32_t>(length) > left) {
+                    Serial_WriteSingle(NAK);
+                    continue;
+                }
+                if (received < header.loadSize) {
+                    memcpy(dest + received, data, length);
+                } else {
+                    memcpy(xip + received - header.loadSize, data, length);
+                }
+                received += length;
+            }
+            expected++;
+            // showing the progress costs time, only do it every 16 KiB (and
+            // before the ACK, the sender waits for it)
+            if ((received & 0x3FFF) < static_cast<uint32_t>(length)) {
+                Status("Receiving...", received, total);
+            }
+            Serial_WriteSingle(ACK);
+        }
+        timerEnd();
+
+        if (g_cancelled) {
+            return nullptr;
+        }
+
+        memset(dest + header.loadSize, 0, header.bssSize);
+        if (header.flags & FLAG_BIN_HEADER) {
+            struct BinHeader *loadedHeader = reinterpret_cast<struct BinHeader *>(dest + 0x10);
+            loadedHeader->xipBase = header.xipSize > 0 ? reinterpret_cast<uint32_t>(xip) : 0;
+        }
+        return reinterpret_cast<EntryPoint>(dest);
+    }
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include <stdint.h>
+
+// Receiving a .bin over the serial port straight into the RAM, so an app
+// can be tested without copying it to the flash (see tools/upload.py).
+//
+// Everything is sent in frames:
+//     u16 sequence number, u16 length (at most MAX_FRAME), data,
+//     u32 Adler-32 of all of that before it
+// big endian. The calculator answers every frame with ACK or NAK, and the
+// sender repeats a frame until it gets an ACK. Frame 0 is the header:
+//     "HHU1", load address, load size, .bss size, .xip size, flags
+// the others are the load size bytes of the image and then the .xip bytes
+// (they never share a frame). The .bss is cleared and the .xip data is put
+// after it; if flags has FLAG_BIN_HEADER the loaded header's xipBase (see
+// sdk/calc/xip.hpp) is set to it.
+namespace Upload {
+    const uint32_t MAGIC = 0x48485531; // "HHU1"
+    const int MAX_FRAME = 1024;
+    const uint32_t FLAG_BIN_HEADER = 1;
+    const unsigned char ACK = 0x06;
+    const unsigned char NAK = 0x15;
+
+    typedef void (*EntryPoint)();
+
+    // Waits for an upload (until Clear is pressed) and returns where to
+    // start it, or nullptr if it was cancelled or didn't fit.
+    EntryPoint Receive();
+};
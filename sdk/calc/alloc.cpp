@@ -0,0 +1,74 @@
+#include <sdk/calc/alloc.hpp>
+#include <sdk/os/mem.hpp>
+
+Arena *newArena = nullptr;
+static Arena *arenas = nullptr;
+
+void arenaInitBuffer(Arena &arena, void *buffer, uint32_t size){
+	arena.base = (uint8_t*)buffer;
+	arena.size = size;
+	arena.used = 0;
+	arena.allocation = nullptr;
+	arena.next = arenas;
+	arenas = &arena;
+}
+
+bool arenaInit(Arena &arena, uint32_t size){
+	void *buffer = malloc(size);
+	if (buffer == nullptr) return false;
+	arenaInitBuffer(arena, buffer, size);
+	arena.allocation = buffer;
+	return true;
+}
+
+void arenaFree(Arena &arena){
+	for (Arena **a = &arenas; *a != nullptr; a = &(*a)->next){
+		if (*a == &arena){
+			*a = arena.next;
+			break;
+		}
+	}
+	if (newArena == &arena) newArena = nullptr;
+	if (arena.allocation != nullptr) free(arena.allocation);
+	arena.allocation = nullptr;
+	arena.base = nullptr;
+	arena.size = arena.used = 0;
+}
+
+void *arenaAlloc(Arena &arena, uint32_t size, uint32_t align){
+	uintptr_t start = ((uintptr_t)arena.base + arena.used + align-1) & ~(uintptr_t)(align-1);
+	uint32_t offset = start - (uintptr_t)arena.base;
+	if (offset > arena.size || size > arena.size - offset) return nullptr;
+	arena.used = offset + size;
+	return (void*)start;
+}
+
+Arena *arenaFind(const void *p){
+	for (Arena *a = arenas; a != nullptr; a = a->next)
+		if (arenaContains(*a, p)) return a;
+	return nullptr;
+}
+
+bool poolInit(Pool &pool, uint32_t blockSize, uint32_t count){
+	blockSize = (blockSize + 3) & ~3;
+	if (blockSize < sizeof(void*)) blockSize = sizeof(void*);
+	pool.allocation = malloc(blockSize * count);
+	if (pool.allocation == nullptr) return false;
+	pool.memory = (uint8_t*)pool.allocation;
+	pool.blockSize = blockSize;
+	pool.count = count;
+
+	//chain all blocks into the free list, the first block first
+	pool.freeList = nullptr;
+	for (uint32_t i=count; i>0; i--)
+		poolRelease(pool, pool.memory + (i-1)*blockSize);
+	return true;
+}
+
+void poolFree(Pool &pool){
+	if (pool.allocation != nullptr) free(pool.allocation);
+	pool.allocation = nullptr;
+	pool.memory = nullptr;
+	pool.freeList = nullptr;
+	pool.count = 0;
+}
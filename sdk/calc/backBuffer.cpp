@@ -0,0 +1,81 @@
+#include <sdk/calc/backBuffer.hpp>
+#include <sdk/calc/calc.hpp>
+#include <sdk/calc/dma.hpp>
+#include <sdk/calc/lcdc.hpp>
+#include <sdk/os/lcd.hpp>
+#include <sdk/os/mem.hpp>
+
+static uint16_t *osVram;
+static void *allocation[2];	//what malloc returned (the buffers are aligned to 32 bytes)
+static uint16_t *buffers[2];
+static int numBuffers;
+static int current;		//the buffer vram points to
+
+//Allocates a buffer aligned to a cache line / 32 byte DMA transfer unit
+static uint16_t *allocBuffer(int i, uint32_t size){
+	allocation[i] = malloc(size + 31);
+	if (allocation[i] == nullptr) return nullptr;
+	return (uint16_t*)(((uint32_t)allocation[i] + 31) & ~31);
+}
+
+static void freeBuffers(){
+	for (int i=0; i<2; i++){
+		if (allocation[i] != nullptr) free(allocation[i]);
+		allocation[i] = nullptr;
+		buffers[i] = nullptr;
+	}
+	numBuffers = 0;
+}
+
+bool backBufferInit(bool twoBuffers){
+	osVram = LCD_GetVRAMAddress();
+	const uint32_t size = width * height * 2;
+
+	numBuffers = twoBuffers ? 2 : 1;
+	for (int i=0; i<numBuffers; i++){
+		buffers[i] = allocBuffer(i, size);
+		if (buffers[i] == nullptr){
+			freeBuffers();
+			return false;
+		}
+		memcpy(buffers[i], osVram, size);
+	}
+
+	current = 0;
+	vram = buffers[0];
+	return true;
+}
+
+void backBufferPresent(){
+	if (numBuffers == 0) return;
+	dmaCopy(osVram, buffers[current], width * height * 2);
+	if (numBuffers == 2){
+		//Draw the next frame into the other buffer while this one is being copied
+		current ^= 1;
+		vram = buffers[current];
+	}
+}
+
+void backBufferSend(){
+	if (numBuffers == 0) return;
+	lcdcPushRect(buffers[current], width, 0, 0, width, height, true);
+	if (numBuffers == 2){
+		current ^= 1;
+		vram = buffers[current];
+	}
+}
+
+void backBufferWait(){
+	dmaWait();
+}
+
+void backBufferRefresh(){
+	dmaWait();
+	LCD_Refresh();
+}
+
+void backBufferEnd(){
+	dmaWait();
+	freeBuffers();
+	vram = osVram;
+}
@@ -0,0 +1,156 @@
+#include <sdk/calc/bcd.hpp>
+#include <sdk/calc/div.hpp>
+#include <sdk/os/mem.hpp>
+
+static const uint32_t POWERS_OF_10[10] = {
+	1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+void obcdSetExponent(OBCD &bcd, int e, bool negative){
+	uint32_t biased = e + OBCD_EXPONENT_BIAS;
+	uint32_t hundreds = biased / 100;
+	bcd.exponent = (hundreds << 8) | bcdPackTable.v[biased - hundreds * 100];
+	if (negative) bcd.exponent |= OBCD_NEGATIVE;
+}
+
+uint32_t obcdDigits(const OBCD &bcd, int first, int count){
+	const uint8_t *m = bcd.mantissa + (first >> 1);
+	uint32_t value = 0;
+	//a digit in the low half of a byte first, then whole bytes, then maybe the high half of one more
+	if ((first & 1) && count > 0){
+		value = *m++ & 0xF;
+		count--;
+	}
+	for (; count >= 2; count -= 2)
+		value = value * 100 + bcdUnpackTable.v[*m++];
+	if (count)
+		value = value * 10 + (*m >> 4);
+	return value;
+}
+
+void obcdSetDigits(OBCD &bcd, const uint8_t *digits, int n, int e, bool negative){
+	int start = 0;
+	while (start < n && digits[start] == 0){
+		start++;
+		e--;
+	}
+	digits += start;
+	n -= start;
+	if (n > OBCD_DIGITS) n = OBCD_DIGITS;
+
+	memset(bcd.mantissa, 0, sizeof(bcd.mantissa));
+	if (n == 0){
+		obcdSetExponent(bcd, 0, false);
+		return;
+	}
+	int i = 0;
+	for (; i + 1 < n; i += 2)
+		bcd.mantissa[i >> 1] = (digits[i] << 4) | digits[i+1];
+	if (i < n)
+		bcd.mantissa[i >> 1] = digits[i] << 4;
+	obcdSetExponent(bcd, e, negative);
+}
+
+//Writes the count lowest digits of value to digits, two at a time
+static void putDigits(uint8_t *digits, uint32_t value, int count){
+	while (count >= 2){
+		uint32_t q = value / 100;
+		uint8_t pair = bcdPackTable.v[value - q * 100];
+		digits[--count] = pair & 0xF;
+		digits[--count] = pair >> 4;
+		value = q;
+	}
+	if (count)
+		digits[0] = value % 10;
+}
+
+//The number of digits of value (1 for 0)
+static int countDigits(uint32_t value){
+	int n = 1;
+	while (n < 10 && value >= POWERS_OF_10[n]) n++;
+	return n;
+}
+
+void int32ToOBCD(int32_t value, OBCD &bcd){
+	uint32_t u = value < 0 ? 0u - (uint32_t)value : value;
+	uint8_t digits[10];
+	int n = countDigits(u);
+	putDigits(digits, u, n);
+	obcdSetDigits(bcd, digits, n, n - 1, value < 0);
+}
+
+int32_t obcdToInt32(const OBCD &bcd){
+	int e = obcdExponent(bcd);
+	bool negative = obcdNegative(bcd);
+	uint32_t limit = negative ? 0x80000000u : 0x7FFFFFFFu;
+	if (e < 0) return 0;
+	if (e > 9) return negative ? (int32_t)0x80000000 : 0x7FFFFFFF;
+
+	uint32_t u;
+	if (e == 9){
+		//10 digits might not fit into 32 bits
+		uint32_t high = obcdDigits(bcd, 0, 1);
+		if (high > 4) u = limit;
+		else{
+			uint64_t v = (uint64_t)high * 1000000000u + obcdDigits(bcd, 1, 9);
+			u = v > limit ? limit : (uint32_t)v;
+		}
+	}else{
+		u = obcdDigits(bcd, 0, e + 1);
+	}
+	return negative ? (int32_t)(0u - u) : (int32_t)u;
+}
+
+//n / 10^9, returns the remainder (the quotient of the high word can be more than 32 bits)
+static uint32_t divmod1e9(uint64_t &n){
+	uint32_t hi = n >> 32, lo = (uint32_t)n;
+	uint32_t qHi = udiv32(hi, 1000000000);
+	uint32_t qLo = udiv64(hi - qHi * 1000000000, lo, 1000000000);
+	uint32_t remainder = lo - qLo * 1000000000;
+	n = ((uint64_t)qHi << 32) | qLo;
+	return remainder;
+}
+
+void int64ToOBCD(int64_t value, OBCD &bcd){
+	uint64_t u = value < 0 ? 0 - (uint64_t)value : value;
+	//at most 19 digits: up to 2, then 9 and 9
+	uint32_t low = divmod1e9(u);
+	uint32_t middle = divmod1e9(u);
+	uint32_t high = (uint32_t)u;
+
+	uint8_t digits[20];
+	int n = 0;
+	if (high){
+		n = countDigits(high);
+		putDigits(digits, high, n);
+		putDigits(digits + n, middle, 9);
+		n += 9;
+	}else if (middle){
+		n = countDigits(middle);
+		putDigits(digits, middle, n);
+	}
+	int lowDigits = n ? 9 : countDigits(low);
+	putDigits(digits + n, low, lowDigits);
+	n += lowDigits;
+	obcdSetDigits(bcd, digits, n, n - 1, value < 0);
+}
+
+int64_t obcdToInt64(const OBCD &bcd){
+	int e = obcdExponent(bcd);
+	bool negative = obcdNegative(bcd);
+	uint64_t limit = negative ? (uint64_t)1 << 63 : ((uint64_t)1 << 63) - 1;
+	if (e < 0) return 0;
+	if (e > 18) return negative ? (int64_t)(0 - limit) : (int64_t)limit;
+
+	//up to 9 digits at a time: v * 10^count + the next digits (v * 10^count always fits, there are at most 19)
+	int n = e + 1;
+	uint64_t v = 0;
+	for (int first = 0; first < n; first += 9){
+		int count = n - first < 9 ? n - first : 9;
+		uint32_t p = POWERS_OF_10[count];
+		uint64_t high = (uint64_t)(uint32_t)(v >> 32) * p;
+		v = (high << 32) + (uint64_t)(uint32_t)v * p + obcdDigits(bcd, first, count);
+	}
+	if (v > limit) v = limit;
+	return negative ? (int64_t)(0 - v) : (int64_t)v;
+}
@@ -0,0 +1,262 @@
+#include <sdk/calc/blend.hpp>
+#include <sdk/calc/calc.hpp>
+#include <sdk/calc/div.hpp>
+#include <sdk/os/mem.hpp>
+
+//A uint32_t that may alias the uint16_t pixels
+typedef uint32_t __attribute__((may_alias)) pixelPair_t;
+
+//The channels BLEND_SPLIT leaves out (red and blue of the first pixel, green of the second one), shifted down by 5
+//so they have the gaps above them too
+const uint32_t BLEND_GAPS = ~BLEND_SPLIT >> 5;
+
+static inline uint32_t blendPair(uint32_t dst, uint32_t src, uint32_t alpha){
+	uint32_t rest = BLEND_OPAQUE - alpha;
+	uint32_t a = ((src & BLEND_SPLIT) * alpha + (dst & BLEND_SPLIT) * rest) >> 5;
+	uint32_t b = (((src >> 5) & BLEND_GAPS) * alpha + ((dst >> 5) & BLEND_GAPS) * rest) >> 5;
+	return (a & BLEND_SPLIT) | (b & BLEND_GAPS) << 5;
+}
+
+//The sum of two halves, every channel that carried into its gap set to the maximum.
+//carry has the bits above the channels, carry >> 5 and carry >> 6 the lowest bit of a 5 and a 6 bit channel.
+static inline uint32_t saturate(uint32_t sum, uint32_t carryBits){
+	uint32_t carry = sum & carryBits;
+	return sum | (carry - (carry >> 5)) | (carry - (carry >> 6));
+}
+
+static inline uint32_t addPair(uint32_t dst, uint32_t src){
+	uint32_t a = saturate((dst & BLEND_SPLIT) + (src & BLEND_SPLIT), 0x08010020);
+	uint32_t b = saturate(((dst >> 5) & BLEND_GAPS) + ((src >> 5) & BLEND_GAPS), 0x08010040);
+	return (a & BLEND_SPLIT) | (b & BLEND_GAPS) << 5;
+}
+
+void blendSpan(uint16_t *dst, const uint16_t *src, int count, int alpha){
+	if (count<=0) return;
+	//pairs only if dst and src can be aligned to 32 bit together
+	if ((((uintptr_t)dst ^ (uintptr_t)src) & 2) == 0){
+		if ((uintptr_t)dst & 2){
+			*dst = blendColor(*dst, *src++, alpha);
+			dst++;
+			count--;
+		}
+		pixelPair_t *d = (pixelPair_t*)dst;
+		const pixelPair_t *s = (const pixelPair_t*)src;
+		for (; count >= 2; count -= 2, d++, s++)
+			*d = blendPair(*d, *s, alpha);
+		dst = (uint16_t*)d;
+		src = (const uint16_t*)s;
+	}
+	for (; count > 0; count--, dst++)
+		*dst = blendColor(*dst, *src++, alpha);
+}
+
+void blendFillSpan(uint16_t *dst, int count, uint16_t color, int alpha){
+	if (count<=0) return;
+	uint32_t rest = BLEND_OPAQUE - alpha;
+	//the color times alpha only once, for both halves of a pair
+	uint32_t pair = color | (uint32_t)color << 16;
+	uint32_t a = (pair & BLEND_SPLIT) * alpha;
+	uint32_t b = ((pair >> 5) & BLEND_GAPS) * alpha;
+
+	if ((uintptr_t)dst & 2){
+		*dst = blendPack((a + blendSpread(*dst) * rest) >> 5);
+		dst++;
+		count--;
+	}
+	pixelPair_t *p = (pixelPair_t*)dst;
+	for (; count >= 2; count -= 2, p++){
+		uint32_t d = *p;
+		*p = (((a + (d & BLEND_SPLIT) * rest) >> 5) & BLEND_SPLIT)
+			| ((((b + ((d >> 5) & BLEND_GAPS) * rest) >> 5) & BLEND_GAPS) << 5);
+	}
+	if (count)
+		*(uint16_t*)p = blendPack((a + blendSpread(*(uint16_t*)p) * rest) >> 5);
+}
+
+void addSpan(uint16_t *dst, const uint16_t *src, int count){
+	if (count<=0) return;
+	if ((((uintptr_t)dst ^ (uintptr_t)src) & 2) == 0){
+		if ((uintptr_t)dst & 2){
+			*dst = addColor(*dst, *src++);
+			dst++;
+			count--;
+		}
+		pixelPair_t *d = (pixelPair_t*)dst;
+		const pixelPair_t *s = (const pixelPair_t*)src;
+		for (; count >= 2; count -= 2, d++, s++)
+			*d = addPair(*d, *s);
+		dst = (uint16_t*)d;
+		src = (const uint16_t*)s;
+	}
+	for (; count > 0; count--, dst++)
+		*dst = addColor(*dst, *src++);
+}
+
+void blendMaskSpan(uint16_t *dst, uint16_t color, const uint8_t *alpha, int count){
+	//every pixel has its own alpha, so they can't share a multiplication: one pixel at a time, spread over 32 bits
+	uint32_t c = blendSpread(color);
+	for (; count > 0; count--, dst++){
+		uint32_t a = (*alpha++ + 4) >> 3;	//0..255 to 0..32
+		if (a == 0) continue;
+		*dst = blendPack((c * a + blendSpread(*dst) * (BLEND_OPAQUE - a)) >> 5);
+	}
+}
+
+namespace {
+
+//A color that changes linearly, every channel in 16.16 fixed point
+struct ColorStep {
+	int32_t r, g, b;
+	int32_t dr, dg, db;
+
+	//from c0 at step 0 to c1 at step steps
+	void init(uint16_t c0, uint16_t c1, int steps){
+		//+0.5, so the >>16 rounds
+		r = ((c0 >> 11) << 16) + 0x8000;
+		g = (((c0 >> 5) & 0x3F) << 16) + 0x8000;
+		b = ((c0 & 0x1F) << 16) + 0x8000;
+		if (steps <= 0){
+			dr = dg = db = 0;
+			return;
+		}
+		dr = sdiv32(((c1 >> 11) - (c0 >> 11)) * 65536, steps);
+		dg = sdiv32((((c1 >> 5) & 0x3F) - ((c0 >> 5) & 0x3F)) * 65536, steps);
+		db = sdiv32(((c1 & 0x1F) - (c0 & 0x1F)) * 65536, steps);
+	}
+	void skip(int steps){
+		r += dr * steps;
+		g += dg * steps;
+		b += db * steps;
+	}
+	uint16_t next(){
+		uint16_t c = ((r >> 16) << 11) | ((g >> 16) << 5) | (b >> 16);
+		r += dr;
+		g += dg;
+		b += db;
+		return c;
+	}
+};
+
+}
+
+void gradientSpan(uint16_t *dst, int count, uint16_t c0, uint16_t c1){
+	ColorStep c;
+	c.init(c0, c1, count-1);
+	for (; count > 0; count--)
+		*dst++ = c.next();
+}
+
+//4x4 Bayer matrix: thresholds 0..15 spread evenly over every 2x2 and 4x4 block
+static constexpr uint8_t bayer[16] = {
+	 0,  8,  2, 10,
+	12,  4, 14,  6,
+	 3, 11,  1,  9,
+	15,  7, 13,  5,
+};
+
+//Red and blue lose 3 bits, green 2: the threshold is scaled to 0..7 and 0..3
+static inline uint16_t dither(int r, int g, int b, int t){
+	r += t >> 1;
+	g += t >> 2;
+	b += t >> 1;
+	if (r > 255) r = 255;
+	if (g > 255) g = 255;
+	if (b > 255) b = 255;
+	return ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+}
+
+uint16_t ditherColor(uint8_t r, uint8_t g, uint8_t b, int x, int y){
+	return dither(r, g, b, bayer[((y & 3) << 2) | (x & 3)]);
+}
+
+void ditherSpan(uint16_t *dst, const uint8_t *rgb, int count, int x, int y){
+	const uint8_t *row = bayer + ((y & 3) << 2);
+	for (; count > 0; count--, x++, rgb += 3)
+		*dst++ = dither(rgb[0], rgb[1], rgb[2], row[x & 3]);
+}
+
+//Clips the rectangle to the screen and marks it dirty. i0 and j0 get the first visible column and row of it.
+//Returns false if none of it is on the screen.
+static bool clipRect(int &x, int &y, int &w, int &h, int &i0, int &j0){
+	i0 = x<0 ? -x : 0;
+	j0 = y<0 ? -y : 0;
+	x += i0; w -= i0;
+	y += j0; h -= j0;
+	if (x+w>width)  w=width-x;
+	if (y+h>height) h=height-y;
+	if (w<=0 || h<=0) return false;
+	markDirty(x, y, x+w-1, y+h-1);
+	return true;
+}
+
+void blendRect(int x, int y, int w, int h, uint16_t color, int alpha){
+	int i0, j0;
+	if (!clipRect(x, y, w, h, i0, j0)) return;
+	uint16_t *row = vram + width*y + x;
+	for (; h > 0; h--, row += width)
+		blendFillSpan(row, w, color, alpha);
+}
+
+void blendMask(int x, int y, int w, int h, uint16_t color, const uint8_t *alpha){
+	int stride = w;
+	int i0, j0;
+	if (!clipRect(x, y, w, h, i0, j0)) return;
+	alpha += stride*j0 + i0;
+	uint16_t *row = vram + width*y + x;
+	for (; h > 0; h--, row += width, alpha += stride)
+		blendMaskSpan(row, color, alpha, w);
+}
+
+void blendBitmap(const Bitmap &bitmap, int x, int y, int alpha){
+	int w = bitmap.width, h = bitmap.height;
+	int i0, j0;
+	if (!clipRect(x, y, w, h, i0, j0)) return;
+	const uint16_t *src = bitmap.pixels + bitmap.width*j0 + i0;
+	uint16_t *row = vram + width*y + x;
+	for (; h > 0; h--, row += width, src += bitmap.width)
+		blendSpan(row, src, w, alpha);
+}
+
+void addBitmap(const Bitmap &bitmap, int x, int y){
+	int w = bitmap.width, h = bitmap.height;
+	int i0, j0;
+	if (!clipRect(x, y, w, h, i0, j0)) return;
+	const uint16_t *src = bitmap.pixels + bitmap.width*j0 + i0;
+	uint16_t *row = vram + width*y + x;
+	for (; h > 0; h--, row += width, src += bitmap.width)
+		addSpan(row, src, w);
+}
+
+void gradientRect(int x, int y, int w, int h, uint16_t c0, uint16_t c1, GradientDirection direction){
+	int fullW = w, fullH = h;
+	int i0, j0;
+	if (!clipRect(x, y, w, h, i0, j0)) return;
+	uint16_t *row = vram + width*y + x;
+
+	ColorStep c;
+	if (direction == GRADIENT_VERTICAL){
+		//one color per row
+		c.init(c0, c1, fullH-1);
+		c.skip(j0);
+		for (; h > 0; h--, row += width)
+			fillSpan(row, w, c.next());
+		return;
+	}
+	//the first row, then copies of it
+	c.init(c0, c1, fullW-1);
+	c.skip(i0);
+	for (int i=0; i<w; i++)
+		row[i] = c.next();
+	for (uint16_t *copy = row + width; h > 1; h--, copy += width)
+		memcpy(copy, row, w * sizeof(uint16_t));
+}
+
+void ditherImage(int x, int y, int w, int h, const uint8_t *rgb){
+	int stride = w;
+	int i0, j0;
+	if (!clipRect(x, y, w, h, i0, j0)) return;
+	rgb += 3 * (stride*j0 + i0);
+	uint16_t *row = vram + width*y + x;
+	for (int j=0; j<h; j++, row += width, rgb += 3*stride)
+		ditherSpan(row, rgb, w, x, y+j);
+}
@@ -0,0 +1,45 @@
+#include <sdk/calc/blit.hpp>
+#include <sdk/calc/onchip.hpp>
+
+HOT_CODE void blitRle(const RleSprite &sprite, int x, int y){
+	if (x >= width || y >= height || x+sprite.width <= 0 || y+sprite.height <= 0) return;
+
+	int j0 = y<0 ? -y : 0;
+	int j1 = y+sprite.height>height ? height-y : sprite.height;
+	int minX = x<0 ? 0 : x;
+	int maxX = x+sprite.width>width ? width-1 : x+sprite.width-1;
+	markDirty(minX, y+j0, maxX, y+j1-1);
+
+	const uint16_t *data = sprite.data;
+	//the rows above the screen only have to be skipped
+	for (int j=0; j<j0; j++){
+		int runs = *data++;
+		while (runs--){
+			data++;
+			data += *data + 1;
+		}
+	}
+
+	uint16_t *row = vram + width*(y+j0);
+	for (int j=j0; j<j1; j++){
+		int runs = *data++;
+		int px = x;
+		while (runs--){
+			px += data[0];
+			int count = data[1];
+			const uint16_t *s = data + 2;
+			data = s + count;
+
+			//clip the run
+			int start = px, end = px+count;
+			px = end;
+			if (start < 0) { s -= start; start = 0; }
+			if (end > width) end = width;
+
+			uint16_t *d = row + start;
+			for (int i=end-start; i>0; i--)
+				*d++ = *s++;
+		}
+		row += width;
+	}
+}
@@ -0,0 +1,55 @@
+#include <sdk/calc/breakpoint.hpp>
+#include <sdk/cpu/ubc.hpp>
+
+BreakpointCallback breakpointCallback = nullptr;
+
+static uint32_t savedDBR, savedCBCR;
+static bool installed = false;
+
+void breakpointInstall(BreakpointCallback callback){
+	breakpointCallback = callback;
+	if (installed) return;
+#ifdef __sh__
+	__asm__ volatile("stc dbr, %0" : "=r"(savedDBR));
+	__asm__ volatile("ldc %0, dbr" : : "r"(&breakpointHandler));
+#endif
+	savedCBCR = UBC_REG_CBCR;
+	UBC_REG_CBCR = 1 << UBC_CBCR_UBDE;
+	installed = true;
+}
+
+void breakpointUninstall(){
+	if (!installed) return;
+	breakpointClear(0);
+	breakpointClear(1);
+	UBC_REG_CCMFR = 0;
+	UBC_REG_CBCR = savedCBCR;
+#ifdef __sh__
+	__asm__ volatile("ldc %0, dbr" : : "r"(savedDBR));
+#endif
+	installed = false;
+}
+
+void breakpointSet(int channel, uint32_t address, uint32_t mask){
+	//break on an instruction fetch, after the instruction was executed (so continuing doesn't break again)
+	uint32_t crr = (1 << UBC_CRR_RESERVED) | (1 << UBC_CRR_PCB) | (1 << UBC_CRR_BIE);
+	uint32_t cbr = (1 << UBC_CBR_ID) | (1 << UBC_CBR_CE);
+	if (channel == 0){
+		UBC_REG_CBR0 = 0;
+		UBC_REG_CAR0 = address;
+		UBC_REG_CAMR0 = mask;
+		UBC_REG_CRR0 = crr;
+		UBC_REG_CBR0 = cbr;
+	} else {
+		UBC_REG_CBR1 = 0;
+		UBC_REG_CAR1 = address;
+		UBC_REG_CAMR1 = mask;
+		UBC_REG_CRR1 = crr;
+		UBC_REG_CBR1 = cbr;
+	}
+}
+
+void breakpointClear(int channel){
+	if (channel == 0) UBC_REG_CBR0 = 0;
+	else UBC_REG_CBR1 = 0;
+}
@@ -0,0 +1,51 @@
+!The debug exception handler of sdk/calc/breakpoint.hpp, DBR points here while breakpoints are installed.
+!It calls breakpointCallback(pc, pr, channels) and continues the program.
+!It's in the IL RAM so its own instructions don't match breakpoints on the app's code.
+!SPC has the address where the program continues, SSR its SR and SGR its r15 (rte restores them).
+
+.section .ilram, "ax"
+.align 2
+.global _breakpointHandler
+.type _breakpointHandler, @function
+
+_breakpointHandler:
+	sts.l pr, @-r15
+	mov.l r0, @-r15
+	mov.l r1, @-r15
+	mov.l r2, @-r15
+	mov.l r3, @-r15
+	mov.l r4, @-r15
+	mov.l r5, @-r15
+	mov.l r6, @-r15
+	mov.l r7, @-r15
+	sts.l mach, @-r15   !the C code may use the multiplier
+	sts.l macl, @-r15
+
+	mov.l BreakpointHandler_ccmfr, r6
+	mov.l @r6, r6       !the channels that matched
+	sts pr, r5          !pr of the program (not changed yet)
+	stc spc, r4         !the interrupted address
+	mov.l BreakpointHandler_callback, r0
+	mov.l @r0, r0
+	jsr @r0
+	nop
+
+	lds.l @r15+, macl
+	lds.l @r15+, mach
+	mov.l @r15+, r7
+	mov.l @r15+, r6
+	mov.l @r15+, r5
+	mov.l @r15+, r4
+	mov.l @r15+, r3
+	mov.l @r15+, r2
+	mov.l @r15+, r1
+	mov.l @r15+, r0
+	lds.l @r15+, pr
+	rte
+	nop
+
+.align 2
+BreakpointHandler_callback:
+	.long _breakpointCallback
+BreakpointHandler_ccmfr:
+	.long 0xFF200600
@@ -0,0 +1,102 @@
+#include <sdk/calc/canvas.hpp>
+#include <sdk/calc/calc.hpp>
+#include <sdk/os/mem.hpp>
+
+bool canvasInit(IndexedCanvas &canvas, int w, int h){
+	canvas.pixels = (uint8_t*)malloc(w * h);
+	if (canvas.pixels == nullptr) return false;
+	canvas.width = w;
+	canvas.height = h;
+	memset(canvas.pixels, 0, w * h);
+	memset(canvas.palette, 0, sizeof(canvas.palette));
+	canvasMarkAll(canvas);
+	return true;
+}
+
+void canvasFree(IndexedCanvas &canvas){
+	if (canvas.pixels != nullptr) free(canvas.pixels);
+	canvas.pixels = nullptr;
+	canvas.width = canvas.height = 0;
+}
+
+void canvasFillRect(IndexedCanvas &canvas, int x, int y, int w, int h, uint8_t index){
+	if (x<0) { w+=x; x=0; }
+	if (y<0) { h+=y; y=0; }
+	if (x+w>canvas.width)  w=canvas.width-x;
+	if (y+h>canvas.height) h=canvas.height-y;
+	if (w<=0 || h<=0) return;
+	canvasMarkRows(canvas, y, y+h-1);
+
+	uint8_t *row = canvas.pixels + canvas.width*y + x;
+	for (int j=0; j<h; j++){
+		memset(row, index, w);
+		row += canvas.width;
+	}
+}
+
+void canvasClear(IndexedCanvas &canvas, uint8_t index){
+	memset(canvas.pixels, index, canvas.width * canvas.height);
+	canvasMarkAll(canvas);
+}
+
+//A uint32_t that may alias the uint16_t pixels of the vram
+typedef uint32_t __attribute__((may_alias)) pixelPair_t;
+
+//Two pixels in one 32 bit word, first is the one at the lower address
+static inline uint32_t pixelPair(uint16_t first, uint16_t second){
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	return ((uint32_t)first << 16) | second;
+#else
+	return ((uint32_t)second << 16) | first;
+#endif
+}
+
+void expandIndexed(uint16_t *dst, const uint8_t *src, int count, const uint16_t *palette){
+	if (count<=0) return;
+
+	//align dst to 32 bit, then write two pixels per store
+	if ((uintptr_t)dst & 2){
+		*dst++ = palette[*src++];
+		count--;
+	}
+	pixelPair_t *p = (pixelPair_t*)dst;
+	while (count >= 8){
+		p[0] = pixelPair(palette[src[0]], palette[src[1]]);
+		p[1] = pixelPair(palette[src[2]], palette[src[3]]);
+		p[2] = pixelPair(palette[src[4]], palette[src[5]]);
+		p[3] = pixelPair(palette[src[6]], palette[src[7]]);
+		p += 4;
+		src += 8;
+		count -= 8;
+	}
+	while (count >= 2){
+		*p++ = pixelPair(palette[src[0]], palette[src[1]]);
+		src += 2;
+		count -= 2;
+	}
+	if (count)
+		*(uint16_t*)p = palette[*src];
+}
+
+void canvasPresent(IndexedCanvas &canvas, int x, int y){
+	int y0 = canvas.dirtyY0, y1 = canvas.dirtyY1;
+	canvas.dirtyY0 = 0x7FFFFFFF;
+	canvas.dirtyY1 = -1;
+	if (y1 < y0) return;
+
+	//clip: the part of the canvas that is on the screen
+	int x0 = x<0 ? -x : 0;
+	int x1 = x+canvas.width>width ? width-x : canvas.width; //exclusive
+	if (y+y0 < 0) y0 = -y;
+	if (y+y1 >= height) y1 = height-1-y;
+	if (x0>=x1 || y0>y1) return;
+	markDirty(x+x0, y+y0, x+x1-1, y+y1);
+
+	const uint8_t *src = canvas.pixels + canvas.width*y0 + x0;
+	uint16_t *dst = vram + width*(y+y0) + x+x0;
+	for (int j=y0; j<=y1; j++){
+		expandIndexed(dst, src, x1-x0, canvas.palette);
+		src += canvas.width;
+		dst += width;
+	}
+}
@@ -0,0 +1,73 @@
+#include <sdk/calc/dma.hpp>
+#include <sdk/cpu/cache.hpp>
+#include <sdk/cpu/dmac.hpp>
+
+//The DMAC works with physical addresses and doesn't see the operand cache.
+static inline uint32_t physical(const void *p){
+	return (uint32_t)p & 0x1FFFFFFF;
+}
+
+//Transfers count units of size ts (the TS field of CHCR) from sar to dar, incrementing sar (and dar with
+//DMAC_ADDR_INCREMENT as dm)
+static void start(uint32_t dar, uint32_t sar, uint32_t count, uint32_t ts, uint32_t dm){
+	//Make sure the DMAC is powered
+	DMAC_REG_MSTPCR0 &= ~(1 << DMAC_MSTPCR0_DMAC0);
+
+	struct DMAC_Channel *ch = DMAC_GetChannel(DMA_CHANNEL);
+	ch->CHCR = 0; //disable the channel (and clear TE) while we set it up
+	ch->SAR = sar;
+	ch->DAR = dar;
+	ch->TCR = count;
+	ch->CHCR =
+		(dm << DMAC_CHCR_DM) |
+		(DMAC_ADDR_INCREMENT << DMAC_CHCR_SM) |
+		(DMAC_RS_AUTO << DMAC_CHCR_RS) |
+		((ts & 3) << DMAC_CHCR_TS_0) |
+		((ts >> 2) << DMAC_CHCR_TS_1);
+
+	//Enable the DMAC (clearing any address error or NMI flag) and start the transfer
+	DMAC_REG_DMAOR = (DMAC_REG_DMAOR & ~((1 << DMAC_DMAOR_AE) | (1 << DMAC_DMAOR_NMIF))) | (1 << DMAC_DMAOR_DME);
+	ch->CHCR |= 1 << DMAC_CHCR_DE;
+}
+
+void dmaCopy(void *dst, const void *src, uint32_t size){
+	if (size == 0) return;
+	dmaWait();
+
+	//Use the biggest transfer unit that fits the alignment of src, dst and size
+	uint32_t align = (uint32_t)dst | (uint32_t)src | size;
+	uint32_t ts, shift;
+	if      (!(align & 31)) { ts = 4; shift = 5; } //32 bytes
+	else if (!(align & 15)) { ts = 3; shift = 4; } //16 bytes
+	else if (!(align & 3))  { ts = 2; shift = 2; } //4 bytes
+	else if (!(align & 1))  { ts = 1; shift = 1; } //2 bytes
+	else                    { ts = 0; shift = 0; } //1 byte
+
+	//the DMAC has to read the current source, and the CPU must not read old lines of the destination from the
+	//cache afterwards (or write old dirty lines over the new data)
+	CACHE_Writeback(src, size);
+	CACHE_Purge(dst, size);
+	start(physical(dst), physical(src), size >> shift, ts, DMAC_ADDR_INCREMENT);
+}
+
+void dmaWritePort16(volatile uint16_t *port, const uint16_t *src, uint32_t count){
+	if (count == 0) return;
+	dmaWait();
+
+	//the port is a device register, it isn't cached
+	CACHE_Writeback(src, count * 2);
+	start(physical((const void*)port), physical(src), count, 1, DMAC_ADDR_FIXED);
+}
+
+bool dmaBusy(){
+	struct DMAC_Channel *ch = DMAC_GetChannel(DMA_CHANNEL);
+	uint32_t chcr = ch->CHCR;
+	//running: enabled and the transfer end flag not set yet. Stop waiting after an address error.
+	return (chcr & (1 << DMAC_CHCR_DE)) && !(chcr & (1 << DMAC_CHCR_TE)) && !(DMAC_REG_DMAOR & (1 << DMAC_DMAOR_AE));
+}
+
+void dmaWait(){
+	while (dmaBusy());
+	//disable the channel again
+	DMAC_GetChannel(DMA_CHANNEL)->CHCR &= ~((1 << DMAC_CHCR_DE) | (1 << DMAC_CHCR_TE));
+}
@@ -0,0 +1,142 @@
+#include <sdk/calc/fiber.hpp>
+#include <sdk/calc/timer.hpp>
+#include <sdk/os/mem.hpp>
+
+//in fiber.s
+extern "C" void fiberSwitch(FiberContext *from, FiberContext *to);
+extern "C" void fiberStart();
+
+//What fiberCreate() fills the stack with, for fiberStackUnused()
+const uint8_t FIBER_STACK_FILL = 0xA5;
+
+static Fiber mainFiber;		//main()'s own stack, the context is saved here while the others run
+static Fiber *current;		//nullptr until the first switch: main() is running
+static Fiber *readyHead, *readyTail;
+static Fiber *sleeping;		//sorted by wakeTime, the next one to wake first
+
+Fiber *fiberCurrent(){
+	return current != nullptr ? current : &mainFiber;
+}
+
+static void pushReady(Fiber *fiber){
+	fiber->state = FIBER_READY;
+	fiber->next = nullptr;
+	if (readyTail != nullptr) readyTail->next = fiber;
+	else readyHead = fiber;
+	readyTail = fiber;
+}
+
+static Fiber *popReady(){
+	Fiber *fiber = readyHead;
+	if (fiber != nullptr){
+		readyHead = fiber->next;
+		if (readyHead == nullptr) readyTail = nullptr;
+	}
+	return fiber;
+}
+
+static void wakeSleepers(){
+	uint32_t now = timerMicros();
+	while (sleeping != nullptr && (int32_t)(now - sleeping->wakeTime) >= 0){
+		Fiber *fiber = sleeping;
+		sleeping = fiber->next;
+		pushReady(fiber);
+	}
+}
+
+//Switches to the next fiber that can run. The current one has to be in a queue or done already.
+static void schedule(){
+	Fiber *self = fiberCurrent();
+	for (;;){
+		if (sleeping != nullptr) wakeSleepers();
+		Fiber *next = popReady();
+		if (next != nullptr){
+			if (next != self){
+				current = next;
+				fiberSwitch(&self->context, &next->context);
+			}
+			return;
+		}
+		//nobody is ready: wait for the first sleeper
+		if (sleeping != nullptr) sleepUntil(sleeping->wakeTime);
+	}
+}
+
+//Runs a new fiber, called by fiberStart in fiber.s
+static void fiberMain(Fiber *fiber){
+	fiber->function(fiber->arg);
+	fiber->state = FIBER_DONE;
+	fiberEventSet(fiber->done);
+	schedule(); //never comes back, nothing switches to a fiber that's done
+}
+
+void fiberCreate(Fiber &fiber, void (*function)(void *arg), void *arg, void *stack, int stackSize){
+	fiber.function = function;
+	fiber.arg = arg;
+	fiber.stack = (uint8_t*)stack;
+	fiber.stackSize = stackSize;
+	fiberEventInit(fiber.done);
+	memset(stack, FIBER_STACK_FILL, stackSize);
+
+	//the first switch to it "returns" to fiberStart with the stack pointer at the (8 byte aligned) top of the stack
+	memset(&fiber.context, 0, sizeof(fiber.context));
+	fiber.context.r[0] = (uintptr_t)&fiber;
+	fiber.context.r[1] = (uintptr_t)&fiberMain;
+	fiber.context.r[7] = ((uintptr_t)stack + stackSize) & ~7;
+	fiber.context.pr = (uintptr_t)&fiberStart;
+	pushReady(&fiber);
+}
+
+void fiberYield(){
+	if (readyHead == nullptr && sleeping == nullptr) return; //nobody else
+	pushReady(fiberCurrent());
+	schedule();
+}
+
+void fiberSleepUntil(uint32_t time){
+	Fiber *self = fiberCurrent();
+	self->state = FIBER_SLEEPING;
+	self->wakeTime = time;
+	//behind the ones that wake up earlier or at the same time
+	Fiber **link = &sleeping;
+	while (*link != nullptr && (int32_t)(time - (*link)->wakeTime) >= 0)
+		link = &(*link)->next;
+	self->next = *link;
+	*link = self;
+	schedule();
+}
+
+void fiberSleep(uint32_t us){
+	fiberSleepUntil(timerMicros() + us);
+}
+
+void fiberEventSet(FiberEvent &event){
+	event.set = true;
+	Fiber *fiber = event.waiting;
+	event.waiting = nullptr;
+	while (fiber != nullptr){
+		Fiber *next = fiber->next;
+		pushReady(fiber);
+		fiber = next;
+	}
+}
+
+void fiberWait(FiberEvent &event){
+	if (event.set) return;
+	Fiber *self = fiberCurrent();
+	self->state = FIBER_WAITING;
+	//at the end of the list, so they run in the order they started waiting
+	Fiber **link = &event.waiting;
+	while (*link != nullptr)
+		link = &(*link)->next;
+	self->next = nullptr;
+	*link = self;
+	schedule();
+}
+
+int fiberStackUnused(const Fiber &fiber){
+	int unused = 0;
+	while (unused < fiber.stackSize && fiber.stack[unused] == FIBER_STACK_FILL)
+		unused++;
+	return unused;
+}
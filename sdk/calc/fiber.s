@@ -0,0 +1,45 @@
+.align 2
+.global _fiberSwitch
+.type _fiberSwitch, @function
+
+!Saves the registers a function has to keep into the FiberContext r4 points to and loads the ones of the
+!FiberContext r5 points to. rts then returns to where that fiber called fiberSwitch (or to fiberStart).
+!The layout is r8..r15, mach, macl, pr (see fiber.hpp).
+_fiberSwitch:
+	add #44, r4     !the end of the context, the stores go down from there
+	sts.l pr, @-r4
+	sts.l macl, @-r4
+	sts.l mach, @-r4
+	mov.l r15, @-r4
+	mov.l r14, @-r4
+	mov.l r13, @-r4
+	mov.l r12, @-r4
+	mov.l r11, @-r4
+	mov.l r10, @-r4
+	mov.l r9, @-r4
+	mov.l r8, @-r4
+
+	mov.l @r5+, r8
+	mov.l @r5+, r9
+	mov.l @r5+, r10
+	mov.l @r5+, r11
+	mov.l @r5+, r12
+	mov.l @r5+, r13
+	mov.l @r5+, r14
+	mov.l @r5+, r15 !the stack of the other fiber
+	lds.l @r5+, mach
+	lds.l @r5+, macl
+	lds.l @r5+, pr
+	rts
+	nop
+
+
+.align 2
+.global _fiberStart
+.type _fiberStart, @function
+
+!The first fiberSwitch to a new fiber returns here: fiberCreate put the Fiber into r8 and the function that runs
+!it into r9. That function never returns.
+_fiberStart:
+	jsr @r9
+	mov r8, r4      !the Fiber is the argument
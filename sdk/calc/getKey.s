@@ -32,3 +32,28 @@ GetKey_keyAddr:
 GetKey_and:
 	.long 0x0000FFFF
 
+
+.align 2
+.global _getKeyMatrix
+.type _getKeyMatrix, @function
+
+!Reads all 6 words of the key matrix into the uint16_t array r4 points to
+_getKeyMatrix:
+	mov.l GetKeyMatrix_keyAddr, r2 !Load the keyboard addr
+	mov.w @r2+, r0  !1st word
+	mov.w r0, @r4
+	mov.w @r2+, r0  !2nd word
+	mov.w r0, @(2,r4)
+	mov.w @r2+, r0  !3rd word
+	mov.w r0, @(4,r4)
+	mov.w @r2+, r0  !4th word
+	mov.w r0, @(6,r4)
+	mov.w @r2+, r0  !5th word
+	mov.w r0, @(8,r4)
+	mov.w @r2, r0   !6th word
+	rts
+	mov.w r0, @(10,r4)
+
+.align 2
+GetKeyMatrix_keyAddr:
+	.long 0xa44B0000
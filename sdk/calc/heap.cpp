@@ -0,0 +1,159 @@
+#ifdef HEAP_DEBUG
+#include <sdk/calc/heap.hpp>
+#include <sdk/calc/div.hpp>
+#include <sdk/os/file.hpp>
+#include <sdk/os/mem.hpp>
+#include <sdk/os/serial.hpp>
+
+//Every allocation starts with this header, the app gets the memory after it.
+//The header is 8 bytes so the memory stays aligned like malloc()'s.
+struct BlockHeader {
+	uint32_t size;
+	uint16_t site;	//index in sites, NO_SITE if the table was full
+	uint16_t magic;	//BLOCK_MAGIC while the block is allocated, so bad frees can be found
+};
+static_assert(sizeof(BlockHeader) == 8);
+
+static const uint16_t BLOCK_MAGIC = 0x4EA9;
+static const uint16_t BLOCK_FREED = 0xDEAD;
+static const uint16_t NO_SITE = 0xFFFF;
+
+static HeapStats stats;
+static HeapSite sites[HEAP_MAX_SITES];
+static int siteCount;
+
+static uint16_t findSite(void *caller){
+	for (int i=0; i<siteCount; i++)
+		if (sites[i].caller == caller) return i;
+	if (siteCount == HEAP_MAX_SITES) return NO_SITE;
+	sites[siteCount].caller = caller;
+	return siteCount++;
+}
+
+void *heapAlloc(uint32_t size, void *caller){
+	BlockHeader *block = (BlockHeader*)OS_malloc(size + sizeof(BlockHeader));
+	block->size = size;
+	block->site = findSite(caller);
+	block->magic = BLOCK_MAGIC;
+
+	stats.allocs++;
+	stats.liveCount++;
+	stats.liveBytes += size;
+	if (stats.liveBytes > stats.peakBytes) stats.peakBytes = stats.liveBytes;
+	if (block->site != NO_SITE){
+		sites[block->site].allocs++;
+		sites[block->site].liveBytes += size;
+	}
+	return block + 1;
+}
+
+extern "C" __attribute__((noinline)) void *heapMalloc(uint32_t size){
+	return heapAlloc(size, __builtin_return_address(0));
+}
+
+extern "C" void heapFree(void *ptr){
+	if (ptr == nullptr) return;
+	BlockHeader *block = (BlockHeader*)ptr - 1;
+	if (block->magic != BLOCK_MAGIC){
+		//not ours (or freed twice): don't touch the OS heap with it
+		stats.badFrees++;
+		return;
+	}
+	block->magic = BLOCK_FREED;
+
+	stats.frees++;
+	stats.liveCount--;
+	stats.liveBytes -= block->size;
+	if (block->site != NO_SITE){
+		sites[block->site].frees++;
+		sites[block->site].liveBytes -= block->size;
+	}
+	OS_free(block);
+}
+
+const HeapStats &heapStats(){
+	return stats;
+}
+
+int heapSites(const HeapSite **list){
+	*list = sites;
+	return siteCount;
+}
+
+//The report is written line by line through a callback
+typedef void (*ReportWriter)(const char *text, int length, int fd);
+
+struct ReportLine {
+	char text[96];
+	int length;
+};
+
+static void put(ReportLine &line, const char *s){
+	while (*s && line.length < (int)sizeof(line.text)) line.text[line.length++] = *s++;
+}
+
+static void putDecimal(ReportLine &line, uint32_t n){
+	char digits[10];
+	int count = 0;
+	do {
+		digits[count++] = '0' + umod32(n, 10);
+		n = udiv32(n, 10);
+	} while (n);
+	while (count && line.length < (int)sizeof(line.text)) line.text[line.length++] = digits[--count];
+}
+
+static void putHex(ReportLine &line, uint32_t n){
+	put(line, "0x");
+	for (int shift=28; shift>=0 && line.length < (int)sizeof(line.text); shift-=4)
+		line.text[line.length++] = "0123456789ABCDEF"[(n >> shift) & 0xF];
+}
+
+static void report(ReportWriter write, int fd){
+	ReportLine line;
+	line.length = 0;
+	put(line, "heap: "); putDecimal(line, stats.liveCount);
+	put(line, " live allocations, "); putDecimal(line, stats.liveBytes);
+	put(line, " bytes, peak "); putDecimal(line, stats.peakBytes);
+	put(line, " bytes\nheap: "); putDecimal(line, stats.allocs);
+	put(line, " allocs, "); putDecimal(line, stats.frees);
+	put(line, " frees, "); putDecimal(line, stats.badFrees);
+	put(line, " bad frees\n");
+	write(line.text, line.length, fd);
+
+	for (int i=0; i<siteCount; i++){
+		const HeapSite &site = sites[i];
+		line.length = 0;
+		put(line, "site "); putHex(line, (uintptr_t)site.caller);
+		put(line, ": "); putDecimal(line, site.allocs);
+		put(line, " allocs, "); putDecimal(line, site.frees);
+		put(line, " frees, "); putDecimal(line, site.liveBytes);
+		put(line, site.allocs != site.frees ? " bytes live (leak?)\n" : " bytes live\n");
+		write(line.text, line.length, fd);
+	}
+}
+
+static void writeSerial(const char *text, int length, int fd [[maybe_unused]]){
+	//2 means the transmit buffer is full, wait until there's space
+	while (Serial_Write((const unsigned char*)text, length) == 2);
+}
+
+static void writeFile(const char *text, int length, int fd){
+	write(fd, text, length);
+}
+
+void heapReportSerial(){
+	if (!Serial_IsOpen()){
+		unsigned char mode[6] = {0, 9, 0, 0, 0, 0}; //115200 baud, 8N1
+		Serial_Open(mode);
+	}
+	report(writeSerial, 0);
+}
+
+bool heapReportFile(const char *path){
+	int fd = open(path, OPEN_WRITE | OPEN_CREATE);
+	if (fd < 0) return false;
+	report(writeFile, fd);
+	return close(fd) >= 0;
+}
+
+#endif
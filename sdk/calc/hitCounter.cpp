@@ -0,0 +1,49 @@
+#include <sdk/calc/hitCounter.hpp>
+#include <sdk/calc/breakpoint.hpp>
+#include <sdk/calc/onchip.hpp>
+#include <sdk/calc/timer.hpp>
+#include <sdk/cpu/ubc.hpp>
+#include <sdk/os/mem.hpp>
+
+HitCounter hitCounter;
+
+//The breakpoint callback
+HOT_CODE static void hitCounterHit(uint32_t pc [[maybe_unused]], uint32_t pr, uint32_t channels){
+	uint32_t now = timerTicks();
+	UBC_REG_CCMFR = 0;
+
+	if (channels & 1){
+		hitCounter.hits[0]++;
+		hitCounter.startTicks = now;
+		hitCounter.waiting = true;
+		//the first instruction of the function just ran, pr still is its return address
+		if (hitCounter.untilReturn) breakpointSet(1, pr, 0);
+	}
+	if (channels & 2){
+		hitCounter.hits[1]++;
+		if (hitCounter.waiting){
+			uint32_t latency = now - hitCounter.startTicks;
+			if (hitCounter.latencyCount == 0 || latency < hitCounter.latencyMin) hitCounter.latencyMin = latency;
+			if (latency > hitCounter.latencyMax) hitCounter.latencyMax = latency;
+			hitCounter.latencyTotal += latency;
+			hitCounter.latencyCount++;
+			hitCounter.waiting = false;
+		}
+		if (hitCounter.untilReturn) breakpointClear(1);
+	}
+}
+
+void hitCounterStart(uint32_t first, uint32_t second){
+	memset(&hitCounter, 0, sizeof(hitCounter));
+	hitCounter.address[0] = first;
+	hitCounter.address[1] = second;
+	hitCounter.untilReturn = second == HIT_COUNTER_RETURN;
+
+	breakpointInstall(hitCounterHit);
+	breakpointSet(0, first, 0);
+	if (second != HIT_COUNTER_NONE && second != HIT_COUNTER_RETURN) breakpointSet(1, second, 0);
+}
+
+void hitCounterStop(){
+	breakpointUninstall();
+}
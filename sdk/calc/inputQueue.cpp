@@ -0,0 +1,53 @@
+#include <sdk/calc/inputQueue.hpp>
+#include <sdk/os/mem.hpp>
+
+static_assert((INPUT_QUEUE_SIZE & (INPUT_QUEUE_SIZE - 1)) == 0);
+const uint32_t INPUT_QUEUE_MASK = INPUT_QUEUE_SIZE - 1;
+
+//The events are copied with memcpy: a struct assignment would need a copy routine from libgcc
+
+void inputQueueInit(InputQueue &queue){
+	queue.head = 0;
+	queue.tail = 0;
+	queue.dropped = 0;
+}
+
+static inline bool isDrag(const struct InputEvent &event){
+	return event.type == EVENT_TOUCH && event.data.touch_single.direction == TOUCH_HOLD_DRAG;
+}
+
+int inputPump(InputQueue &queue){
+	struct InputEvent event;
+	int count = 0;
+	//Stop after a while, in case the events come in faster than we take them
+	for (int i=0; i<INPUT_QUEUE_SIZE*2; i++){
+		memset(&event, 0, sizeof(event));
+		GetInput(&event, 0x0, 0x12); //no timeout: type stays 0 if there is no event
+		if (event.type == 0) break;
+		count++;
+
+		//a drag after a drag that wasn't read yet: just update the position
+		if (isDrag(event) && queue.tail != queue.head){
+			struct InputEvent &newest = queue.events[(queue.tail - 1) & INPUT_QUEUE_MASK];
+			if (isDrag(newest)){
+				memcpy(&newest, &event, sizeof(event));
+				continue;
+			}
+		}
+
+		if (queue.tail - queue.head >= (uint32_t)INPUT_QUEUE_SIZE){
+			queue.dropped++;
+			continue;
+		}
+		memcpy(&queue.events[queue.tail & INPUT_QUEUE_MASK], &event, sizeof(event));
+		queue.tail++;
+	}
+	return count;
+}
+
+bool inputPop(InputQueue &queue, struct InputEvent &event){
+	if (queue.head == queue.tail) return false;
+	memcpy(&event, &queue.events[queue.head & INPUT_QUEUE_MASK], sizeof(event));
+	queue.head++;
+	return true;
+}
@@ -0,0 +1,46 @@
+#include <sdk/calc/keyboard.hpp>
+
+void keyboardInit(KeyboardState &state){
+	getKeyMatrix(state.last);
+	for (int i=0; i<KEY_MATRIX_WORDS; i++){
+		state.held[i] = state.last[i];
+		state.pressed[i] = 0;
+		state.released[i] = 0;
+	}
+}
+
+void keyboardUpdate(KeyboardState &state, bool debounce){
+	uint16_t now[KEY_MATRIX_WORDS];
+	getKeyMatrix(now);
+
+	for (int i=0; i<KEY_MATRIX_WORDS; i++){
+		uint16_t held = now[i];
+		if (debounce){
+			//bits where the two reads agree take the new value, the others keep the old state
+			uint16_t agree = ~(now[i] ^ state.last[i]);
+			held = (now[i] & agree) | (state.held[i] & ~agree);
+		}
+		state.pressed[i] = held & ~state.held[i];
+		state.released[i] = ~held & state.held[i];
+		state.held[i] = held;
+		state.last[i] = now[i];
+	}
+}
+
+bool keyboardNext(const uint16_t *keys, int &position, InputScancode &scancode){
+	for (; position < KEY_MATRIX_WORDS*16; position++){
+		int word = position >> 4;
+		if (!keys[word]){
+			//skip the rest of an empty word
+			position |= 15;
+			continue;
+		}
+		int bit = position & 15;
+		if (keys[word] & (1 << bit)){
+			scancode = scancodeFromBit(word, bit);
+			position++;
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,81 @@
+#include <sdk/calc/lcdc.hpp>
+#include <sdk/calc/calc.hpp>
+#include <sdk/calc/dma.hpp>
+
+//The lcd controller is connected to the bus at 0xB4000000. Bit 4 of port R (PRDR) is the RS line
+//of the controller: 0 means we write a command (register number), 1 means we write data.
+static volatile uint16_t * const LCDC = (volatile uint16_t *)0xB4000000;
+static volatile uint8_t * const PRDR = (volatile uint8_t *)0xA405013C;
+
+//Commands of the controller (MIPI DCS command set)
+const uint16_t LCDC_COLUMN_ADDRESS_SET = 0x2A;
+const uint16_t LCDC_PAGE_ADDRESS_SET = 0x2B;
+const uint16_t LCDC_MEMORY_WRITE = 0x2C;
+
+//synco makes sure the write to PRDR has finished before the next bus access. The sdk is built for
+//plain SH4, where the assembler doesn't know synco (it's SH4A), so we emit the opcode directly.
+static inline void synco(){
+	__asm__ volatile(".word 0x00AB" : : : "memory");
+}
+
+static inline void lcdcSelect(uint16_t reg){
+	*PRDR &= ~0x10; //RS=0: command
+	synco();
+	*LCDC = reg;
+	synco();
+	*PRDR |= 0x10;  //RS=1: everything after this is data
+	synco();
+}
+
+void lcdcBeginWrite(int x0, int y0, int x1, int y1){
+	lcdcWait(); //the rest of the last window would go into this one
+	lcdcSelect(LCDC_COLUMN_ADDRESS_SET);
+	*LCDC = x0 >> 8; *LCDC = x0 & 0xFF;
+	*LCDC = x1 >> 8; *LCDC = x1 & 0xFF;
+	lcdcSelect(LCDC_PAGE_ADDRESS_SET);
+	*LCDC = y0 >> 8; *LCDC = y0 & 0xFF;
+	*LCDC = y1 >> 8; *LCDC = y1 & 0xFF;
+	lcdcSelect(LCDC_MEMORY_WRITE);
+}
+
+void lcdcPushPixels(const uint16_t *p, int count){
+	while (count >= 4){
+		*LCDC = p[0];
+		*LCDC = p[1];
+		*LCDC = p[2];
+		*LCDC = p[3];
+		p += 4;
+		count -= 4;
+	}
+	while (count--)
+		*LCDC = *p++;
+}
+
+void lcdcPushRect(const uint16_t *buffer, int stride, int x, int y, int w, int h, bool dma){
+	//clip the rectangle to the screen, moving the start in buffer along
+	if (x<0) { w+=x; buffer-=x; x=0; }
+	if (y<0) { h+=y; buffer-=y*stride; y=0; }
+	if (x+w>width)  w=width-x;
+	if (y+h>height) h=height-y;
+	if (w<=0 || h<=0) return;
+
+	lcdcBeginWrite(x, y, x+w-1, y+h-1);
+
+	//The controller fills the window row by row, so we only have to send the pixels
+	if (dma && (w == stride || h == 1)){
+		dmaWritePort16(LCDC, buffer, w*h);
+		return;
+	}
+	for (int j=0; j<h; j++){
+		lcdcPushPixels(buffer, w);
+		buffer += stride;
+	}
+}
+
+bool lcdcBusy(){
+	return dmaBusy();
+}
+
+void lcdcWait(){
+	dmaWait();
+}
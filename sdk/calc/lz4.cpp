@@ -0,0 +1,59 @@
+#include <sdk/calc/lz4.hpp>
+#include <sdk/os/mem.hpp>
+
+//A literal or match length: the 4 bits of the token, plus bytes of 255 until one is smaller
+static inline bool readLength(const uint8_t *&src, const uint8_t *srcEnd, uint32_t &length){
+	if (length != 15) return true;
+	uint8_t b;
+	do {
+		if (src >= srcEnd) return false;
+		b = *src++;
+		length += b;
+	} while (b == 255);
+	return true;
+}
+
+int lz4Decompress(uint8_t *dst, int dstSize, const uint8_t *src, int srcSize){
+	uint8_t *out = dst;
+	uint8_t *outEnd = dst + dstSize;
+	const uint8_t *srcEnd = src + srcSize;
+
+	while (src < srcEnd){
+		uint8_t token = *src++;
+
+		//literals
+		uint32_t length = token >> 4;
+		if (!readLength(src, srcEnd, length)) return -1;
+		if (length > (uint32_t)(srcEnd - src) || length > (uint32_t)(outEnd - out)) return -1;
+		memcpy(out, src, length);
+		out += length;
+		src += length;
+
+		//the last sequence has no match
+		if (src == srcEnd) break;
+
+		//match
+		if (srcEnd - src < 2) return -1;
+		uint32_t offset = src[0] | (src[1] << 8);
+		src += 2;
+		if (offset == 0 || offset > (uint32_t)(out - dst)) return -1;
+
+		length = token & 15;
+		if (!readLength(src, srcEnd, length)) return -1;
+		length += 4;
+		if (length > (uint32_t)(outEnd - out)) return -1;
+
+		const uint8_t *match = out - offset;
+		if (offset >= length){
+			memcpy(out, match, length);
+			out += length;
+		} else {
+			//overlapping (a repeated pattern), has to go byte by byte
+			for (uint32_t i=0; i<length; i++)
+				out[i] = match[i];
+			out += length;
+		}
+	}
+
+	return out - dst;
+}
@@ -0,0 +1,66 @@
+#include <sdk/calc/mcsDirectory.hpp>
+
+const int INDEX_SLOTS = 512; //a power of two, twice MCS_MAX_FOLDERS so the probe chains stay short
+
+static const McsFolder *slots[INDEX_SLOTS];
+static bool indexed;
+
+bool mcsNameEquals(const char *mcsName, const char *name){
+	for (int i=0; i<MCS_NAME_LENGTH; i++){
+		if (mcsName[i] != name[i]) return false;
+		if (name[i] == 0) return true;
+	}
+	return name[MCS_NAME_LENGTH] == 0;
+}
+
+//FNV-1a of the name, up to its end or MCS_NAME_LENGTH characters
+static uint32_t hashName(const char *name){
+	uint32_t hash = 2166136261u;
+	for (int i=0; i<MCS_NAME_LENGTH && name[i] != 0; i++)
+		hash = (hash ^ (uint8_t)name[i]) * 16777619u;
+	return hash;
+}
+
+static void buildIndex(){
+	for (int i=0; i<INDEX_SLOTS; i++) slots[i] = nullptr;
+
+	const McsFolder *folder = (const McsFolder*)MCS_FOLDER_TABLE;
+	for (int i=0; i<MCS_MAX_FOLDERS; i++, folder++){
+		//the address of the variables can't start with 0, if it does we've seen all folders
+		if (((uintptr_t)folder->variables >> 24) == 0) break;
+		uint32_t slot = hashName(folder->name);
+		while (slots[slot & (INDEX_SLOTS-1)] != nullptr) slot++;
+		slots[slot & (INDEX_SLOTS-1)] = folder;
+	}
+	indexed = true;
+}
+
+static const McsFolder *lookup(const char *name){
+	uint32_t slot = hashName(name);
+	for (;; slot++){
+		const McsFolder *folder = slots[slot & (INDEX_SLOTS-1)];
+		if (folder == nullptr) return nullptr;
+		if (mcsNameEquals(folder->name, name)) return folder;
+	}
+}
+
+const McsFolder *mcsFindFolder(const char *name){
+	if (!indexed) buildIndex();
+	//a folder that isn't there (or one that moved) might just be newer than the index
+	const McsFolder *folder = lookup(name);
+	if (folder != nullptr && ((uintptr_t)folder->variables >> 24) != 0) return folder;
+	buildIndex();
+	return lookup(name);
+}
+
+bool mcsNextVariable(const McsFolder &folder, uint8_t type, int &position, const McsVariable *&variable){
+	for (; position < folder.numVariables; position++){
+		const McsVariable *v = &folder.variables[position];
+		if (type == 0 || v->type == type){
+			variable = v;
+			position++;
+			return true;
+		}
+	}
+	return false;
+}
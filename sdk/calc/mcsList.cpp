@@ -0,0 +1,72 @@
+#include <sdk/calc/mcsList.hpp>
+#include <sdk/os/mem.hpp>
+
+static bool sameBytes(const uint8_t *a, const uint8_t *b, int count){
+	for (int i=0; i<count; i++)
+		if (a[i] != b[i]) return false;
+	return true;
+}
+
+int mcsListWriteWith(const char *folder, const char *name, const void *values, int count, McsToOBCD convert){
+	if (count <= 0 || count > 0xFFFF) return MCS_INDEX_OOB;
+	int ret = MCS_List_Create(folder, name, MCS_LIST_SLOT, count, VARTYPE_OBCD);
+	if (ret) return ret;
+
+	//one OBCD for all of them
+	OBCD bcd;
+	convert(values, 0, bcd);
+	ret = MCS_List_Set(folder, name, sizeof(bcd), 0, VARTYPE_OBCD, &bcd);
+	if (ret) return ret;
+
+	//if the first slot is what we expect, write the others directly
+	uint8_t type;
+	char *name2;
+	uint8_t *data;
+	uint32_t size;
+	bool direct = MCS_GetVariable(folder, name, &type, &name2, (void**)&data, &size) == 0 &&
+		type == VARTYPE_LIST && size == (uint32_t)count * MCS_LIST_SLOT &&
+		sameBytes(data, (const uint8_t*)&bcd, sizeof(bcd));
+
+	for (int i=1; i<count; i++){
+		convert(values, i, bcd);
+		if (direct){
+			memcpy(data + i * MCS_LIST_SLOT, &bcd, sizeof(bcd));
+		}else{
+			ret = MCS_List_Set(folder, name, sizeof(bcd), i, VARTYPE_OBCD, &bcd);
+			if (ret) return ret;
+		}
+	}
+	return 0;
+}
+
+int mcsListReadWith(const char *folder, const char *name, void *values, int max, McsFromOBCD convert){
+	uint8_t type;
+	char *name2;
+	const uint8_t *data;
+	uint32_t size;
+	int ret = MCS_GetVariable(folder, name, &type, &name2, (void**)&data, &size);
+	if (ret) return -ret;
+	if (type != VARTYPE_LIST) return -MCS_NOT_LIST;
+
+	int count = size / MCS_LIST_SLOT;
+	if (count > max) count = max;
+	OBCD bcd;
+	for (int i=0; i<count; i++){
+		//the slots of the OS might not be aligned for the uint16_t exponent
+		memcpy(&bcd, data + i * MCS_LIST_SLOT, sizeof(bcd));
+		convert(bcd, values, i);
+	}
+	return count;
+}
+
+int mcsListWrite(const char *folder, const char *name, const int32_t *values, int count){
+	return mcsListWriteWith(folder, name, values, count, [](const void *v, int i, OBCD &bcd){
+		int32ToOBCD(((const int32_t*)v)[i], bcd);
+	});
+}
+
+int mcsListRead(const char *folder, const char *name, int32_t *values, int max){
+	return mcsListReadWith(folder, name, values, max, [](const OBCD &bcd, void *v, int i){
+		((int32_t*)v)[i] = obcdToInt32(bcd);
+	});
+}
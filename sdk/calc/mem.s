@@ -0,0 +1,329 @@
+!memset, memset16, memset32, memcpy and memmove (declared in sdk/os/mem.hpp)
+!The OS versions are still there as OS_memset and OS_memcpy.
+!r4, r5, r6 are the arguments, r0 to r7 can be used freely, r3 keeps the return value (the destination).
+!Big blocks are done in 32 byte cache lines with movca.l: it allocates the line in the cache without
+!reading it from memory first (the other 7 stores of the line then hit the cache). memcpy also prefetches the
+!source one line ahead (pref).
+
+.align 2
+.global _memset
+.type _memset, @function
+
+!void *memset(void *ptr, int value, int num)
+_memset:
+	mov r4, r3
+	extu.b r5, r0
+	swap.b r0, r1   !value << 8
+	or r1, r0
+	swap.w r0, r1   !the two bytes << 16
+	or r1, r0       !the byte in all 4 bytes of r0
+	mov #16, r1
+	cmp/hs r1, r6
+	bt Fill_align
+	!short: byte by byte
+	tst r6, r6
+	bt Fill_done
+Memset_bytes:
+	dt r6
+	mov.b r0, @r4
+	bf/s Memset_bytes
+	add #1, r4
+	rts
+	mov r3, r0
+
+
+.align 2
+.global _memset16
+.type _memset16, @function
+
+!void *memset16(uint16_t *dst, uint16_t value, int count)
+_memset16:
+	mov r4, r3
+	extu.w r5, r0
+	swap.w r0, r1
+	or r1, r0       !the value in both halves of r0
+	cmp/pl r6
+	bf Fill_done
+	bra Fill_align
+	add r6, r6      !count in bytes
+
+
+.align 2
+.global _memset32
+.type _memset32, @function
+
+!void *memset32(uint32_t *dst, uint32_t value, int count)
+_memset32:
+	mov r4, r3
+	mov r5, r0
+	cmp/pl r6
+	bf Fill_done
+	shll2 r6        !count in bytes
+
+!Fills r6 bytes at r4 with the pattern in r0. r4 has to be aligned to what the pattern repeats in,
+!so every aligned store writes the right bytes. r6 is at least 16 for memset (r4 may be odd), more than 0 for the others.
+Fill_align:
+	mov #1, r1
+	tst r1, r4
+	bt 1f
+	mov.b r0, @r4
+	add #1, r4
+	add #-1, r6
+1:	mov #2, r1
+	tst r1, r4
+	bt 2f
+	mov.w r0, @r4
+	add #2, r4
+	add #-2, r6
+2:	mov #64, r1
+	cmp/hs r1, r6
+	bf Fill_longs
+	!long words up to the start of the next cache line
+	mov #31, r1
+3:	tst r1, r4
+	bt 4f
+	mov.l r0, @r4
+	add #4, r4
+	bra 3b
+	add #-4, r6
+4:	mov r6, r2
+	shlr2 r2
+	shlr2 r2
+	shlr r2         !number of cache lines
+5:	movca.l r0, @r4
+	mov.l r0, @(4,r4)
+	mov.l r0, @(8,r4)
+	mov.l r0, @(12,r4)
+	mov.l r0, @(16,r4)
+	mov.l r0, @(20,r4)
+	mov.l r0, @(24,r4)
+	mov.l r0, @(28,r4)
+	dt r2
+	bf/s 5b
+	add #32, r4
+	and r1, r6      !the rest after the last line
+Fill_longs:
+	!16 bytes per loop, then single long words
+	mov r6, r2
+	shlr2 r2
+	shlr2 r2
+	tst r2, r2
+	bt 7f
+6:	mov.l r0, @r4
+	mov.l r0, @(4,r4)
+	mov.l r0, @(8,r4)
+	mov.l r0, @(12,r4)
+	dt r2
+	bf/s 6b
+	add #16, r4
+7:	mov #12, r2
+	and r6, r2
+	shlr2 r2
+	tst r2, r2
+	bt 9f
+8:	mov.l r0, @r4
+	dt r2
+	bf/s 8b
+	add #4, r4
+	!at most 3 bytes are left, r4 is aligned
+9:	mov #2, r1
+	tst r1, r6
+	bt 10f
+	mov.w r0, @r4
+	add #2, r4
+10:	mov #1, r1
+	tst r1, r6
+	bt Fill_done
+	mov.b r0, @r4
+Fill_done:
+	rts
+	mov r3, r0
+
+
+.align 2
+.global _memmove
+.type _memmove, @function
+
+!void *memmove(void *destination, const void *source, int num)
+!Without an overlap this is memcpy. Otherwise it copies forward if destination is below source and backward if
+!it is above, with long words if both pointers and num are aligned, and bytes if not.
+_memmove:
+	mov r5, r0
+	add r6, r0
+	cmp/hs r0, r4   !destination >= source+num
+	bt _memcpy
+	mov r4, r0
+	add r6, r0
+	cmp/hs r0, r5   !source >= destination+num
+	bt _memcpy
+	mov r4, r3
+	mov r4, r0
+	or r5, r0
+	or r6, r0       !the low 2 bits are 0 if everything is aligned to 4
+	cmp/hi r4, r5
+	bt Move_forward
+	!backward
+	add r6, r4
+	add r6, r5
+	tst #3, r0
+	bf 2f
+	shlr2 r6
+	tst r6, r6
+	bt Move_done
+1:	add #-4, r5
+	mov.l @r5, r1
+	add #-4, r4
+	dt r6
+	bf/s 1b
+	mov.l r1, @r4
+	bra Move_done
+	nop
+2:	tst r6, r6
+	bt Move_done
+3:	add #-1, r5
+	mov.b @r5, r1
+	add #-1, r4
+	dt r6
+	bf/s 3b
+	mov.b r1, @r4
+	bra Move_done
+	nop
+Move_forward:
+	tst #3, r0
+	bf 5f
+	shlr2 r6
+	tst r6, r6
+	bt Move_done
+4:	mov.l @r5+, r1
+	dt r6
+	mov.l r1, @r4
+	bf/s 4b
+	add #4, r4
+	bra Move_done
+	nop
+5:	tst r6, r6
+	bt Move_done
+6:	mov.b @r5+, r1
+	dt r6
+	mov.b r1, @r4
+	bf/s 6b
+	add #1, r4
+Move_done:
+	rts
+	mov r3, r0
+
+
+.align 2
+.global _memcpy
+.type _memcpy, @function
+
+!void *memcpy(void *destination, const void *source, int num)
+!Long words if source and destination have the same alignment (mod 4), words if they have the same mod 2, bytes otherwise.
+_memcpy:
+	mov r4, r3
+	mov #16, r1
+	cmp/hs r1, r6
+	bf Copy_bytes
+	mov r4, r0
+	xor r5, r0
+	tst #1, r0
+	bf Copy_bytes
+	!align the destination to 2 (then the source is too)
+	mov r4, r0
+	tst #1, r0
+	bt 1f
+	mov.b @r5+, r1
+	mov.b r1, @r4
+	add #1, r4
+	add #-1, r6
+1:	mov r4, r0
+	xor r5, r0
+	tst #2, r0
+	bf Copy_words
+	!align both to 4
+	mov r4, r0
+	tst #2, r0
+	bt 2f
+	mov.w @r5+, r1
+	mov.w r1, @r4
+	add #2, r4
+	add #-2, r6
+2:	mov #64, r1
+	cmp/hs r1, r6
+	bf Copy_longs
+	!long words up to the start of the next cache line
+	mov r4, r0
+3:	tst #31, r0
+	bt 4f
+	mov.l @r5+, r1
+	mov.l r1, @r0
+	add #4, r0
+	bra 3b
+	add #-4, r6
+4:	mov r0, r4
+	mov.l r8, @-r15
+	mov r6, r8
+	shlr2 r8
+	shlr2 r8
+	shlr r8         !number of cache lines
+	!pref starts loading the next line of the source while this one is copied (for the last line that's the one
+	!after the end of the source, which is just read into the cache)
+5:	mov r5, r0
+	add #32, r0
+	pref @r0
+	mov.l @r5+, r0
+	mov.l @r5+, r1
+	mov.l @r5+, r2
+	mov.l @r5+, r7
+	movca.l r0, @r4
+	mov.l r1, @(4,r4)
+	mov.l r2, @(8,r4)
+	mov.l r7, @(12,r4)
+	mov.l @r5+, r0
+	mov.l @r5+, r1
+	mov.l @r5+, r2
+	mov.l @r5+, r7
+	mov.l r0, @(16,r4)
+	mov.l r1, @(20,r4)
+	mov.l r2, @(24,r4)
+	mov.l r7, @(28,r4)
+	dt r8
+	bf/s 5b
+	add #32, r4
+	mov.l @r15+, r8
+	mov #31, r1
+	and r1, r6      !the rest after the last line
+Copy_longs:
+	mov r6, r2
+	shlr2 r2
+	tst r2, r2
+	bt 7f
+6:	mov.l @r5+, r1
+	dt r2
+	mov.l r1, @r4
+	bf/s 6b
+	add #4, r4
+7:	mov #3, r1
+	bra Copy_bytes
+	and r1, r6
+Copy_words:
+	mov r6, r2
+	shlr r2
+8:	mov.w @r5+, r1
+	dt r2
+	mov.w r1, @r4
+	bf/s 8b
+	add #2, r4
+	mov #1, r1
+	and r1, r6
+Copy_bytes:
+	tst r6, r6
+	bt Copy_done
+9:	mov.b @r5+, r1
+	dt r6
+	mov.b r1, @r4
+	bf/s 9b
+	add #1, r4
+Copy_done:
+	rts
+	mov r3, r0
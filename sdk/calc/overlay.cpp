@@ -0,0 +1,98 @@
+#include <sdk/calc/overlay.hpp>
+#include <sdk/cpu/cache.hpp>
+#include <sdk/os/file.hpp>
+#include <sdk/os/mem.hpp>
+
+//Just the parts of the ELF headers we need (see launcher/elf.h)
+struct ElfHeader {
+	uint8_t ident[16];
+	uint16_t type, machine;
+	uint32_t version, entry, phoff, shoff, flags;
+	uint16_t ehsize, phentsize, phnum, shentsize, shnum, shstrndx;
+};
+struct SectionHeader {
+	uint32_t name, type, flags, addr, offset, size, link, info, addralign, entsize;
+};
+
+struct OverlayInfo {
+	uint32_t address;
+	uint32_t offset;	//in the file
+	uint32_t size;
+};
+
+//The app template's start.s puts the real one into the header, this one is for apps without it (like the demos)
+__attribute__((weak)) int32_t appFile = -1;
+
+static OverlayInfo overlays[OVERLAY_MAX];
+static bool scanned;
+static uint32_t loaded;	//bit id is set if overlay id is loaded
+
+//".overlay" and one digit, returns the digit or -1
+static int overlayId(const char *name){
+	const char prefix[] = ".overlay";
+	for (int i=0; prefix[i]; i++)
+		if (name[i] != prefix[i]) return -1;
+	char digit = name[sizeof(prefix)-1];
+	if (digit < '0' || digit >= '0' + OVERLAY_MAX || name[sizeof(prefix)] != '\0') return -1;
+	return digit - '0';
+}
+
+//Reads up to size bytes at offset of the app's file, returns how many it got
+static int readAt(uint32_t offset, void *buffer, uint32_t size){
+	if (lseek(appFile, offset, SEEK_SET) < 0) return -1;
+	return read(appFile, buffer, size);
+}
+
+static void scan(){
+	scanned = true;
+	if (appFile < 0) return;
+
+	ElfHeader elf;
+	if (readAt(0, &elf, sizeof(elf)) != sizeof(elf)) return;
+	if (elf.shentsize != sizeof(SectionHeader) || elf.shstrndx >= elf.shnum) return;
+
+	SectionHeader names;
+	if (readAt(elf.shoff + elf.shstrndx * sizeof(SectionHeader), &names, sizeof(names)) != sizeof(names)) return;
+	for (int i=0; i<elf.shnum; i++){
+		SectionHeader section;
+		if (readAt(elf.shoff + i * sizeof(SectionHeader), &section, sizeof(section)) != sizeof(section)) return;
+		//just enough for ".overlay0" and its terminator, longer names don't match anyway
+		char name[11];
+		int length = readAt(names.offset + section.name, name, sizeof(name) - 1);
+		name[length > 0 ? length : 0] = '\0';
+		int id = overlayId(name);
+		if (id < 0) continue;
+		overlays[id].address = section.addr;
+		overlays[id].offset = section.offset;
+		overlays[id].size = section.size;
+	}
+	//the first one is stored where it runs, so the launcher already loaded it
+	if (overlays[0].size) loaded = 1;
+}
+
+bool overlayEnsure(int id){
+	if (id < 0 || id >= OVERLAY_MAX) return false;
+	if (!scanned) scan();
+
+	OverlayInfo &overlay = overlays[id];
+	if (overlay.size == 0) return false;
+	if (loaded & (1 << id)) return true;
+
+	//everything that shares memory with it is gone
+	for (int i=0; i<OVERLAY_MAX; i++){
+		if (overlays[i].address < overlay.address + overlay.size &&
+				overlay.address < overlays[i].address + overlays[i].size)
+			loaded &= ~(1 << i);
+	}
+
+	//read through the file, which may be in several pieces in the flash
+	if (readAt(overlay.offset, (void*)overlay.address, overlay.size) != (int)overlay.size) return false;
+	//the new code is still in the operand cache, and the instruction cache may have the overlay that was there before
+	CACHE_SyncCode((const void*)overlay.address, overlay.size);
+	loaded |= 1 << id;
+	return true;
+}
+
+bool overlayLoaded(int id){
+	return id >= 0 && id < OVERLAY_MAX && (loaded & (1 << id));
+}
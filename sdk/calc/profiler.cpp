@@ -0,0 +1,150 @@
+#include <sdk/calc/profiler.hpp>
+#include <sdk/calc/breakpoint.hpp>
+#include <sdk/calc/onchip.hpp>
+#include <sdk/cpu/ubc.hpp>
+#include <sdk/os/file.hpp>
+#include <sdk/os/mem.hpp>
+#include <sdk/os/serial.hpp>
+
+struct Profile {
+	uint32_t *buckets;
+	uint32_t start, size;
+	int shift;
+	uint32_t period;
+	uint32_t samples;
+	bool running;
+};
+
+static Profile profile;
+
+//The breakpoint callback, called for every sample
+HOT_CODE static void profilerSample(uint32_t pc, uint32_t pr [[maybe_unused]], uint32_t channels [[maybe_unused]]){
+	uint32_t offset = pc - profile.start;
+	if (offset < profile.size){
+		profile.buckets[offset >> profile.shift]++;
+		profile.samples++;
+	}
+	//clear the match flag and count the next period
+	UBC_REG_CCMFR = 0;
+	UBC_REG_CETR1 = profile.period;
+}
+
+bool profilerStart(uint32_t start, uint32_t size, int bucketShift, uint32_t period){
+	if (size == 0 || (size & (size-1)) || (start & (size-1))) return false;
+	if (bucketShift < 1 || (size >> bucketShift) == 0) return false;
+	if (period < 1) period = 1;
+	if (period > UBC_CETR1_MAX) period = UBC_CETR1_MAX;
+
+	profilerFree();
+	uint32_t bytes = (size >> bucketShift) * sizeof(uint32_t);
+	profile.buckets = (uint32_t*)malloc(bytes);
+	if (profile.buckets == nullptr) return false;
+	memset(profile.buckets, 0, bytes);
+	profile.start = start;
+	profile.size = size;
+	profile.shift = bucketShift;
+	profile.period = period;
+	profile.samples = 0;
+
+	breakpointInstall(profilerSample);
+
+	//break after an instruction fetched from the range was executed, on every period'th match
+	UBC_REG_CBR1 = 0;
+	UBC_REG_CAR1 = start;
+	UBC_REG_CAMR1 = size - 1; //the bits set in the mask aren't compared
+	UBC_REG_CETR1 = period;
+	UBC_REG_CCMFR = 0;
+	UBC_REG_CRR1 = (1 << UBC_CRR_RESERVED) | (1 << UBC_CRR_PCB) | (1 << UBC_CRR_BIE);
+	UBC_REG_CBR1 = (1 << UBC_CBR_ETBE) | (1 << UBC_CBR_ID) | (1 << UBC_CBR_CE);
+	profile.running = true;
+	return true;
+}
+
+void profilerStop(){
+	if (!profile.running) return;
+	breakpointUninstall();
+	profile.running = false;
+}
+
+void profilerFree(){
+	profilerStop();
+	if (profile.buckets != nullptr) free(profile.buckets);
+	profile.buckets = nullptr;
+	profile.samples = 0;
+}
+
+uint32_t profilerSamples(){
+	return profile.samples;
+}
+
+//The stream is collected in a small buffer and written in blocks
+typedef void (*ProfileWriter)(const uint8_t *data, int length, int fd);
+
+struct ProfileOutput {
+	uint8_t buffer[64];
+	int length;
+	ProfileWriter write;
+	int fd;
+};
+
+static void putWord(ProfileOutput &out, uint32_t word){
+	if (out.length + 4 > (int)sizeof(out.buffer)){
+		out.write(out.buffer, out.length, out.fd);
+		out.length = 0;
+	}
+	out.buffer[out.length++] = word >> 24;
+	out.buffer[out.length++] = word >> 16;
+	out.buffer[out.length++] = word >> 8;
+	out.buffer[out.length++] = word;
+}
+
+static void sendProfile(ProfileWriter write, int fd){
+	ProfileOutput out;
+	out.length = 0;
+	out.write = write;
+	out.fd = fd;
+
+	uint32_t buckets = profile.buckets != nullptr ? profile.size >> profile.shift : 0;
+	uint32_t used = 0;
+	for (uint32_t i=0; i<buckets; i++)
+		if (profile.buckets[i]) used++;
+
+	putWord(out, ('P' << 24) | ('R' << 16) | ('O' << 8) | 'F');
+	putWord(out, 1);
+	putWord(out, profile.start);
+	putWord(out, profile.size);
+	putWord(out, profile.shift);
+	putWord(out, profile.period);
+	putWord(out, profile.samples);
+	putWord(out, used);
+	for (uint32_t i=0; i<buckets; i++){
+		if (profile.buckets[i] == 0) continue;
+		putWord(out, profile.start + (i << profile.shift));
+		putWord(out, profile.buckets[i]);
+	}
+	write(out.buffer, out.length, fd);
+}
+
+static void writeSerial(const uint8_t *data, int length, int fd [[maybe_unused]]){
+	//2 means the transmit buffer is full, wait until there's space
+	while (Serial_Write(data, length) == 2);
+}
+
+static void writeFile(const uint8_t *data, int length, int fd){
+	write(fd, data, length);
+}
+
+void profilerSendSerial(){
+	if (!Serial_IsOpen()){
+		unsigned char mode[6] = {0, 9, 0, 0, 0, 0}; //115200 baud, 8N1
+		Serial_Open(mode);
+	}
+	sendProfile(writeSerial, 0);
+}
+
+bool profilerSaveFile(const char *path){
+	int fd = open(path, OPEN_WRITE | OPEN_CREATE);
+	if (fd < 0) return false;
+	sendProfile(writeFile, fd);
+	return close(fd) >= 0;
+}
@@ -0,0 +1,18 @@
+#include <sdk/calc/calc.hpp>
+#include <sdk/calc/lcdc.hpp>
+
+//Partial lcd refresh
+//LCD_Refresh() always sends all 320x528 pixels to the lcd controller. Here we only send the pixels
+//of a rectangle of the vram, through the driver in lcdc.hpp.
+
+void LCD_RefreshRect(int x, int y, int w, int h){
+	if (x<0) { w+=x; x=0; }
+	if (y<0) { h+=y; y=0; }
+	lcdcPushRect(vram + width*y + x, width, x, y, w, h, false);
+}
+
+void LCD_RefreshDirty(){
+	if (dirty.x1 < dirty.x0 || dirty.y1 < dirty.y0) return; //nothing changed
+	LCD_RefreshRect(dirty.x0, dirty.y0, dirty.x1-dirty.x0+1, dirty.y1-dirty.y0+1);
+	clearDirty();
+}
@@ -0,0 +1,118 @@
+#include <sdk/calc/serialBuffer.hpp>
+#include <sdk/calc/stringBuilder.hpp>
+#include <sdk/os/mem.hpp>
+#include <sdk/os/serial.hpp>
+
+static_assert((SERIAL_TX_SIZE & (SERIAL_TX_SIZE - 1)) == 0);
+static_assert((SERIAL_RX_SIZE & (SERIAL_RX_SIZE - 1)) == 0);
+const uint32_t TX_MASK = SERIAL_TX_SIZE - 1;
+const uint32_t RX_MASK = SERIAL_RX_SIZE - 1;
+
+void serialBufferInit(SerialBuffer &serial, int bitRate){
+	serial.txHead = serial.txTail = 0;
+	serial.rxHead = serial.rxTail = 0;
+	serial.dropped = 0;
+	if (!Serial_IsOpen()){
+		unsigned char mode[6] = {0, (unsigned char)bitRate, 0, 0, 0, 0};
+		Serial_Open(mode);
+	}
+}
+
+static void send(SerialBuffer &serial){
+	while (serial.txTail != serial.txHead){
+		int space = Serial_PollTX();
+		if (space <= 0) return;
+
+		//the part up to the end of the ring in one go
+		uint32_t start = serial.txHead & TX_MASK;
+		int count = serial.txTail - serial.txHead;
+		if (count > (int)(SERIAL_TX_SIZE - start)) count = SERIAL_TX_SIZE - start;
+		if (count > space) count = space;
+		if (Serial_Write(serial.tx + start, count) != 0) return;
+		serial.txHead += count;
+	}
+}
+
+static void receive(SerialBuffer &serial){
+	while (true){
+		int waiting = Serial_PollRX();
+		if (waiting <= 0) return;
+
+		uint32_t used = serial.rxTail - serial.rxHead;
+		if (used == SERIAL_RX_SIZE){
+			serial.dropped += waiting;
+			Serial_ClearRX();
+			return;
+		}
+		uint32_t start = serial.rxTail & RX_MASK;
+		int count = SERIAL_RX_SIZE - used;
+		if (count > (int)(SERIAL_RX_SIZE - start)) count = SERIAL_RX_SIZE - start;
+		if (count > waiting) count = waiting;
+
+		short got = 0;
+		Serial_Read(serial.rx + start, count, &got);
+		if (got <= 0) return;
+		serial.rxTail += got;
+	}
+}
+
+void serialPump(SerialBuffer &serial){
+	send(serial);
+	receive(serial);
+}
+
+void serialFlush(SerialBuffer &serial){
+	while (serial.txTail != serial.txHead) send(serial);
+}
+
+int serialWrite(SerialBuffer &serial, const void *data, int count){
+	uint32_t space = SERIAL_TX_SIZE - (serial.txTail - serial.txHead);
+	if ((uint32_t)count > space){
+		serial.dropped += count - space;
+		count = space;
+	}
+
+	const uint8_t *src = (const uint8_t*)data;
+	uint32_t start = serial.txTail & TX_MASK;
+	int first = SERIAL_TX_SIZE - start;
+	if (first > count) first = count;
+	memcpy(serial.tx + start, src, first);
+	memcpy(serial.tx, src + first, count - first);
+	serial.txTail += count;
+	return count;
+}
+
+int serialWriteString(SerialBuffer &serial, const char *text){
+	int length = 0;
+	while (text[length]) length++;
+	return serialWrite(serial, text, length);
+}
+
+int serialWriteHex(SerialBuffer &serial, uint32_t value, int digits){
+	char text[8];
+	if (digits > 8) digits = 8;
+	for (int i=0; i<digits; i++)
+		text[i] = "0123456789ABCDEF"[(value >> ((digits-1-i) * 4)) & 0xF];
+	return serialWrite(serial, text, digits);
+}
+
+int serialWriteDec(SerialBuffer &serial, int32_t value){
+	char text[11];
+	char *first = formatUInt(text + sizeof(text), value < 0 ? 0u - (uint32_t)value : value);
+	if (value < 0) *--first = '-';
+	return serialWrite(serial, first, text + sizeof(text) - first);
+}
+
+int serialRead(SerialBuffer &serial, void *data, int count){
+	int available = serial.rxTail - serial.rxHead;
+	if (count > available) count = available;
+
+	uint8_t *dest = (uint8_t*)data;
+	uint32_t start = serial.rxHead & RX_MASK;
+	int first = SERIAL_RX_SIZE - start;
+	if (first > count) first = count;
+	memcpy(dest, serial.rx + start, first);
+	memcpy(dest + first, serial.rx, count - first);
+	serial.rxHead += count;
+	return count;
+}
@@ -0,0 +1,30 @@
+!strlen (declared in sdk/os/string.hpp), the OS version is still there as OS_strlen
+
+.align 2
+.global _strlen
+.type _strlen, @function
+
+!int strlen(const char *str)
+!Bytes until str is aligned, then one long word at a time: cmp/str sets T if any of the 4 bytes is 0.
+!An aligned long word never crosses into the next page, so reading past the end is safe.
+_strlen:
+	mov r4, r0
+1:	tst #3, r0
+	bt 2f
+	mov.b @r0+, r1
+	tst r1, r1
+	bf 1b
+	add #-1, r0
+	rts
+	sub r4, r0
+2:	mov #0, r2
+3:	mov.l @r0+, r1
+	cmp/str r2, r1
+	bf 3b
+	add #-4, r0     !find the 0 in the last long word
+4:	mov.b @r0+, r1
+	tst r1, r1
+	bf 4b
+	add #-1, r0
+	rts
+	sub r4, r0
@@ -0,0 +1,89 @@
+#include <sdk/calc/stringBuilder.hpp>
+#include <sdk/os/mem.hpp>
+
+//"00" to "99", so formatUInt() needs one division by 100 for two digits (which the compiler turns into a multiplication)
+struct DigitPairs {
+	char v[200];
+};
+constexpr DigitPairs makeDigitPairs(){
+	DigitPairs t = {};
+	for (int i=0; i<100; i++){
+		t.v[2*i] = '0' + i / 10;
+		t.v[2*i+1] = '0' + i % 10;
+	}
+	return t;
+}
+static constexpr DigitPairs digitPairs = makeDigitPairs();
+
+char *formatUInt(char *end, uint32_t value){
+	while (value >= 100){
+		uint32_t pair = value % 100;
+		value /= 100;
+		end -= 2;
+		end[0] = digitPairs.v[2*pair];
+		end[1] = digitPairs.v[2*pair+1];
+	}
+	if (value >= 10){
+		end -= 2;
+		end[0] = digitPairs.v[2*value];
+		end[1] = digitPairs.v[2*value+1];
+	} else {
+		*--end = '0' + value;
+	}
+	return end;
+}
+
+void appendString(StringBuilder &sb, const char *text, int count){
+	int space = sb.size - 1 - sb.length;
+	if (count > space){
+		count = space;
+		sb.truncated = true;
+	}
+	memcpy(sb.buffer + sb.length, text, count);
+	sb.length += count;
+	sb.buffer[sb.length] = '\0';
+}
+
+void appendString(StringBuilder &sb, const char *text){
+	//copy until the terminator or the end of the buffer, without a strlen() first
+	char *dest = sb.buffer + sb.length;
+	char *last = sb.buffer + sb.size - 1;
+	while (*text && dest < last)
+		*dest++ = *text++;
+	*dest = '\0';
+	sb.length = dest - sb.buffer;
+	if (*text) sb.truncated = true;
+}
+
+static void appendPadded(StringBuilder &sb, const char *digits, int count, bool negative, int width, char pad){
+	int padding = width - count - (negative ? 1 : 0);
+	if (negative && pad == '0') appendChar(sb, '-');
+	for (; padding > 0; padding--) appendChar(sb, pad);
+	if (negative && pad != '0') appendChar(sb, '-');
+	appendString(sb, digits, count);
+}
+
+void appendUInt(StringBuilder &sb, uint32_t value, int width, char pad){
+	char text[10];
+	char *first = formatUInt(text + sizeof(text), value);
+	appendPadded(sb, first, text + sizeof(text) - first, false, width, pad);
+}
+
+void appendInt(StringBuilder &sb, int32_t value, int width, char pad){
+	char text[10];
+	char *first = formatUInt(text + sizeof(text), value < 0 ? 0u - (uint32_t)value : value);
+	appendPadded(sb, first, text + sizeof(text) - first, value < 0, width, pad);
+}
+
+void appendHex(StringBuilder &sb, uint32_t value, int digits){
+	if (digits < 1) digits = 1;
+	if (digits > 8) digits = 8;
+	//at least as many digits as value needs
+	while (digits < 8 && (value >> (digits * 4)) != 0)
+		digits++;
+
+	char text[8];
+	for (int i=0; i<digits; i++)
+		text[i] = "0123456789ABCDEF"[(value >> ((digits-1-i) * 4)) & 0xF];
+	appendString(sb, text, digits);
+}
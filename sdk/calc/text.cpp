@@ -0,0 +1,156 @@
+#include <sdk/calc/text.hpp>
+
+//Glyph cache
+//Looking at the font's bits for every pixel is slow. The first time a font is used, every glyph row is turned
+//into the spans (runs of set pixels) in it. Drawing a glyph then just fills these spans with the color.
+//The spans don't depend on the color, so the same cache works for all colors.
+
+struct GlyphSpan {
+	uint8_t x, y, length;
+};
+
+const int MAX_GLYPHS = 256;
+const int MAX_SPANS = 4096;
+
+static const Font *cachedFont = nullptr;
+static const Font *uncachableFont = nullptr; //the last font that had more spans than MAX_SPANS
+static uint16_t glyphStart[MAX_GLYPHS + 1];  //index of the first span of every glyph in spans
+static GlyphSpan spans[MAX_SPANS];
+
+static bool buildCache(const Font &font){
+	if (cachedFont == &font) return true;
+	if (uncachableFont == &font) return false;
+	cachedFont = nullptr;
+
+	int count = font.last - font.first + 1;
+	const uint8_t *rows = font.rows;
+	int n = 0;
+	for (int g=0; g<count; g++){
+		glyphStart[g] = n;
+		for (int y=0; y<font.height; y++){
+			uint8_t bits = *rows++;
+			int x = 0;
+			while (bits){
+				while (!(bits & 0x80)) { bits <<= 1; x++; } //skip the empty columns
+				int start = x;
+				while (bits & 0x80) { bits <<= 1; x++; }    //count the set ones
+				if (n == MAX_SPANS){
+					uncachableFont = &font;
+					return false;
+				}
+				spans[n].x = start;
+				spans[n].y = y;
+				spans[n].length = x - start;
+				n++;
+			}
+		}
+	}
+	glyphStart[count] = n;
+	cachedFont = &font;
+	return true;
+}
+
+static inline int glyphIndex(const Font &font, char c){
+	uint8_t u = c;
+	if (u < font.first || u > font.last) u = '?';
+	if (u < font.first || u > font.last) u = font.first;
+	return u - font.first;
+}
+
+//Draws a pixel run of a glyph row, clipped to the screen
+static inline void clippedRun(int x, int y, int length, uint16_t color){
+	if (y<0 || y>=height) return;
+	int end = x + length;
+	if (x<0) x=0;
+	if (end>width) end=width;
+	uint16_t *p = vram + width*y + x;
+	for (int i=end-x; i>0; i--)
+		*p++ = color;
+}
+
+static void drawGlyph(const Font &font, int g, int x, int y, uint16_t color, bool cached){
+	bool inside = x>=0 && y>=0 && x+font.widths[g]<=width && y+font.height<=height;
+
+	if (!cached){
+		//slow path: walk the bits of the font
+		const uint8_t *rows = font.rows + g*font.height;
+		for (int j=0; j<font.height; j++){
+			uint8_t bits = rows[j];
+			for (int i=0; bits; i++, bits <<= 1)
+				if (bits & 0x80) clippedRun(x+i, y+j, 1, color);
+		}
+		return;
+	}
+
+	const GlyphSpan *s = spans + glyphStart[g];
+	const GlyphSpan *end = spans + glyphStart[g+1];
+	if (inside){
+		//the whole glyph is on the screen, no checks needed
+		uint16_t *base = vram + width*y + x;
+		for (; s<end; s++){
+			uint16_t *p = base + width*s->y + s->x;
+			for (int i=s->length; i>0; i--)
+				*p++ = color;
+		}
+	}else{
+		for (; s<end; s++)
+			clippedRun(x + s->x, y + s->y, s->length, color);
+	}
+}
+
+int drawText(const char *text, int x, int y, uint16_t color, const Font &font){
+	bool cached = buildCache(font);
+	int lineX = x;
+	int lineHeight = font.height + 1;
+	int maxX = x;
+	int startY = y;
+
+	for (; *text; text++){
+		if (*text == '\n'){
+			x = lineX;
+			y += lineHeight;
+			continue;
+		}
+		int g = glyphIndex(font, *text);
+		int w = font.widths[g];
+		//skip glyphs that are completely outside of the screen
+		if (x < width && x+w > 0 && y < height && y+font.height > 0)
+			drawGlyph(font, g, x, y, color, cached);
+		x += w + font.spacing;
+		if (x > maxX) maxX = x;
+	}
+
+	//mark the box of all lines at once
+	int x0 = lineX<0 ? 0 : lineX;
+	int y0 = startY<0 ? 0 : startY;
+	int x1 = maxX>width ? width-1 : maxX-1;
+	int y1 = y+font.height>height ? height-1 : y+font.height-1;
+	if (x0<=x1 && y0<=y1) markDirty(x0, y0, x1, y1);
+	return x;
+}
+
+int drawText(const char *text, int x, int y, uint16_t color, uint16_t background, const Font &font){
+	fillRect(x, y, textWidth(text, font), textHeight(text, font), background);
+	return drawText(text, x, y, color, font);
+}
+
+int textWidth(const char *text, const Font &font){
+	int w = 0, max = 0;
+	for (; *text; text++){
+		if (*text == '\n'){
+			w = 0;
+			continue;
+		}
+		w += font.widths[glyphIndex(font, *text)] + font.spacing;
+		if (w > max) max = w;
+	}
+	//no spacing after the last character
+	return max > 0 ? max - font.spacing : 0;
+}
+
+int textHeight(const char *text, const Font &font){
+	int lines = 1;
+	for (; *text; text++)
+		if (*text == '\n') lines++;
+	return lines * (font.height + 1) - 1;
+}
@@ -0,0 +1,106 @@
+#include <sdk/calc/tilemap.hpp>
+#include <sdk/calc/calc.hpp>
+#include <sdk/os/mem.hpp>
+
+bool tileMapInit(TileMap &map, int columns, int rows, int tileWidth, int tileHeight){
+	map.columns = columns;
+	map.rows = rows;
+	map.rowWords = (columns + 31) >> 5;
+	map.tiles = (uint8_t*)malloc(columns * rows);
+	map.dirty = (uint32_t*)malloc(map.rowWords * rows * sizeof(uint32_t));
+	if (map.tiles == nullptr || map.dirty == nullptr){
+		tileMapFree(map);
+		return false;
+	}
+	memset(map.tiles, 0, columns * rows);
+	tileMapMarkAll(map);
+
+	map.tileWidth = tileWidth;
+	map.tileHeight = tileHeight;
+	map.spacing = 0;
+	map.atlas = nullptr;
+	map.colors = nullptr;
+	map.x = map.y = 0;
+	map.viewWidth = columns * tileWidth;
+	map.viewHeight = rows * tileHeight;
+	map.scrollX = map.scrollY = 0;
+	map.background = 0;
+	return true;
+}
+
+void tileMapFree(TileMap &map){
+	if (map.tiles != nullptr) free(map.tiles);
+	if (map.dirty != nullptr) free(map.dirty);
+	map.tiles = nullptr;
+	map.dirty = nullptr;
+	map.columns = map.rows = 0;
+}
+
+void tileMapMarkAll(TileMap &map){
+	//every column, but not the unused bits at the end of a row (tileMapDraw() would go past the last column)
+	uint32_t last = (map.columns & 31) ? (1u << (map.columns & 31)) - 1 : 0xFFFFFFFF;
+	uint32_t *word = map.dirty;
+	for (int r=0; r<map.rows; r++){
+		for (int k=0; k<map.rowWords-1; k++)
+			*word++ = 0xFFFFFFFF;
+		*word++ = last;
+	}
+}
+
+void tileMapFill(TileMap &map, uint8_t tile){
+	memset(map.tiles, tile, map.columns * map.rows);
+	tileMapMarkAll(map);
+}
+
+void tileMapScroll(TileMap &map, int scrollX, int scrollY){
+	if (scrollX == map.scrollX && scrollY == map.scrollY) return;
+	map.scrollX = scrollX;
+	map.scrollY = scrollY;
+	fillRect(map.x, map.y, map.viewWidth, map.viewHeight, map.background);
+	tileMapMarkAll(map);
+}
+
+//Draws one cell with its top left corner at (x, y), clipped to the view (x0, y0) to (x1, y1) (exclusive).
+//Returns false if none of it is in the view.
+static bool drawTile(const TileMap &map, uint8_t tile, int x, int y, int x0, int y0, int x1, int y1){
+	int srcX = x < x0 ? x0 - x : 0;
+	int srcY = y < y0 ? y0 - y : 0;
+	int w = (x + map.tileWidth > x1 ? x1 - x : map.tileWidth) - srcX;
+	int h = (y + map.tileHeight > y1 ? y1 - y : map.tileHeight) - srcY;
+	if (w <= 0 || h <= 0) return false;
+
+	if (map.atlas != nullptr)
+		blitRect<BLIT_OPAQUE>(*map.atlas, x + srcX, y + srcY, srcX, tile * map.tileHeight + srcY, w, h);
+	else
+		fillRect(x + srcX, y + srcY, w, h, map.colors[tile]);
+	return true;
+}
+
+int tileMapDraw(TileMap &map){
+	const int pitchX = map.tileWidth + map.spacing;
+	const int pitchY = map.tileHeight + map.spacing;
+	const int x0 = map.x, y0 = map.y;
+	const int x1 = map.x + map.viewWidth, y1 = map.y + map.viewHeight;
+
+	int drawn = 0;
+	uint32_t *dirty = map.dirty;
+	const uint8_t *tiles = map.tiles;
+	int y = map.y - map.scrollY;
+	for (int r=0; r<map.rows; r++, y+=pitchY, dirty+=map.rowWords, tiles+=map.columns){
+		bool visible = y < y1 && y + map.tileHeight > y0;
+		for (int k=0; k<map.rowWords; k++){
+			uint32_t bits = dirty[k];
+			if (bits == 0) continue;
+			dirty[k] = 0;
+			if (!visible) continue;
+
+			int column = k * 32;
+			int x = map.x - map.scrollX + column * pitchX;
+			for (; bits; bits >>= 1, column++, x += pitchX){
+				if ((bits & 1) && drawTile(map, tiles[column], x, y, x0, y0, x1, y1))
+					drawn++;
+			}
+		}
+	}
+	return drawn;
+}
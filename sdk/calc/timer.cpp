@@ -0,0 +1,128 @@
+#include <sdk/calc/timer.hpp>
+#include <sdk/calc/div.hpp>
+#include <sdk/cpu/tmu.hpp>
+
+static struct {
+	uint32_t tcor, tcnt;
+	uint16_t tcr;
+	bool started;
+} saved;
+
+static uint32_t rate;		//ticks per second
+static uint32_t usPerTick;	//1000000 / rate, with 32 bits after the point
+static uint32_t lastTicks;	//the ticks at the last timerMicros()
+static uint32_t micros;
+static uint32_t microsFraction;	//32 bits after the point
+
+uint32_t timerTicks(){
+	//TCNT counts down
+	return ~TMU_GetChannel(TIMER_CHANNEL)->TCNT;
+}
+
+uint32_t timerRate(){
+	return rate;
+}
+
+bool timerInit(){
+	struct TMU_Channel *ch = TMU_GetChannel(TIMER_CHANNEL);
+	saved.tcor = ch->TCOR;
+	saved.tcnt = ch->TCNT;
+	saved.tcr = ch->TCR;
+	saved.started = TMU_REG_TSTR & (1 << TIMER_CHANNEL);
+
+	TMU_REG_TSTR &= ~(1 << TIMER_CHANNEL);
+	ch->TCR = TMU_TPSC_4 << TMU_TCR_TPSC; //no interrupt
+	ch->TCOR = 0xFFFFFFFF;
+	ch->TCNT = 0xFFFFFFFF;
+	TMU_REG_TSTR |= 1 << TIMER_CHANNEL;
+
+	//count the ticks in 16 steps of R64CNT (1/8 second), starting right after it changed
+	const int STEPS = 16;
+	for (int i=0; i<=STEPS; i++){
+		uint8_t r = RTC_REG_R64CNT & 0x7F;
+		uint32_t timeout = 0x1000000;
+		while ((RTC_REG_R64CNT & 0x7F) == r)
+			if (!--timeout){
+				timerEnd();
+				return false;
+			}
+		if (i == 0) lastTicks = timerTicks();
+	}
+	rate = (timerTicks() - lastTicks) * (RTC_R64CNT_RATE / STEPS);
+
+	usPerTick = udiv64(1000000, 0, rate);
+	lastTicks = timerTicks();
+	micros = 0;
+	microsFraction = 0;
+	return true;
+}
+
+void timerEnd(){
+	struct TMU_Channel *ch = TMU_GetChannel(TIMER_CHANNEL);
+	TMU_REG_TSTR &= ~(1 << TIMER_CHANNEL);
+	ch->TCR = saved.tcr;
+	ch->TCOR = saved.tcor;
+	ch->TCNT = saved.tcnt;
+	if (saved.started) TMU_REG_TSTR |= 1 << TIMER_CHANNEL;
+}
+
+uint32_t timerMicros(){
+	uint32_t now = timerTicks();
+	uint32_t delta = now - lastTicks;
+	lastTicks = now;
+	//delta * usPerTick, the fraction is kept so nothing gets lost
+	uint64_t us = (uint64_t)delta * usPerTick + microsFraction;
+	microsFraction = (uint32_t)us;
+	micros += (uint32_t)(us >> 32);
+	return micros;
+}
+
+void sleepUntil(uint32_t time){
+	while ((int32_t)(timerMicros() - time) < 0);
+}
+
+void sleepMicros(uint32_t us){
+	sleepUntil(timerMicros() + us);
+}
+
+void frameStatsReset(FrameStats &stats){
+	stats.min = 0xFFFFFFFF;
+	stats.max = 0;
+	stats.total = 0;
+	stats.count = 0;
+}
+
+uint32_t frameStatsAverage(const FrameStats &stats){
+	return stats.count ? udiv32(stats.total, stats.count) : 0;
+}
+
+void pacerInit(FramePacer &pacer, uint32_t period){
+	pacer.period = period;
+	pacer.lastFrame = timerMicros();
+	pacer.next = pacer.lastFrame + period;
+	pacer.maxSteps = 5;
+	frameStatsReset(pacer.stats);
+}
+
+int pacerWait(FramePacer &pacer){
+	sleepUntil(pacer.next);
+	uint32_t now = timerMicros();
+
+	//every period that has passed is one step
+	int steps = 0;
+	while ((int32_t)(now - pacer.next) >= 0 && steps < pacer.maxSteps){
+		pacer.next += pacer.period;
+		steps++;
+	}
+	if ((int32_t)(now - pacer.next) >= 0) //still behind: drop the rest
+		pacer.next = now + pacer.period;
+
+	uint32_t frame = now - pacer.lastFrame;
+	pacer.lastFrame = now;
+	FrameStats &stats = pacer.stats;
+	if (frame < stats.min) stats.min = frame;
+	if (frame > stats.max) stats.max = frame;
+	stats.total += frame;
+	stats.count++;
+	return steps;
+}
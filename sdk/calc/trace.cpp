@@ -0,0 +1,121 @@
+#include <sdk/calc/trace.hpp>
+#include <sdk/os/file.hpp>
+#include <sdk/os/mem.hpp>
+#include <sdk/os/serial.hpp>
+
+TraceRing traceRing;
+static const char *names[TRACE_MAX_NAMES];
+
+bool traceInit(int records){
+	traceFree();
+	if (records <= 0 || (records & (records-1))) return false;
+	traceRing.records = (TraceRecord*)malloc(records * sizeof(TraceRecord));
+	if (traceRing.records == nullptr) return false;
+	traceRing.mask = records - 1;
+	traceRing.next = 0;
+	return true;
+}
+
+void traceFree(){
+	if (traceRing.records != nullptr) free(traceRing.records);
+	traceRing.records = nullptr;
+	traceRing.mask = 0;
+	traceRing.next = 0;
+}
+
+void traceClear(){
+	traceRing.next = 0;
+}
+
+void traceName(int id, const char *name){
+	if (id >= 0 && id < TRACE_MAX_NAMES) names[id] = name;
+}
+
+//Same as in profiler.cpp: the stream is collected in a small buffer and written in blocks
+typedef void (*TraceWriter)(const uint8_t *data, int length, int fd);
+
+struct TraceOutput {
+	uint8_t buffer[64];
+	int length;
+	TraceWriter write;
+	int fd;
+};
+
+static void putBytes(TraceOutput &out, const void *data, int length){
+	const uint8_t *bytes = (const uint8_t*)data;
+	while (length > 0){
+		if (out.length == (int)sizeof(out.buffer)){
+			out.write(out.buffer, out.length, out.fd);
+			out.length = 0;
+		}
+		int chunk = sizeof(out.buffer) - out.length;
+		if (chunk > length) chunk = length;
+		memcpy(out.buffer + out.length, bytes, chunk);
+		out.length += chunk;
+		bytes += chunk;
+		length -= chunk;
+	}
+}
+
+static void putWord(TraceOutput &out, uint32_t word){
+	uint8_t bytes[4] = {(uint8_t)(word >> 24), (uint8_t)(word >> 16), (uint8_t)(word >> 8), (uint8_t)word};
+	putBytes(out, bytes, 4);
+}
+
+static void sendTrace(TraceWriter write, int fd){
+	TraceOutput out;
+	out.length = 0;
+	out.write = write;
+	out.fd = fd;
+
+	uint32_t size = traceRing.records != nullptr ? traceRing.mask + 1 : 0;
+	uint32_t count = traceRing.next < size ? traceRing.next : size;
+	putWord(out, ('T' << 24) | ('R' << 16) | ('C' << 8) | 'E');
+	putWord(out, 1);
+	putWord(out, timerRate());
+	putWord(out, count);
+	for (uint32_t i = traceRing.next - count; i != traceRing.next; i++){
+		const TraceRecord &record = traceRing.records[i & traceRing.mask];
+		putWord(out, record.ticks);
+		putWord(out, (record.id << 16) | (record.type << 8) | record.value);
+	}
+
+	uint32_t named = 0;
+	for (int id=0; id<TRACE_MAX_NAMES; id++)
+		if (names[id] != nullptr) named++;
+	putWord(out, named);
+	for (int id=0; id<TRACE_MAX_NAMES; id++){
+		if (names[id] == nullptr) continue;
+		int length = 0;
+		while (names[id][length]) length++;
+		putWord(out, (id << 16) | length);
+		putBytes(out, names[id], length);
+		const uint8_t padding[3] = {0, 0, 0};
+		putBytes(out, padding, -length & 3);
+	}
+	write(out.buffer, out.length, fd);
+}
+
+static void writeSerial(const uint8_t *data, int length, int fd [[maybe_unused]]){
+	//2 means the transmit buffer is full, wait until there's space
+	while (Serial_Write(data, length) == 2);
+}
+
+static void writeFile(const uint8_t *data, int length, int fd){
+	write(fd, data, length);
+}
+
+void traceSendSerial(){
+	if (!Serial_IsOpen()){
+		unsigned char mode[6] = {0, 9, 0, 0, 0, 0}; //115200 baud, 8N1
+		Serial_Open(mode);
+	}
+	sendTrace(writeSerial, 0);
+}
+
+bool traceSaveFile(const char *path){
+	int fd = open(path, OPEN_WRITE | OPEN_CREATE);
+	if (fd < 0) return false;
+	sendTrace(writeFile, fd);
+	return close(fd) >= 0;
+}
@@ -0,0 +1,101 @@
+#include <sdk/calc/calc.hpp>
+#include <sdk/calc/div.hpp>
+#include <sdk/calc/surface.hpp>
+#include <sdk/calc/onchip.hpp>
+
+//The rasterizer is rasterizeTriangle() in surface.hpp, these draw into the vram with it.
+//The shaded and textured ones are HOT_CODE: rasterizeTriangle(), the spans and Gradient::at() are inlined into them,
+//so the loops over the rows and pixels run from the IL RAM. Only the setup (muldiv(), floorDiv()) is called in .text.
+
+namespace {
+
+//A value that changes linearly over the triangle (a color channel or a texture coordinate).
+//value(x,y) = base + dx*(x-x0) + dy*(y-y0), in 16.16 fixed point.
+struct Gradient {
+	int x0, y0;
+	uint32_t base;
+	int32_t dx, dy;
+
+	//only the setup, kept out of the HOT_CODE functions (see above)
+	__attribute__((noinline)) void init(int px0, int py0, int a0, int px1, int py1, int a1, int px2, int py2, int a2, int area){
+		x0 = px0;
+		y0 = py0;
+		int e1x = px1-px0, e1y = py1-py0;
+		int e2x = px2-px0, e2y = py2-py0;
+		int da1 = a1-a0, da2 = a2-a0;
+		dx = muldiv(da1*e2y - da2*e1y, 1<<16, area);
+		dy = muldiv(da2*e1x - da1*e2x, 1<<16, area);
+		//+0.5, so the >>16 rounds. Pixels inside the triangle then never end up outside of a0..a2.
+		base = ((uint32_t)a0 << 16) + 0x8000;
+	}
+	//The value at (x,y). Uses unsigned math: the single terms can overflow, the sum is correct.
+	ALWAYS_INLINE uint32_t at(int x, int y) const {
+		return base + (uint32_t)dx*(uint32_t)(x-x0) + (uint32_t)dy*(uint32_t)(y-y0);
+	}
+};
+
+}
+
+static inline int area2(int x0, int y0, int x1, int y1, int x2, int y2){
+	return (x1-x0)*(y2-y0) - (x2-x0)*(y1-y0);
+}
+
+void fillTriangle(int x0, int y0, int x1, int y1, int x2, int y2, uint16_t color){
+	surfaceFillTriangle(screenSurface(), x0, y0, x1, y1, x2, y2, color);
+}
+
+HOT_CODE void triangleGouraud(int x0, int y0, uint16_t c0, int x1, int y1, uint16_t c1, int x2, int y2, uint16_t c2){
+	int area = area2(x0, y0, x1, y1, x2, y2);
+	if (area == 0) return;
+
+	//interpolate the 5/6/5 bit channels separately
+	Gradient r, g, b;
+	r.init(x0, y0, c0 >> 11,        x1, y1, c1 >> 11,        x2, y2, c2 >> 11,        area);
+	g.init(x0, y0, (c0 >> 5) & 0x3F, x1, y1, (c1 >> 5) & 0x3F, x2, y2, (c2 >> 5) & 0x3F, area);
+	b.init(x0, y0, c0 & 0x1F,       x1, y1, c1 & 0x1F,       x2, y2, c2 & 0x1F,       area);
+
+	rasterizeTriangle(width, height, &dirty, x0, y0, x1, y1, x2, y2, [&r, &g, &b](int y, int xs, int xe) ALWAYS_INLINE {
+		uint32_t cr = r.at(xs, y), cg = g.at(xs, y), cb = b.at(xs, y);
+		uint16_t *p = vram + width*y + xs;
+		for (int i=xe-xs; i>0; i--){
+			*p++ = ((cr >> 16) << 11) | ((cg >> 16) << 5) | (cb >> 16);
+			cr += r.dx;
+			cg += g.dx;
+			cb += b.dx;
+		}
+	});
+}
+
+HOT_CODE void triangleTextured(int x0, int y0, int u0, int v0, int x1, int y1, int u1, int v1, int x2, int y2, int u2, int v2, const Texture &texture){
+	int area = area2(x0, y0, x1, y1, x2, y2);
+	if (area == 0) return;
+
+	//width is a power of two: the row offset is a shift, the coordinates wrap with a mask
+	int shift = 0;
+	while ((1 << shift) < texture.width) shift++;
+	uint32_t uMask = texture.width - 1;
+	uint32_t vMask = texture.height - 1;
+	const uint16_t *pixels = texture.pixels;
+
+	Gradient u, v;
+	u.init(x0, y0, u0, x1, y1, u1, x2, y2, u2, area);
+	v.init(x0, y0, v0, x1, y1, v1, x2, y2, v2, area);
+
+	rasterizeTriangle(width, height, &dirty, x0, y0, x1, y1, x2, y2, [&u, &v, shift, uMask, vMask, pixels](int y, int xs, int xe) ALWAYS_INLINE {
+		uint32_t tu = u.at(xs, y), tv = v.at(xs, y);
+		uint16_t *p = vram + width*y + xs;
+		for (int i=xe-xs; i>0; i--){
+			*p++ = pixels[(((tv >> 16) & vMask) << shift) | ((tu >> 16) & uMask)];
+			tu += u.dx;
+			tv += v.dx;
+		}
+	});
+}
+
+//Draw a filled triangle with an outline.
+void triangle(int x0, int y0, int x1, int y1, int x2, int y2, uint16_t colorFill, uint16_t colorLine){
+	fillTriangle(x0, y0, x1, y1, x2, y2, colorFill);
+	line(x0,y0,x1,y1,colorLine);
+	line(x1,y1,x2,y2,colorLine);
+	line(x2,y2,x0,y0,colorLine);
+}
@@ -0,0 +1,4 @@
+#include <sdk/calc/xip.hpp>
+
+//The app template's start.s puts the real one into the header, this one is for apps without it (like the demos)
+__attribute__((weak)) uintptr_t xipBase = 0;
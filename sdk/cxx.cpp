@@ -1,26 +1,57 @@
 #include <stddef.h>
+#include <sdk/calc/alloc.hpp>
+#include <sdk/calc/heap.hpp>
 #include <sdk/os/mem.hpp>
 
-void *operator new(size_t size) {
+//While an ArenaScope is active, new takes the memory from its arena (see sdk/calc/alloc.hpp)
+//caller is the call site of new, for the heap report of a HEAP_DEBUG build
+static void *allocate(size_t size, void *caller [[maybe_unused]]) {
+    if (newArena != nullptr) {
+        void *p = arenaAlloc(*newArena, size);
+        if (p != nullptr) return p;
+    }
+#ifdef HEAP_DEBUG
+    return heapAlloc(size, caller);
+#else
     return malloc(size);
+#endif
+}
+
+//Memory from an arena is freed all at once with arenaReset()
+static void release(void *p) {
+    if (p == nullptr || arenaFind(p) != nullptr) return;
+    free(p);
+}
+
+//Both return nullptr without memory, only the std::nothrow one may be checked for it (see sdk/calc/alloc.hpp)
+void *operator new(size_t size) {
+    return allocate(size, __builtin_return_address(0));
 }
 
 void *operator new[](size_t size) {
-    return malloc(size);
+    return allocate(size, __builtin_return_address(0));
+}
+
+void *operator new(size_t size, const std::nothrow_t &) noexcept {
+    return allocate(size, __builtin_return_address(0));
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) noexcept {
+    return allocate(size, __builtin_return_address(0));
 }
 
 void operator delete(void *p) {
-    free(p);
+    release(p);
 }
 
 void operator delete(void *p, size_t size [[maybe_unused]]) {
-    free(p);
+    release(p);
 }
 
 void operator delete[](void *p) {
-    free(p);
+    release(p);
 }
 
 void operator delete[](void *p, size_t size [[maybe_unused]]) {
-    free(p);
+    release(p);
 }
@@ -0,0 +1,120 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+//Allocators
+//malloc() from the OS is slow and crashes the app if there isn't enough memory. These take one big block
+//(from malloc() or a buffer you give them) and hand out parts of it, returning nullptr when they are full.
+//
+//Arena: allocations just move a pointer forward. Nothing is freed on its own, arenaReset() frees everything
+//allocated after a mark at once (good for temporary data that is thrown away every frame).
+//Pool: blocks of one size, allocated and freed in any order in O(1).
+
+struct Arena {
+	uint8_t *base;
+	uint32_t size;
+	uint32_t used;
+	void *allocation;	//what malloc() returned, nullptr for a buffer from the app
+	Arena *next;		//list of all arenas, so operator delete can tell if a pointer is from one of them
+};
+
+//Allocates size bytes with malloc() for the arena
+bool arenaInit(Arena &arena, uint32_t size);
+//Uses buffer for the arena
+void arenaInitBuffer(Arena &arena, void *buffer, uint32_t size);
+void arenaFree(Arena &arena);
+
+//Returns nullptr if the arena is full. align has to be a power of two.
+void *arenaAlloc(Arena &arena, uint32_t size, uint32_t align = 4);
+
+//arenaReset(arena, mark) frees everything allocated after arenaMark() returned mark
+inline uint32_t arenaMark(const Arena &arena){
+	return arena.used;
+}
+inline void arenaReset(Arena &arena, uint32_t mark = 0){
+	if (mark < arena.used) arena.used = mark;
+}
+inline bool arenaContains(const Arena &arena, const void *p){
+	return (const uint8_t*)p >= arena.base && (const uint8_t*)p < arena.base + arena.size;
+}
+
+//The arena p was allocated from, nullptr if it's not from any arena
+Arena *arenaFind(const void *p);
+
+struct Pool {
+	uint8_t *memory;
+	void *freeList;		//the free blocks, every one holds a pointer to the next
+	uint32_t blockSize;
+	uint32_t count;
+	void *allocation;
+};
+
+//Allocates count blocks of blockSize bytes (rounded up to a multiple of 4) with malloc()
+bool poolInit(Pool &pool, uint32_t blockSize, uint32_t count);
+void poolFree(Pool &pool);
+
+//Returns nullptr if all blocks are used
+inline void *poolAlloc(Pool &pool){
+	void *block = pool.freeList;
+	if (block != nullptr) pool.freeList = *(void**)block;
+	return block;
+}
+inline void poolRelease(Pool &pool, void *block){
+	if (block == nullptr) return;
+	*(void**)block = pool.freeList;
+	pool.freeList = block;
+}
+
+//operator new
+//While an ArenaScope exists, new (and new[]) allocate from its arena (and fall back to malloc() when it's full).
+//delete doesn't do anything for memory from an arena, it's freed with arenaReset() or arenaFree().
+//
+//  {
+//      ArenaScope scope(frameArena);
+//      ...everything allocated with new here comes from frameArena...
+//  }
+
+extern Arena *newArena; //the arena of the innermost ArenaScope, nullptr if there is none
+
+class ArenaScope {
+public:
+	ArenaScope(Arena &arena) : m_previous(newArena) {
+		newArena = &arena;
+	}
+	~ArenaScope() {
+		newArena = m_previous;
+	}
+	ArenaScope(const ArenaScope &) = delete;
+	ArenaScope &operator=(const ArenaScope &) = delete;
+
+private:
+	Arena *m_previous;
+};
+
+//Plain new T(...) returns nullptr without memory too, but it isn't noexcept so the compiler may drop a check
+//of its result. Use new (std::nothrow) T(...) where nullptr has to be handled.
+#if __has_include(<new>)
+#include <new>
+#else
+namespace std {
+	struct nothrow_t { explicit nothrow_t() = default; };
+	inline constexpr nothrow_t nothrow{};
+}
+#endif
+void *operator new(size_t size, const std::nothrow_t &) noexcept;
+void *operator new[](size_t size, const std::nothrow_t &) noexcept;
+
+//new (arena) T(...) and new (pool) T(...) return nullptr (and don't call the constructor) if there is no space left
+inline void *operator new(size_t size, Arena &arena) noexcept {
+	return arenaAlloc(arena, size);
+}
+inline void *operator new[](size_t size, Arena &arena) noexcept {
+	return arenaAlloc(arena, size);
+}
+inline void *operator new(size_t size, Pool &pool) noexcept {
+	return size <= pool.blockSize ? poolAlloc(pool) : nullptr;
+}
+//Only used if a constructor throws, which can't happen without exceptions
+inline void operator delete(void *, Arena &) noexcept {}
+inline void operator delete[](void *, Arena &) noexcept {}
+inline void operator delete(void *p, Pool &pool) noexcept { poolRelease(pool, p); }
@@ -0,0 +1,42 @@
+#pragma once
+#include <stdint.h>
+
+//Double buffering
+//backBufferInit() allocates an off-screen buffer and points the global vram at it, so
+//setPixel(), line(), triangle(), fillScreen() etc. draw into it instead of the OS vram.
+//backBufferPresent() copies it into the OS vram with the DMA controller in the background.
+//
+//  backBufferInit(false);
+//  while(running){
+//      backBufferWait();	//with only one buffer: it's still being copied
+//      ...draw the frame...
+//      backBufferPresent();	//the copy starts, we can already calculate the next frame
+//      ...game logic...
+//      backBufferRefresh();	//waits for the copy and sends the OS vram to the lcd
+//  }
+//  backBufferEnd();
+//
+//With two buffers the drawing can overlap with the copy as well: backBufferPresent() then
+//switches vram to the other buffer and only backBufferRefresh() has to wait. The other buffer
+//still holds the frame before the last one, so this only works if every frame is drawn completely.
+
+//Allocates one (or two) buffers of width*height pixels. They start with the content of the OS vram.
+//Call calcInit() first. Returns false if the memory could not be allocated.
+bool backBufferInit(bool twoBuffers);
+
+//Starts copying the buffer vram points to into the OS vram.
+void backBufferPresent();
+
+//Sends the buffer vram points to straight to the lcd with the DMA controller (see lcdc.hpp) instead,
+//without the copy into the OS vram and without LCD_Refresh(). With two buffers vram switches to the
+//other one like with backBufferPresent(). The OS vram keeps what it had.
+void backBufferSend();
+
+//Waits until the copy started by backBufferPresent() (or backBufferSend()) is done.
+void backBufferWait();
+
+//Waits until the copy is done and calls LCD_Refresh().
+void backBufferRefresh();
+
+//Waits for the copy, frees the buffers and points vram back to the OS vram.
+void backBufferEnd();
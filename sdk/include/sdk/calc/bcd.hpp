@@ -0,0 +1,51 @@
+#pragma once
+#include <stdint.h>
+#include <sdk/os/mcs.hpp>
+
+//OBCD <-> binary conversion
+//An OBCD (see sdk/os/mcs.hpp) has two digits in every byte of its mantissa, so these go through the mantissa a
+//byte (two digits) at a time with tables instead of a digit at a time with GET_BCD_DIGIT. Both directions are
+//exact for every int32_t and int64_t: int64ToOBCD() and then obcdToInt64() gives back the same number.
+//Numbers with a fraction are rounded towards zero, numbers that don't fit are saturated.
+//(The fixed point conversions are fixToOBCD() and fixFromOBCD() in fixed.hpp, which use these tables too.)
+
+//Tables, computed by the compiler
+struct BcdTable {
+	uint8_t v[256];
+};
+
+constexpr BcdTable makeBcdPackTable(){
+	BcdTable t{};
+	for (int i=0; i<100; i++)
+		t.v[i] = ((i / 10) << 4) | (i % 10);
+	return t;
+}
+constexpr BcdTable makeBcdUnpackTable(){
+	BcdTable t{};
+	for (int i=0; i<256; i++)
+		t.v[i] = (i >> 4) * 10 + (i & 15);
+	return t;
+}
+
+inline constexpr BcdTable bcdPackTable = makeBcdPackTable();	//0..99 to its two digits (the first 100 entries)
+inline constexpr BcdTable bcdUnpackTable = makeBcdUnpackTable();	//two digits to 0..99
+
+//The exponent without the bias (10^e), and the sign
+inline int obcdExponent(const OBCD &bcd){
+	return ((bcd.exponent >> 8) & 0xF) * 100 + bcdUnpackTable.v[bcd.exponent & 0xFF] - OBCD_EXPONENT_BIAS;
+}
+inline bool obcdNegative(const OBCD &bcd){
+	return bcd.exponent & OBCD_NEGATIVE;
+}
+void obcdSetExponent(OBCD &bcd, int e, bool negative);
+
+//The value of count (at most 9) digits of the mantissa, starting with digit first (0 is the most significant)
+uint32_t obcdDigits(const OBCD &bcd, int first, int count);
+//Sets the mantissa to the n digits (0 to 9 each, most significant first, at most OBCD_DIGITS are used) and
+//the exponent to e. No digits (or only zeros) makes it 0.
+void obcdSetDigits(OBCD &bcd, const uint8_t *digits, int n, int e, bool negative);
+
+void int32ToOBCD(int32_t value, OBCD &bcd);
+int32_t obcdToInt32(const OBCD &bcd);
+void int64ToOBCD(int64_t value, OBCD &bcd);
+int64_t obcdToInt64(const OBCD &bcd);
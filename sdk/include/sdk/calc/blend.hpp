@@ -0,0 +1,73 @@
+#pragma once
+#include <stdint.h>
+#include <sdk/calc/blit.hpp>
+
+//Blending, gradients and dithering for RGB565
+//The kernels split a 32 bit word of two pixels with the mask 0x07E0F81F into two words that have a gap above every
+//channel. One multiplication then scales three channels at once, and the sums carry into the gaps instead of into the
+//next channel: two pixels take four multiplications instead of twelve.
+//
+//  blendRect(0, 0, width, 40, color(0, 0, 0), BLEND_OPAQUE / 2);	//darken the top of the plot by half
+//  gradientRect(0, 40, width, 100, color(0, 0, 255), color(0, 0, 64), GRADIENT_VERTICAL);
+//  blendBitmap(ghost, x, y, 12);
+//
+//alpha goes from 0 (only the destination) to BLEND_OPAQUE (only the source). The span kernels don't clip and work on any
+//buffer, the functions with a position draw into the vram, clipped, and mark the area dirty.
+
+const int BLEND_OPAQUE = 32;
+
+//The green of the first pixel and red and blue of the second one of a pair. For a single pixel spread over 32 bits
+//(blendSpread()) it's green in the upper half and red and blue in the lower one.
+const uint32_t BLEND_SPLIT = 0x07E0F81F;
+
+inline uint32_t blendSpread(uint16_t color){
+	return (color | (uint32_t)color << 16) & BLEND_SPLIT;
+}
+inline uint16_t blendPack(uint32_t spread){
+	spread &= BLEND_SPLIT;
+	return spread | spread >> 16;
+}
+
+//One pixel: dst*(32-alpha)/32 + src*alpha/32 for every channel
+inline uint16_t blendColor(uint16_t dst, uint16_t src, int alpha){
+	return blendPack((blendSpread(src) * alpha + blendSpread(dst) * (BLEND_OPAQUE - alpha)) >> 5);
+}
+
+//One pixel: dst + src for every channel, saturated at the maximum
+inline uint16_t addColor(uint16_t dst, uint16_t src){
+	uint32_t sum = blendSpread(dst) + blendSpread(src);
+	uint32_t carry = sum & 0x08010020;	//the bits above green, red and blue
+	return blendPack(sum | (carry - (carry >> 5)) | (carry - (carry >> 6)));
+}
+
+//Span kernels: count pixels starting at dst, no clipping
+void blendSpan(uint16_t *dst, const uint16_t *src, int count, int alpha);	//src over dst with one alpha
+void blendFillSpan(uint16_t *dst, int count, uint16_t color, int alpha);	//color over dst with one alpha
+void addSpan(uint16_t *dst, const uint16_t *src, int count);			//dst + src, saturated
+//color over dst with an alpha of 0 to 255 for every pixel (e.g. an antialiased shape)
+void blendMaskSpan(uint16_t *dst, uint16_t color, const uint8_t *alpha, int count);
+
+//From c0 at dst[0] to c1 at dst[count-1]
+void gradientSpan(uint16_t *dst, int count, uint16_t c0, uint16_t c1);
+
+//RGB888 (3 bytes per pixel, red first) to RGB565 with a 4x4 ordered dither, instead of just dropping the low bits.
+//(x, y) is where the pixel is on the screen, so the pattern stays in place.
+uint16_t ditherColor(uint8_t r, uint8_t g, uint8_t b, int x, int y);
+void ditherSpan(uint16_t *dst, const uint8_t *rgb, int count, int x, int y);
+
+//The vram versions
+void blendRect(int x, int y, int w, int h, uint16_t color, int alpha);
+//alpha has w*h values, row by row
+void blendMask(int x, int y, int w, int h, uint16_t color, const uint8_t *alpha);
+void blendBitmap(const Bitmap &bitmap, int x, int y, int alpha);
+void addBitmap(const Bitmap &bitmap, int x, int y);
+
+enum GradientDirection {
+	GRADIENT_HORIZONTAL,	//c0 in the left column, c1 in the right one
+	GRADIENT_VERTICAL,	//c0 in the top row, c1 in the bottom one
+};
+//The whole rectangle gets the gradient, the clipping only cuts parts of it off
+void gradientRect(int x, int y, int w, int h, uint16_t c0, uint16_t c1, GradientDirection direction);
+
+//w*h RGB888 pixels, row by row
+void ditherImage(int x, int y, int w, int h, const uint8_t *rgb);
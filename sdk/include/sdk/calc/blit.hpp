@@ -0,0 +1,93 @@
+#pragma once
+#include <stdint.h>
+#include <sdk/calc/calc.hpp>
+#include <sdk/cpu/cache.hpp>
+
+//Drawing images (sprites) into the vram
+//Use tools/png2sprite.py to turn a png into a header with a Bitmap or an RleSprite (see app_template/Makefile).
+
+//An uncompressed image, row by row
+struct Bitmap {
+	int width, height;
+	const uint16_t *pixels;
+};
+
+//An image with transparent parts, stored as runs of visible pixels. Transparent pixels aren't stored at all,
+//blitRle() skips them without looking at them.
+//data contains for every row: the number of runs, then for every run: the number of transparent pixels
+//before it, the number of pixels in it and the pixels.
+struct RleSprite {
+	int width, height;
+	const uint16_t *data;
+};
+
+//Flags for blit() and blitRect(), combine them with |
+enum BlitFlags {
+	BLIT_OPAQUE = 0,  //copy every pixel
+	BLIT_KEYED  = 1,  //don't draw pixels that have the key color
+	BLIT_FLIP_X = 2,  //mirror horizontally
+	BLIT_FLIP_Y = 4,  //mirror vertically
+};
+
+//The color png2sprite.py uses for transparent pixels in a Bitmap
+const uint16_t BLIT_DEFAULT_KEY = 0xF81F; //magenta
+
+//Draw the part (srcX, srcY, w, h) of bitmap with its top left corner at (x, y).
+//The flags are a template parameter, so every combination gets its own inner loop without any checks of the flags.
+template<int Flags>
+void blitRect(const Bitmap &bitmap, int x, int y, int srcX, int srcY, int w, int h, uint16_t key = BLIT_DEFAULT_KEY){
+	//clip the source rectangle to the bitmap
+	if (srcX<0) { w+=srcX; x-=srcX; srcX=0; }
+	if (srcY<0) { h+=srcY; y-=srcY; srcY=0; }
+	if (srcX+w>bitmap.width)  w=bitmap.width-srcX;
+	if (srcY+h>bitmap.height) h=bitmap.height-srcY;
+
+	//clip the destination to the screen. i0..i1 and j0..j1 are the visible columns/rows of the rectangle
+	int i0 = x<0 ? -x : 0;
+	int j0 = y<0 ? -y : 0;
+	int i1 = x+w>width  ? width-x  : w;
+	int j1 = y+h>height ? height-y : h;
+	if (i0>=i1 || j0>=j1) return;
+	markDirty(x+i0, y+j0, x+i1-1, y+j1-1);
+
+	//column i of the rectangle comes from column srcX+i of the bitmap (srcX+w-1-i when flipped)
+	const int stepX = (Flags & BLIT_FLIP_X) ? -1 : 1;
+	const int stepY = (Flags & BLIT_FLIP_Y) ? -bitmap.width : bitmap.width;
+	const uint16_t *srcRow = bitmap.pixels
+		+ bitmap.width * ((Flags & BLIT_FLIP_Y) ? srcY+h-1-j0 : srcY+j0)
+		+ ((Flags & BLIT_FLIP_X) ? srcX+w-1-i0 : srcX+i0);
+	uint16_t *dstRow = vram + width*(y+j0) + x+i0;
+	int count = i1-i0;
+
+	for (int j=j1-j0; j>0; j--){
+		const uint16_t *s = srcRow;
+		uint16_t *d = dstRow;
+		for (int i=count; i>0; ){
+			//the same pixels of the next row, a cache line (16 pixels) at a time, so it's in the cache when we get there
+			CACHE_Prefetch(s + stepY);
+			int n = i < 16 ? i : 16;
+			i -= n;
+			for (; n>0; n--){
+				uint16_t c = *s;
+				if (Flags & BLIT_KEYED){
+					if (c != key) *d = c;
+				}else{
+					*d = c;
+				}
+				s += stepX;
+				d++;
+			}
+		}
+		srcRow += stepY;
+		dstRow += width;
+	}
+}
+
+//Draw the whole bitmap with its top left corner at (x, y)
+template<int Flags>
+void blit(const Bitmap &bitmap, int x, int y, uint16_t key = BLIT_DEFAULT_KEY){
+	blitRect<Flags>(bitmap, x, y, 0, 0, bitmap.width, bitmap.height, key);
+}
+
+//Draw the sprite with its top left corner at (x, y), clipped to the screen
+void blitRle(const RleSprite &sprite, int x, int y);
@@ -0,0 +1,27 @@
+#pragma once
+#include <stdint.h>
+
+//UBC breakpoints that call a function and continue
+//breakpointInstall() points DBR at a handler that calls callback every time a UBC channel breaks, then
+//the program continues where it was. The channels are set up with the registers in sdk/cpu/ubc.hpp, or
+//with breakpointSet() for a break after an instruction was executed. Used by the profiler and the hit counter.
+//The callback runs with interrupts blocked: keep it short and don't call the OS.
+//breakpointUninstall() before the app exits, the handler is part of the app.
+
+//pc: where the program continues, pr: its pr (the return address in the first instruction of a function),
+//channels: bit n is set if channel n matched (UBC_REG_CCMFR)
+typedef void (*BreakpointCallback)(uint32_t pc, uint32_t pr, uint32_t channels);
+
+//in breakpointHandler.s
+extern "C" void breakpointHandler();
+extern "C" BreakpointCallback breakpointCallback;
+
+//Saves DBR and CBCR and installs the handler
+void breakpointInstall(BreakpointCallback callback);
+//Disables both channels and restores DBR and CBCR
+void breakpointUninstall();
+
+//Breaks on channel (0 or 1) after an instruction whose address matches address is executed.
+//The bits set in mask aren't compared, so mask = size-1 covers a range of size bytes.
+void breakpointSet(int channel, uint32_t address, uint32_t mask);
+void breakpointClear(int channel);
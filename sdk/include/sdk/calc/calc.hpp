@@ -11,18 +11,80 @@ extern int width;	//width  of the screen
 extern int height;	//height of the screen
 
 void line(int x1, int y1, int x2, int y2, uint16_t color);
-void triangle(int x0, int y0, int x1, int y1, int x2, int y2, uint16_t colorFill, uint16_t colorLine);
 void fillScreen(uint16_t color);
 
+//Span primitives. These clip once per call and then write pairs of pixels as 32 bit words.
+void hline(int x1, int x2, int y, uint16_t color);	//horizontal line from x1 to x2 (both inclusive)
+void vline(int x, int y1, int y2, uint16_t color);	//vertical line from y1 to y2 (both inclusive)
+void fillRect(int x, int y, int w, int h, uint16_t color);
+void clearRect(int x, int y, int w, int h);		//fill with white, like LCD_ClearScreen() does
+
+//Triangles (filled row by row with the top-left fill rule, so triangles sharing an edge don't overlap)
+void triangle(int x0, int y0, int x1, int y1, int x2, int y2, uint16_t colorFill, uint16_t colorLine); //filled, with an outline
+void fillTriangle(int x0, int y0, int x1, int y1, int x2, int y2, uint16_t color);
+//The colors of the three corners are interpolated over the triangle
+void triangleGouraud(int x0, int y0, uint16_t c0, int x1, int y1, uint16_t c1, int x2, int y2, uint16_t c2);
+
+//A texture for triangleTextured(). width and height have to be powers of two, the coordinates wrap around.
+struct Texture {
+	const uint16_t *pixels;	//width*height pixels, row by row
+	int width, height;
+};
+//(u,v) are the texture coordinates (in texels) of the corners, interpolated linearly (no perspective correction)
+void triangleTextured(int x0, int y0, int u0, int v0, int x1, int y1, int u1, int v1, int x2, int y2, int u2, int v2, const Texture &texture);
+
+//Circles and ellipses around (x, y), drawn with horizontal spans
+void circle(int x, int y, int radius, uint16_t color);
+void fillCircle(int x, int y, int radius, uint16_t color);
+void ellipse(int x, int y, int radiusX, int radiusY, uint16_t color);
+void fillEllipse(int x, int y, int radiusX, int radiusY, uint16_t color);
+
+//Writes count pixels starting at dst. No clipping, dst has to point into a buffer with enough space.
+void fillSpan(uint16_t *dst, int count, uint16_t color);
+
 inline uint16_t color(uint8_t R, uint8_t G, uint8_t B){
 	return	(((R<<8) & 0b1111100000000000) |
 		 ((G<<3) & 0b0000011111100000) |
 		 ((B>>3) & 0b0000000000011111));
 }
 
+//Dirty rectangle tracking
+//All drawing routines in here extend the dirty rectangle once to cover what they changed,
+//LCD_RefreshDirty() then only sends that part of the vram to the lcd.
+//It is one bounding box, so things drawn far apart make it big: refresh them one after the other.
+//If you write to the vram yourself (or use setPixel() or Debug_Print...) call markDirty() for that area.
+
+struct DirtyRect {
+	int x0, y0;	//top left corner (inclusive)
+	int x1, y1;	//bottom right corner (inclusive), the rect is empty if x1 < x0
+};
+extern DirtyRect dirty;
+
+inline void markDirty(int x0, int y0, int x1, int y1){
+	if (x0 < dirty.x0) dirty.x0 = x0;
+	if (y0 < dirty.y0) dirty.y0 = y0;
+	if (x1 > dirty.x1) dirty.x1 = x1;
+	if (y1 > dirty.y1) dirty.y1 = y1;
+}
+inline void markAllDirty(){
+	dirty.x0 = 0; dirty.y0 = 0;
+	dirty.x1 = width-1; dirty.y1 = height-1;
+}
+inline void clearDirty(){
+	dirty.x0 = 0x7FFFFFFF; dirty.y0 = 0x7FFFFFFF;
+	dirty.x1 = -1; dirty.y1 = -1;
+}
+
+//Send only a part of the vram to the lcd (instead of the whole screen like LCD_Refresh())
+void LCD_RefreshRect(int x, int y, int w, int h);
+//Send the dirty rectangle to the lcd and clear it
+void LCD_RefreshDirty();
+
+//Doesn't mark the pixel dirty, scattered pixels would grow the dirty rectangle to the whole screen
 inline void setPixel(int x,int y, uint32_t color) {
-	if(x>=0 && x < width && y>=0 && y < height)
+	if(x>=0 && x < width && y>=0 && y < height){
 		vram[width*y + x] = color;
+	}
 }
 
 //Stuff for Initialisation and stuff
@@ -31,6 +93,7 @@ inline void calcInit(){
 	vram = LCD_GetVRAMAddress();
 	LCD_GetSize(&width, &height);
 	LCD_VRAMBackup();
+	clearDirty();
 }
 inline void calcEnd(){
 	LCD_VRAMRestore();
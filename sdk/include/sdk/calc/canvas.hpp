@@ -0,0 +1,50 @@
+#pragma once
+#include <stdint.h>
+
+//8 bit indexed canvas
+//An off-screen image with one byte per pixel (half the memory of the vram) and a palette of 256 RGB565 colors.
+//Draw into it, then canvasPresent() translates the rows that changed into the vram.
+//Changing the palette changes every pixel of that color at once: call canvasMarkAll() and canvasPresent().
+//
+//  IndexedCanvas canvas;
+//  canvasInit(canvas, width, height);
+//  canvas.palette[1] = color(255, 0, 0);
+//  canvasFillRect(canvas, 10, 10, 20, 20, 1);
+//  canvasPresent(canvas, 0, 0);	//the rows 10 to 29 are expanded and marked dirty
+//  LCD_RefreshDirty();
+
+struct IndexedCanvas {
+	uint8_t *pixels;	//width*height color indices, row by row
+	int width, height;
+	uint16_t palette[256];
+	int dirtyY0, dirtyY1;	//the rows that changed since the last canvasPresent() (inclusive, empty if dirtyY1 < dirtyY0)
+};
+
+//Allocates the pixels (cleared to index 0) and clears the palette to black. Returns false if there isn't enough memory.
+bool canvasInit(IndexedCanvas &canvas, int width, int height);
+void canvasFree(IndexedCanvas &canvas);
+
+inline void canvasMarkRows(IndexedCanvas &canvas, int y0, int y1){
+	if (y0 < canvas.dirtyY0) canvas.dirtyY0 = y0;
+	if (y1 > canvas.dirtyY1) canvas.dirtyY1 = y1;
+}
+inline void canvasMarkAll(IndexedCanvas &canvas){
+	canvas.dirtyY0 = 0;
+	canvas.dirtyY1 = canvas.height-1;
+}
+
+inline void canvasSetPixel(IndexedCanvas &canvas, int x, int y, uint8_t index){
+	if (x>=0 && x<canvas.width && y>=0 && y<canvas.height){
+		canvas.pixels[canvas.width*y + x] = index;
+		canvasMarkRows(canvas, y, y);
+	}
+}
+void canvasFillRect(IndexedCanvas &canvas, int x, int y, int w, int h, uint8_t index);
+void canvasClear(IndexedCanvas &canvas, uint8_t index);
+
+//Expands the dirty rows of the canvas into the vram with the canvas's top left corner at (x, y), clipped to the screen.
+//The changed part of the vram is marked dirty (see markDirty()), so LCD_RefreshDirty() only sends those rows.
+void canvasPresent(IndexedCanvas &canvas, int x, int y);
+
+//Writes count pixels to dst, translated with palette. No clipping.
+void expandIndexed(uint16_t *dst, const uint8_t *src, int count, const uint16_t *palette);
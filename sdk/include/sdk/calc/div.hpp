@@ -0,0 +1,58 @@
+#pragma once
+#include <stdint.h>
+
+//Integer division
+//Apps are linked without libgcc, so a division by a variable (a / b, a % b) doesn't link.
+//These do it with the div1 instruction of the SH4 (one step per quotient bit) instead.
+
+//(hi:lo) / d for a 64 bit numerator, the quotient has to fit into 32 bits (so hi < d).
+inline uint32_t udiv64(uint32_t hi, uint32_t lo, uint32_t d){
+#ifdef __sh__
+	__asm__(
+		"div0u\n"
+		".rept 32\n"
+		"rotcl %1\n"
+		"div1 %2, %0\n"
+		".endr\n"
+		"rotcl %1\n"
+		: "+r"(hi), "+r"(lo)
+		: "r"(d)
+		: "t"
+	);
+	return lo;
+#else
+	return (((uint64_t)hi << 32) | lo) / d;
+#endif
+}
+
+//n / d for 64 bit n, the quotient has to fit into 32 bits (so (n >> 32) < d).
+inline uint32_t udiv64(uint64_t n, uint32_t d){
+	return udiv64((uint32_t)(n >> 32), (uint32_t)n, d);
+}
+
+//n / d, unsigned
+inline uint32_t udiv32(uint32_t n, uint32_t d){
+	return udiv64(0, n, d);
+}
+
+//n / d, signed (rounded towards zero like the / operator)
+inline int32_t sdiv32(int32_t n, int32_t d){
+	uint32_t q = udiv32(n < 0 ? -(uint32_t)n : n, d < 0 ? -(uint32_t)d : d);
+	return (n < 0) != (d < 0) ? -(int32_t)q : (int32_t)q;
+}
+
+//n % d, unsigned
+inline uint32_t umod32(uint32_t n, uint32_t d){
+	return n - udiv32(n, d) * d;
+}
+
+//a * b / c without overflowing in between, rounded to the nearest integer.
+//The result has to fit into 32 bits.
+inline int32_t muldiv(int32_t a, int32_t b, int32_t c){
+	bool negative = ((a < 0) != (b < 0)) != (c < 0);
+	uint32_t ua = a < 0 ? -(uint32_t)a : a;
+	uint32_t ub = b < 0 ? -(uint32_t)b : b;
+	uint32_t uc = c < 0 ? -(uint32_t)c : c;
+	uint32_t q = udiv64((uint64_t)ua * ub + (uc >> 1), uc);
+	return negative ? -(int32_t)q : (int32_t)q;
+}
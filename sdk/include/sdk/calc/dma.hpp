@@ -0,0 +1,21 @@
+#pragma once
+#include <stdint.h>
+
+//Memory to memory copies with the DMA controller.
+//The copy runs in the background, the CPU can do other work until it's finished.
+//Don't touch the source or the destination before dmaWait() returned.
+
+//The DMA channel used by the sdk (the OS might use the lower channels)
+const int DMA_CHANNEL = 5;
+
+//Start copying size bytes from src to dst and return immediately.
+//Uses 32 byte transfers if src, dst and size are 32 byte aligned (smaller units otherwise).
+//The cache of both areas is written back before the transfer starts.
+void dmaCopy(void *dst, const void *src, uint32_t size);
+
+//Start writing count 16 bit words from src to port, a device register that keeps its address (like the data
+//register of the lcd controller, see lcdc.hpp). The cache of src is written back first.
+void dmaWritePort16(volatile uint16_t *port, const uint16_t *src, uint32_t count);
+
+bool dmaBusy();	//true while a transfer started by dmaCopy() (or dmaWritePort16()) is running
+void dmaWait();	//wait until the transfer is done
@@ -0,0 +1,100 @@
+#pragma once
+#include <stdint.h>
+
+//Fibers (cooperative threads)
+//A fiber runs a function on a stack of its own. Only one runs at a time, and it keeps the CPU until it calls
+//fiberYield(), fiberSleep...() or fiberWait(): then the next fiber that can run goes on where it stopped. main() is a
+//fiber too, so an app can load its assets in one fiber while main() keeps drawing frames.
+//Nothing interrupts a fiber: split long work (e.g. reading a big file) into pieces with a fiberYield() in between.
+//
+//  static uint8_t loaderStack[4096];
+//  static Fiber loader;
+//  static void loadLevel(void *arg){
+//      for (int i=0; i<chunks; i++){
+//          ...read one chunk...
+//          fiberYield();
+//      }
+//  }
+//
+//  fiberCreate(loader, loadLevel, nullptr, loaderStack, sizeof(loaderStack));
+//  while (!fiberDone(loader)){
+//      ...draw the loading screen...
+//      fiberSleep(1000000 / 30);	//the loader runs in the meantime
+//  }
+//
+//fiberSleep() and fiberSleepUntil() use timerMicros(), so they need timerInit() first (see timer.hpp).
+//The stacks aren't checked while the fibers run. Calls to the OS need a lot of it, give those fibers a few KiB and
+//look at fiberStackUnused() while testing.
+
+//The registers a function has to keep (r8 to r15, mach, macl, pr), saved by the context switch in fiber.s
+struct FiberContext {
+	uint32_t r[8];	//r8 to r15 (r15 is the stack pointer)
+	uint32_t mach, macl;
+	uint32_t pr;	//where the fiber goes on
+};
+
+struct Fiber;
+
+//Set by one fiber, waited for by others. Stays set until fiberEventClear().
+struct FiberEvent {
+	bool set;
+	Fiber *waiting;	//the fibers in fiberWait(), first come first
+};
+
+enum FiberState {
+	FIBER_READY,	//running or in the run queue
+	FIBER_SLEEPING,
+	FIBER_WAITING,	//for an event
+	FIBER_DONE,
+};
+
+struct Fiber {
+	FiberContext context;
+	void (*function)(void *arg);
+	void *arg;
+	uint8_t *stack;
+	int stackSize;
+	FiberState state;
+	uint32_t wakeTime;	//timerMicros() when it's sleeping
+	Fiber *next;		//in the run queue, the sleep list or the list of an event
+	FiberEvent done;	//set when function returned
+};
+
+//Prepares a fiber that calls function(arg) on stack and puts it at the end of the run queue. It starts the next
+//time the current fiber yields. fiber and stack have to stay there until it's done. A fiber that's done can be
+//created again.
+void fiberCreate(Fiber &fiber, void (*function)(void *arg), void *arg, void *stack, int stackSize);
+
+//The fiber that is running (main() has one as well)
+Fiber *fiberCurrent();
+
+inline bool fiberDone(const Fiber &fiber){
+	return fiber.state == FIBER_DONE;
+}
+
+//Lets the other fibers that are ready run first, then goes on
+void fiberYield();
+//Waits until timerMicros() reaches time (works across the wrap around) and lets the others run in the meantime.
+//If no fiber is ready in between the CPU sleeps (sleepUntil()).
+void fiberSleepUntil(uint32_t time);
+void fiberSleep(uint32_t us);
+
+inline void fiberEventInit(FiberEvent &event){
+	event.set = false;
+	event.waiting = nullptr;
+}
+//Sets the event and puts every fiber that waits for it into the run queue. The current fiber keeps running.
+void fiberEventSet(FiberEvent &event);
+inline void fiberEventClear(FiberEvent &event){
+	event.set = false;
+}
+//Returns at once if the event is set, otherwise the other fibers run until one of them sets it.
+//If every fiber waits and none sleeps, nothing can set it any more: the app hangs.
+void fiberWait(FiberEvent &event);
+//Waits until fiber is done
+inline void fiberJoin(Fiber &fiber){
+	fiberWait(fiber.done);
+}
+
+//The number of bytes at the bottom of the stack that were never used yet
+int fiberStackUnused(const Fiber &fiber);
@@ -0,0 +1,327 @@
+#pragma once
+#include <stdint.h>
+#include <sdk/calc/bcd.hpp>
+#include <sdk/calc/div.hpp>
+#include <sdk/os/mcs.hpp>
+
+//Fixed point math
+//The sdk is built without the fpu (-m4-nofpu), so every float operation is a call to a slow software routine.
+//Fixed<Raw, FracBits> is a number stored as an integer with FracBits bits after the binary point:
+//fix16 (Q16.16) has 16 bits for the integer part and 16 for the fraction, fix8 (Q8.8) 8 and 8 in 16 bits.
+//Everything here only uses integer instructions and the division routines from div.hpp.
+//
+//Angles: the tables work with binary angles, a uint16_t where 65536 is a full turn (so they wrap around for free).
+//The fix16 versions (fixSin(), fixAtan2(), ...) take and return radians.
+
+//a * b >> F for 32 bit numbers, without any 64 bit shifts (they would need libgcc)
+template<int F>
+inline int32_t fixedMul32(int32_t a, int32_t b){
+	static_assert(F > 0 && F < 32);
+	int64_t p = (int64_t)a * b;
+	uint32_t hi = (uint64_t)p >> 32;
+	uint32_t lo = (uint32_t)p;
+	return (int32_t)((hi << (32-F)) | (lo >> F));
+}
+
+//(a << F) / b for 32 bit numbers, saturated if the result doesn't fit
+template<int F>
+inline int32_t fixedDiv32(int32_t a, int32_t b){
+	static_assert(F > 0 && F < 32);
+	bool negative = (a < 0) != (b < 0);
+	uint32_t ua = a < 0 ? -(uint32_t)a : a;
+	uint32_t ub = b < 0 ? -(uint32_t)b : b;
+	uint32_t hi = ua >> (32-F);
+	uint32_t lo = ua << F;
+	if (hi >= ub) //includes b == 0
+		return negative ? (int32_t)0x80000000 : 0x7FFFFFFF;
+	uint32_t q = udiv64(hi, lo, ub);
+	if (q > 0x7FFFFFFF)
+		return negative ? (int32_t)0x80000000 : 0x7FFFFFFF;
+	return negative ? -(int32_t)q : (int32_t)q;
+}
+
+template<typename Raw, int FracBits>
+struct Fixed {
+	static_assert(sizeof(Raw) == 2 || sizeof(Raw) == 4);
+	static_assert(FracBits > 0 && FracBits < (int)sizeof(Raw)*8);
+
+	Raw raw;
+
+	static constexpr int FRAC_BITS = FracBits;
+	static constexpr Raw ONE = (Raw)(1 << FracBits);
+
+	static constexpr Fixed fromRaw(Raw r){ return Fixed{r}; }
+	static constexpr Fixed fromInt(int i){ return Fixed{(Raw)((uint32_t)i << FracBits)}; }
+	//Only use this with constants, so the compiler computes it (fix16::fromDouble(0.5)), at run time it's soft float!
+	static constexpr Fixed fromDouble(double d){ return Fixed{(Raw)(d * ONE + (d < 0 ? -0.5 : 0.5))}; }
+	//n / d
+	static Fixed fromRatio(int n, int d){
+		return fromInt(n) / fromInt(d);
+	}
+	//Convert from another fixed point format
+	template<typename R2, int F2>
+	static constexpr Fixed from(Fixed<R2, F2> f){
+		if constexpr (F2 > FracBits) return Fixed{(Raw)(f.raw >> (F2 - FracBits))};
+		else return Fixed{(Raw)((int32_t)f.raw << (FracBits - F2))};
+	}
+
+	constexpr int toInt() const { return raw >> FracBits; } //rounded down
+	constexpr int round() const { return (raw + (1 << (FracBits-1))) >> FracBits; }
+	constexpr Fixed frac() const { return Fixed{(Raw)(raw & (ONE-1))}; }
+	constexpr Fixed abs() const { return Fixed{(Raw)(raw < 0 ? -raw : raw)}; }
+
+	constexpr Fixed operator+(Fixed b) const { return Fixed{(Raw)(raw + b.raw)}; }
+	constexpr Fixed operator-(Fixed b) const { return Fixed{(Raw)(raw - b.raw)}; }
+	constexpr Fixed operator-() const { return Fixed{(Raw)-raw}; }
+	Fixed operator*(Fixed b) const {
+		if constexpr (sizeof(Raw) == 2) return Fixed{(Raw)(((int32_t)raw * b.raw) >> FracBits)};
+		else return Fixed{fixedMul32<FracBits>(raw, b.raw)};
+	}
+	Fixed operator/(Fixed b) const {
+		if constexpr (sizeof(Raw) == 2) return Fixed{(Raw)sdiv32((int32_t)raw << FracBits, b.raw)};
+		else return Fixed{fixedDiv32<FracBits>(raw, b.raw)};
+	}
+	constexpr Fixed operator*(int i) const { return Fixed{(Raw)(raw * i)}; }
+	Fixed operator/(int i) const { return Fixed{(Raw)sdiv32(raw, i)}; }
+	constexpr Fixed operator<<(int s) const { return Fixed{(Raw)(raw << s)}; }
+	constexpr Fixed operator>>(int s) const { return Fixed{(Raw)(raw >> s)}; }
+
+	Fixed &operator+=(Fixed b){ raw += b.raw; return *this; }
+	Fixed &operator-=(Fixed b){ raw -= b.raw; return *this; }
+	Fixed &operator*=(Fixed b){ *this = *this * b; return *this; }
+	Fixed &operator/=(Fixed b){ *this = *this / b; return *this; }
+
+	constexpr bool operator==(Fixed b) const { return raw == b.raw; }
+	constexpr bool operator!=(Fixed b) const { return raw != b.raw; }
+	constexpr bool operator< (Fixed b) const { return raw <  b.raw; }
+	constexpr bool operator<=(Fixed b) const { return raw <= b.raw; }
+	constexpr bool operator> (Fixed b) const { return raw >  b.raw; }
+	constexpr bool operator>=(Fixed b) const { return raw >= b.raw; }
+};
+
+typedef Fixed<int32_t, 16> fix16; //Q16.16
+typedef Fixed<int16_t, 8>  fix8;  //Q8.8
+
+//Tables, computed by the compiler
+//sin of a quarter turn in 256 steps and atan of 0..1 in 256 steps (as a binary angle), one more entry for the interpolation.
+
+struct FixedTable {
+	int32_t v[257];
+};
+
+constexpr double fixedTablePi = 3.14159265358979323846;
+
+//Taylor series, good enough for 0 <= x <= pi/2
+constexpr double fixedTableSin(double x){
+	double term = x, sum = x;
+	for (int n=1; n<12; n++){
+		term *= -x*x / ((2*n) * (2*n+1));
+		sum += term;
+	}
+	return sum;
+}
+
+//atan(x) for 0 <= x <= 1: atan(x) = 2*atan(x / (1 + sqrt(1 + x*x))) brings x below 0.42, then the series
+constexpr double fixedTableSqrt(double x){
+	double r = x > 1 ? x : 1;
+	for (int i=0; i<40; i++) r = (r + x/r) / 2;
+	return r;
+}
+constexpr double fixedTableAtan(double x){
+	double y = x / (1 + fixedTableSqrt(1 + x*x));
+	double term = y, sum = y;
+	for (int n=1; n<30; n++){
+		term *= -y*y;
+		sum += term / (2*n+1);
+	}
+	return 2*sum;
+}
+
+constexpr FixedTable makeFixedSinTable(){
+	FixedTable t{};
+	for (int i=0; i<=256; i++)
+		t.v[i] = (int32_t)(fixedTableSin(i * fixedTablePi / 512) * 65536 + 0.5);
+	return t;
+}
+constexpr FixedTable makeFixedAtanTable(){
+	FixedTable t{};
+	for (int i=0; i<=256; i++)
+		t.v[i] = (int32_t)(fixedTableAtan(i / 256.0) * 65536 / (2*fixedTablePi) + 0.5);
+	return t;
+}
+
+inline constexpr FixedTable fixedSinTable = makeFixedSinTable();   //fix16 raw values, sin(i/256 * pi/2)
+inline constexpr FixedTable fixedAtanTable = makeFixedAtanTable(); //binary angles, atan(i/256)
+
+//Look up x (0..0x4000, 256 steps with 6 bits in between) in a table and interpolate linearly
+inline int32_t fixedTableLookup(const FixedTable &table, uint32_t x){
+	uint32_t i = x >> 6, f = x & 63;
+	if (!f) return table.v[i];
+	return table.v[i] + (((table.v[i+1] - table.v[i]) * (int32_t)f) >> 6);
+}
+
+//sin and cos of a binary angle (65536 is a full turn)
+inline fix16 sinAngle(uint16_t angle){
+	uint32_t x = angle & 0x3FFF;
+	if (angle & 0x4000) x = 0x4000 - x; //second and fourth quarter: mirrored
+	int32_t v = fixedTableLookup(fixedSinTable, x);
+	return fix16::fromRaw(angle & 0x8000 ? -v : v);
+}
+inline fix16 cosAngle(uint16_t angle){
+	return sinAngle(angle + 0x4000);
+}
+
+//The binary angle of the vector (x, y), like atan2(y, x)
+inline uint16_t atan2Angle(int32_t y, int32_t x){
+	if (x == 0 && y == 0) return 0;
+	uint32_t ax = x < 0 ? -(uint32_t)x : x;
+	uint32_t ay = y < 0 ? -(uint32_t)y : y;
+	uint32_t angle;
+	if (ay <= ax){
+		//ay/ax with 14 bits after the point (0..0x4000)
+		angle = fixedTableLookup(fixedAtanTable, udiv64(ay >> 18, ay << 14, ax));
+	}else{
+		angle = 0x4000 - fixedTableLookup(fixedAtanTable, udiv64(ax >> 18, ax << 14, ay));
+	}
+	if (x < 0) angle = 0x8000 - angle;
+	if (y < 0) angle = -angle;
+	return angle;
+}
+
+//Conversion between radians (fix16) and binary angles
+inline uint16_t fixToAngle(fix16 radians){
+	//radians * 65536/(2*pi), the factor in Q16.16 and the result in the upper 32 bits of the product
+	return (uint64_t)((int64_t)radians.raw * 683565276) >> 32;
+}
+inline fix16 angleToFix(uint16_t angle){
+	//2*pi in Q16.16, so this is angle * 2*pi / 65536
+	return fix16::fromRaw(fixedMul32<16>(angle, 411775));
+}
+
+inline fix16 fixSin(fix16 radians){ return sinAngle(fixToAngle(radians)); }
+inline fix16 fixCos(fix16 radians){ return cosAngle(fixToAngle(radians)); }
+//-pi <= result < pi
+inline fix16 fixAtan2(fix16 y, fix16 x){
+	return fix16::fromRaw(fixedMul32<16>((int16_t)atan2Angle(y.raw, x.raw), 411775));
+}
+
+//Integer square root (rounded down)
+inline uint32_t isqrt(uint32_t x){
+	uint32_t root = 0;
+	uint32_t bit = 1u << 30;
+	while (bit > x) bit >>= 2;
+	while (bit){
+		if (x >= root + bit){
+			x -= root + bit;
+			root = (root >> 1) + bit;
+		}else{
+			root >>= 1;
+		}
+		bit >>= 2;
+	}
+	return root;
+}
+
+//Square root of a fixed point number, 0 for negative numbers.
+//Works on the bits two at a time, like isqrt() on raw << FracBits (FracBits has to be even).
+template<typename Raw, int F>
+inline Fixed<Raw, F> fixSqrt(Fixed<Raw, F> value){
+	static_assert((F & 1) == 0);
+	if (value.raw <= 0) return Fixed<Raw, F>::fromRaw(0);
+	uint32_t remHi = 0, remLo = value.raw, root = 0;
+	for (int i=0; i<16+F/2; i++){
+		remHi = (remHi << 2) | (remLo >> 30);
+		remLo <<= 2;
+		root <<= 1;
+		uint32_t test = (root << 1) + 1;
+		if (remHi >= test){
+			remHi -= test;
+			root++;
+		}
+	}
+	return Fixed<Raw, F>::fromRaw(root);
+}
+
+//1 / value (saturated for 0)
+template<typename Raw, int F>
+inline Fixed<Raw, F> fixReciprocal(Fixed<Raw, F> value){
+	return Fixed<Raw, F>::fromInt(1) / value;
+}
+
+//a + (b - a) * t, t from 0 to 1
+template<typename Raw, int F>
+inline Fixed<Raw, F> fixLerp(Fixed<Raw, F> a, Fixed<Raw, F> b, Fixed<Raw, F> t){
+	return a + (b - a) * t;
+}
+
+//OBCD conversion (the format the calculator's math uses, see sdk/os/mcs.hpp), saturated if the number is too big
+
+inline int obcdDigit(const OBCD &bcd, int i){
+	return (bcd.mantissa[i >> 1] >> ((i & 1) ? 0 : 4)) & 0xF;
+}
+
+template<typename Raw, int F>
+inline Fixed<Raw, F> fixFromOBCD(const OBCD &bcd){
+	typedef Fixed<Raw, F> T;
+	int e = obcdExponent(bcd);
+	bool negative = obcdNegative(bcd);
+	const uint32_t maxInt = 1u << (sizeof(Raw)*8 - 1 - F);
+
+	//integer part: the digits 0..e, two at a time (see bcd.hpp). 10 digits never fit: maxInt is at most 2^31
+	uint32_t integer = 0;
+	if (e >= 0){
+		if (e >= 9 || (integer = obcdDigits(bcd, 0, e + 1)) >= maxInt)
+			return T::fromRaw(negative ? (Raw)(1u << (sizeof(Raw)*8 - 1)) : (Raw)((1u << (sizeof(Raw)*8 - 1)) - 1));
+	}
+
+	//fraction: the digits after e, from the last one to the first (Horner), with 28 bits after the point
+	uint32_t frac = 0;
+	if (e > -12){ //anything smaller is 0 anyway
+		int first = e + 1;
+		for (int i=OBCD_DIGITS-1; i>=first && i>=0; i--)
+			frac = (frac + ((uint32_t)obcdDigit(bcd, i) << 28)) / 10;
+		for (int i=first; i<0; i++) //the zeros between the point and the first digit
+			frac /= 10;
+	}
+	uint32_t raw = (integer << F) + ((frac + (1u << (27-F))) >> (28-F));
+	return T::fromRaw((Raw)(negative ? -raw : raw));
+}
+
+template<typename Raw, int F>
+inline void fixToOBCD(Fixed<Raw, F> value, OBCD &bcd){
+	uint32_t u = value.raw < 0 ? 0u - (uint32_t)value.raw : value.raw;
+	uint32_t integer = u >> F;
+	uint32_t frac = u & ((1u << F) - 1);
+
+	//all digits, most significant first: up to 10 integer digits and F fraction digits (that's exact)
+	uint8_t digits[10 + F];
+	int n = 0;
+	{
+		uint8_t reversed[10];
+		int k = 0;
+		for (uint32_t i = integer; i; i /= 10) reversed[k++] = i % 10;
+		while (k) digits[n++] = reversed[--k];
+	}
+	int e = n - 1; //exponent of the first digit
+	for (int i=0; i<F && frac; i++){
+		frac *= 10;
+		digits[n++] = frac >> F;
+		frac &= (1u << F) - 1;
+	}
+
+	//skip the leading zeros of numbers below 1
+	int start = 0;
+	while (start < n && digits[start] == 0){
+		start++;
+		e--;
+	}
+
+	for (int i=0; i<10; i++) bcd.mantissa[i] = 0;
+	if (start == n){ //zero
+		e = 0;
+	}else{
+		for (int i=0; i<OBCD_DIGITS && start+i<n; i++)
+			bcd.mantissa[i >> 1] |= digits[start+i] << ((i & 1) ? 0 : 4);
+	}
+	obcdSetExponent(bcd, e, value.raw < 0);
+}
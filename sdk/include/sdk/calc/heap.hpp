@@ -0,0 +1,49 @@
+#pragma once
+#include <stdint.h>
+
+//Heap instrumentation (only in a HEAP_DEBUG build)
+//Build the SDK and the app with `make HEAP_DEBUG=1`. malloc() and free() (and so new and delete) then go
+//through heapMalloc()/heapFree(), which count the allocations and remember the call site of each one
+//(the return address). At the end of main() call heapReportSerial() or heapReportFile() to see what's
+//still allocated and where it came from (find the function of an address with sh4-elf-addr2line -f -e app.hhk).
+//The OS malloc() crashes the app if there isn't enough memory; stats.peakBytes tells how big your arenas can be.
+//Both the SDK and the app have to be built the same way: memory from one can't be freed by the other.
+
+struct HeapStats {
+	uint32_t liveCount;	//allocations that haven't been freed yet
+	uint32_t liveBytes;
+	uint32_t peakBytes;	//the most liveBytes ever were
+	uint32_t allocs;
+	uint32_t frees;
+	uint32_t badFrees;	//free() of a pointer that didn't come from heapMalloc(), or was freed already
+};
+
+struct HeapSite {
+	void *caller;		//the return address of the malloc()/new call
+	uint32_t allocs;
+	uint32_t frees;
+	uint32_t liveBytes;
+};
+
+//The call sites after the first HEAP_MAX_SITES aren't recorded separately, only in the totals
+const int HEAP_MAX_SITES = 64;
+
+#ifdef HEAP_DEBUG
+
+//malloc() and free() in a HEAP_DEBUG build (see sdk/os/mem.hpp)
+extern "C" void *heapMalloc(uint32_t size);
+extern "C" void heapFree(void *ptr);
+
+//heapMalloc() with the call site given explicitly, for wrappers like operator new
+void *heapAlloc(uint32_t size, void *caller);
+
+const HeapStats &heapStats();
+//Returns the number of sites in *sites
+int heapSites(const HeapSite **sites);
+
+//Writes the stats and all call sites over the serial port (opened with 115200 baud if it isn't open)
+void heapReportSerial();
+//Writes the stats and all call sites to a text file, for example "\\\\fls0\\heap.txt". Returns false if it can't be written.
+bool heapReportFile(const char *path);
+
+#endif
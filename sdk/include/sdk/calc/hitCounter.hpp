@@ -0,0 +1,38 @@
+#pragma once
+#include <stdint.h>
+
+//Hit counters
+//Counts how often the instructions at one or two addresses are executed (in the OS or in the app), with
+//breakpoints that don't stop the program (see breakpoint.hpp). With two addresses it also measures the time
+//from a hit of the first one to the next hit of the second one, for example from the start of a function
+//to its return. The times need timerInit() (see timer.hpp).
+//
+//  timerInit();
+//  hitCounterStart((uint32_t)&LCD_Refresh, HIT_COUNTER_RETURN);
+//  ...
+//  hitCounterStop();
+//  //hitCounter.hits[0] calls, hitCounter.latencyTotal / hitCounter.latencyCount ticks per call
+//  timerEnd();
+
+//second address for hitCounterStart(): only count the first one
+const uint32_t HIT_COUNTER_NONE = 0;
+//second address for hitCounterStart(): wherever the function at the first address returns to (its pr)
+const uint32_t HIT_COUNTER_RETURN = 1;
+
+struct HitCounter {
+	uint32_t address[2];
+	uint32_t hits[2];
+	//times from a hit of the first address to the next hit of the second, in timer ticks (timerRate() per second)
+	uint32_t latencyCount;
+	uint32_t latencyTotal, latencyMin, latencyMax;
+	uint32_t startTicks;	//when the first address was hit
+	bool waiting;		//the first address was hit, the second one not yet
+	bool untilReturn;
+};
+
+extern HitCounter hitCounter;
+
+//Clears the counters and starts counting
+void hitCounterStart(uint32_t first, uint32_t second);
+//Stops counting (call it before the app exits), the results stay in hitCounter
+void hitCounterStop();
@@ -0,0 +1,39 @@
+#pragma once
+#include <stdint.h>
+#include <sdk/os/input.hpp>
+
+//Input event queue
+//GetInput() returns one event per call. inputPump() takes all events that are waiting (without waiting for new
+//ones) and puts them into a queue, the app then handles them with inputPop() and goes on drawing its frame.
+//Drags arrive as a stream of TOUCH_HOLD_DRAG events: if the newest event in the queue is a drag as well, it's
+//replaced with the new position instead of adding another event.
+//
+//  InputQueue queue;
+//  inputQueueInit(queue);
+//  while(running){
+//      inputPump(queue);
+//      InputEvent event;
+//      while (inputPop(queue, event)) ...handle the event...
+//      ...draw the frame...
+//  }
+
+const int INPUT_QUEUE_SIZE = 32; //has to be a power of two
+
+struct InputQueue {
+	struct InputEvent events[INPUT_QUEUE_SIZE];
+	uint32_t head;		//the next event to read (counts up, the index is head % INPUT_QUEUE_SIZE)
+	uint32_t tail;		//where the next event is written
+	uint32_t dropped;	//events that didn't fit into the queue
+};
+
+void inputQueueInit(InputQueue &queue);
+
+//Reads all waiting events into the queue. Returns the number of events GetInput() returned.
+int inputPump(InputQueue &queue);
+
+//Takes the oldest event out of the queue, false if it's empty
+bool inputPop(InputQueue &queue, struct InputEvent &event);
+
+inline int inputCount(const InputQueue &queue){
+	return queue.tail - queue.head;
+}
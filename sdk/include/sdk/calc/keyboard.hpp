@@ -0,0 +1,72 @@
+#pragma once
+#include <stdint.h>
+#include <sdk/os/input.hpp>
+
+//Keyboard state with edge detection
+//keyboardUpdate() reads the whole key matrix once (usually once per frame) and works out which keys
+//went down or up since the last update, so apps don't have to remember the last state themselves.
+//
+//  KeyboardState keys;
+//  keyboardInit(keys);
+//  while(running){
+//      keyboardUpdate(keys, false);
+//      if (keyPressed(keys, ScancodeEXE)) ...	//true only in the frame the key went down
+//      if (keyHeld(keys, ScancodeLeft)) ...	//true as long as the key is down
+//  }
+//
+//The matrix has 6 words at 0xA44B0000. In word w the low byte is column 2w and the high byte column 2w+1,
+//the bit in the byte is the row. The scancodes in input.hpp are (row << 8) | column.
+
+const int KEY_MATRIX_WORDS = 6;
+
+//Reads the 6 words of the key matrix (in getKey.s)
+extern "C" void getKeyMatrix(uint16_t *words);
+
+struct KeyboardState {
+	uint16_t held[KEY_MATRIX_WORDS];	//keys that are down
+	uint16_t pressed[KEY_MATRIX_WORDS];	//keys that went down in the last update
+	uint16_t released[KEY_MATRIX_WORDS];	//keys that went up in the last update
+	uint16_t last[KEY_MATRIX_WORDS];	//the raw matrix of the last update (for the debouncing)
+};
+
+//Reads the current state, keys that are already down then don't count as pressed in the first update.
+void keyboardInit(KeyboardState &state);
+
+//Reads the matrix and updates held/pressed/released.
+//With debounce a key only changes its state once two updates in a row read the same for it,
+//which filters out the bouncing of the contacts (and delays everything by one update).
+void keyboardUpdate(KeyboardState &state, bool debounce);
+
+//The word and the bit of a key in the matrix
+inline int scancodeWord(InputScancode scancode){
+	return (scancode & 0xFF) >> 1;
+}
+inline uint16_t scancodeMask(InputScancode scancode){
+	return 1 << ((scancode >> 8) + ((scancode & 1) ? 8 : 0));
+}
+//The scancode of bit (0 to 15) in word
+inline InputScancode scancodeFromBit(int word, int bit){
+	return (InputScancode)(((bit & 7) << 8) | (word*2 + (bit >> 3)));
+}
+
+inline bool keyHeld(const KeyboardState &state, InputScancode scancode){
+	return state.held[scancodeWord(scancode)] & scancodeMask(scancode);
+}
+inline bool keyPressed(const KeyboardState &state, InputScancode scancode){
+	return state.pressed[scancodeWord(scancode)] & scancodeMask(scancode);
+}
+inline bool keyReleased(const KeyboardState &state, InputScancode scancode){
+	return state.released[scancodeWord(scancode)] & scancodeMask(scancode);
+}
+
+//Finds the next key set in keys (held, pressed or released of a state), for going through all of them:
+//  int position = 0;
+//  InputScancode scancode;
+//  while (keyboardNext(keys.pressed, position, scancode)) ...
+bool keyboardNext(const uint16_t *keys, int &position, InputScancode &scancode);
+
+//Converts to the key1/key2 format of getKey(), for testKey() and the Keys1/Keys2 enums in calc.hpp
+inline void keyboardToKeys(const uint16_t *keys, uint32_t *key1, uint32_t *key2){
+	*key1 = ((uint32_t)keys[0] << 16) | keys[1];
+	*key2 = ((uint32_t)keys[2] << 16) | keys[3];
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <stdint.h>
+
+//The lcd controller
+//LCD_Refresh() of the OS always sends the whole OS vram to the lcd. These talk to the controller directly:
+//set a window (a range of columns and rows), then send its pixels row by row, from any buffer. Nothing has
+//to be copied into the vram first, e.g. for a sprite that changes often or a frame drawn somewhere else:
+//
+//  lcdcPushRect(frame, width, 0, 0, width, height, true);	//the whole frame, sent by the DMA controller
+//  ...work on the next frame in another buffer...
+//  lcdcWait();	//before touching frame again
+//
+//  lcdcPushRect(icon, 32, x, y, 32, 32, false);	//a 32x32 buffer, with the CPU
+//
+//LCD_RefreshRect() and LCD_RefreshDirty() in calc.hpp use these for the vram.
+
+//Sets the window to the columns x0..x1 and the rows y0..y1 (inclusive) and starts a memory write:
+//the pixels sent after this fill the window from left to right and top to bottom.
+//Waits for a transfer started by lcdcPushRect() first. No clipping.
+void lcdcBeginWrite(int x0, int y0, int x1, int y1);
+
+//Sends count pixels (after lcdcBeginWrite())
+void lcdcPushPixels(const uint16_t *pixels, int count);
+
+//Sends the w*h pixels at buffer (rows stride pixels apart) to the rectangle (x, y, w, h) of the screen,
+//clipped to the screen. buffer is the pixel that goes to (x, y).
+//With dma the DMA controller sends them in the background if the rows are next to each other in buffer
+//(w == stride after the clipping, or h == 1; with the CPU otherwise). The source must not change until
+//lcdcWait() returned. Uses the channel of dma.hpp, so dmaCopy() waits for it, and the other way around.
+void lcdcPushRect(const uint16_t *buffer, int stride, int x, int y, int w, int h, bool dma);
+
+bool lcdcBusy();	//true while a transfer started by lcdcPushRect() is running
+void lcdcWait();	//wait until it's done
@@ -0,0 +1,16 @@
+#pragma once
+#include <stdint.h>
+
+//LZ4 block decompression
+//Decodes one LZ4 block (the raw block format, without the frame around it, as written by tools/hhz.py or
+//"lz4 -B" style encoders). Reading the flash through the file API is much slower than decompressing, so a
+//compressed file that is decoded straight out of its getAddr() mapping loads faster than the plain one:
+//
+//  const uint8_t *src;
+//  getAddr(fd, offset, (const void**)&src);
+//  int size = lz4Decompress(dest, destSize, src, compressedSize);
+//  if (size < 0) ...the data is broken or doesn't fit
+//
+//Returns the number of bytes written to dst, or -1 if src isn't a valid block or it would write more than
+//dstSize bytes. Never reads outside of src or writes outside of dst. dst and src must not overlap.
+int lz4Decompress(uint8_t *dst, int dstSize, const uint8_t *src, int srcSize);
@@ -0,0 +1,52 @@
+#pragma once
+#include <stdint.h>
+#include <sdk/os/mcs.hpp>
+
+//Reading the folders and variables of the MCS (main memory) straight from its directory
+//MCS_GetVariable() needs to know the name of a variable; this lists what's in a folder, e.g. all programs:
+//
+//  const McsFolder *folder = mcsFindFolder("hhk");
+//  int position = 0;
+//  const McsVariable *variable;
+//  while (folder && mcsNextVariable(*folder, VARTYPE_PRGM, position, variable))
+//      ...mcsVariableData(*folder, *variable), variable->size...
+//
+//The directory is a table of folders at MCS_FOLDER_TABLE (one McsFolder each, it ends with a folder without
+//variables). Every folder has a table of McsVariable, and the data of a variable is at its offset plus
+//MCS_DATA_OFFSET after the start of that table. Folders are found through a hash index that is built on the
+//first mcsFindFolder(). It's checked on every lookup and rebuilt when the folders have changed, so the pointers
+//are only valid until the next folder or variable is created or deleted.
+
+const uintptr_t MCS_FOLDER_TABLE = 0x8CF80100;
+const int MCS_DATA_OFFSET = 0x0D;
+const int MCS_MAX_FOLDERS = 256;	//the table isn't read past this many folders
+const int MCS_NAME_LENGTH = 8;		//names are padded with 0, but not terminated if they are 8 characters long
+
+struct McsFolder {
+	char name[MCS_NAME_LENGTH];
+	struct McsVariable *variables;
+	uint16_t numVariables;
+	uint16_t unknown;
+};
+
+struct McsVariable {
+	char name[MCS_NAME_LENGTH];
+	uint32_t offset;	//of the data, see mcsVariableData()
+	uint32_t size;
+	uint8_t type;		//VARTYPE_...
+	uint8_t unknown[3];
+};
+
+//Compares a name of the directory with a normal string
+bool mcsNameEquals(const char *mcsName, const char *name);
+
+//The folder called name, or nullptr if there is none.
+const McsFolder *mcsFindFolder(const char *name);
+
+//Finds the next variable of the type in folder (type 0 means any variable), for going through all of them
+//starting with position = 0.
+bool mcsNextVariable(const McsFolder &folder, uint8_t type, int &position, const McsVariable *&variable);
+
+inline const uint8_t *mcsVariableData(const McsFolder &folder, const McsVariable &variable){
+	return (const uint8_t*)folder.variables + MCS_DATA_OFFSET + variable.offset;
+}
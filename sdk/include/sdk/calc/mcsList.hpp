@@ -0,0 +1,55 @@
+#pragma once
+#include <stdint.h>
+#include <sdk/calc/bcd.hpp>
+#include <sdk/calc/fixed.hpp>
+#include <sdk/os/mcs.hpp>
+
+//Whole lists of numbers in the MCS
+//Going through MCS_List_Set() for every element of a big list, with an OBCD built for each one, is slow.
+//These write and read a whole list of int32_t or fixed point numbers in one call:
+//
+//  int32_t values[10000];
+//  mcsListWrite("main", "data", values, 10000);	//shows up as the list "data" in the Main and Statistics apps
+//  int count = mcsListRead("main", "data", values, 10000);
+//
+//A list is stored as one slot of MCS_LIST_SLOT bytes per element, each starting with its OBCD. mcsListWrite()
+//sets the first element through the OS, and if the list then looks like that it writes the other elements
+//straight into the slots; otherwise it falls back to MCS_List_Set() for every element (still with one OBCD
+//that is reused). Reading takes the list from MCS_GetVariable() once and converts the slots in place.
+//The numbers are converted with bcd.hpp (and fixed.hpp): rounded towards zero and saturated if they don't fit.
+//
+//There is no OS function known for creating a matrix, so matrices aren't supported yet.
+
+const int MCS_LIST_SLOT = 16;	//sizeof(OBCD) rounded up to a power of two, see MCS_List_Create()
+
+//Creates (or overwrites) the list with count elements. Returns 0 or an MCS_ error code.
+int mcsListWrite(const char *folder, const char *name, const int32_t *values, int count);
+//Reads up to max elements, returns how many, or an MCS_ error code (negative, so it can't be mixed up with a count)
+int mcsListRead(const char *folder, const char *name, int32_t *values, int max);
+
+//The same for fixed point numbers (see fixed.hpp)
+template<typename Raw, int F>
+int mcsListWrite(const char *folder, const char *name, const Fixed<Raw, F> *values, int count);
+template<typename Raw, int F>
+int mcsListRead(const char *folder, const char *name, Fixed<Raw, F> *values, int max);
+
+//The parts the functions above are built of: converting count numbers with convert, one at a time, into
+//the OBCD slots of the list
+typedef void (*McsToOBCD)(const void *values, int i, OBCD &bcd);
+typedef void (*McsFromOBCD)(const OBCD &bcd, void *values, int i);
+int mcsListWriteWith(const char *folder, const char *name, const void *values, int count, McsToOBCD convert);
+int mcsListReadWith(const char *folder, const char *name, void *values, int max, McsFromOBCD convert);
+
+template<typename Raw, int F>
+int mcsListWrite(const char *folder, const char *name, const Fixed<Raw, F> *values, int count){
+	return mcsListWriteWith(folder, name, values, count, [](const void *v, int i, OBCD &bcd){
+		fixToOBCD(((const Fixed<Raw, F>*)v)[i], bcd);
+	});
+}
+
+template<typename Raw, int F>
+int mcsListRead(const char *folder, const char *name, Fixed<Raw, F> *values, int max){
+	return mcsListReadWith(folder, name, values, max, [](const OBCD &bcd, void *v, int i){
+		((Fixed<Raw, F>*)v)[i] = fixFromOBCD<Raw, F>(bcd);
+	});
+}
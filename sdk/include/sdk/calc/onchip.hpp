@@ -0,0 +1,28 @@
+#pragma once
+
+//On-chip RAM
+//The SH7305 has small RAMs inside the CPU that don't go through the cache, so there are never any cache misses:
+//  IL RAM: 4 KiB at 0xE5200000, for code
+//  X RAM:  8 KiB at 0xE5007000, for data
+//  Y RAM:  8 KiB at 0xE5017000, for data
+//Put the hot inner loops and the lookup tables they use there:
+//
+//  HOT_CODE void drawSpans(...){ ... }
+//  FAST_CONST static const uint16_t table[256] = { ... };
+//  FAST_DATA static int32_t accumulators[64];
+//
+//The linker scripts of the app template link these sections to the on-chip addresses. The launcher copies
+//them there when it loads a .hhk, the start code (start.s) copies them before main() in a .bin.
+//With an older linker script they stay in the normal RAM and everything still works, just without the speedup.
+//Calls between the on-chip RAM and the normal RAM are absolute (jsr), so any function can be HOT_CODE.
+//The SDK itself only puts the pixel loops of the rasterizer and the RLE blitter into the IL RAM.
+//Only what is inlined into a HOT_CODE function goes there with it. Templates and lambdas are functions of their own
+//(in .text) unless the compiler decides otherwise, so mark the ones the inner loop calls ALWAYS_INLINE:
+//
+//  HOT_CODE void drawAll(){ forEachSpan([&](int y, int xs, int xe) ALWAYS_INLINE { ... }); }
+
+#define HOT_CODE __attribute__((section(".ilram"), noinline))
+#define FAST_DATA __attribute__((section(".xram")))
+#define FAST_CONST __attribute__((section(".xram.const"))) //a separate section: gcc doesn't allow const and non-const variables in one
+#define FAST_DATA_Y __attribute__((section(".yram")))
+#define ALWAYS_INLINE __attribute__((always_inline))
@@ -0,0 +1,32 @@
+#pragma once
+#include <stdint.h>
+
+//Code overlays for .hhk apps
+//Code that is only needed sometimes (a level editor, the settings screen) can be put into one of 8 overlays.
+//They all run at the same place in the RAM (after the .bss, see app_template/linker_hhk.ld), so only the
+//biggest one counts against the memory of the app. overlayEnsure() copies an overlay from the .hhk file when
+//it's needed, replacing the one that was there:
+//
+//  OVERLAY(1) void editorRun(){ ... }
+//  OVERLAY(2) void settingsRun(){ ... }
+//
+//  if (overlayEnsure(1)) editorRun();
+//
+//Always call overlayEnsure() before calling into an overlay: a function of an overlay that isn't loaded is
+//just whatever the other overlay has at that address. An overlay can call the rest of the app, but not another
+//overlay (the linker checks that). Don't keep pointers into an overlay (like string constants) after loading
+//another one.
+//The launcher keeps the .hhk open while the app runs and passes the file descriptor in appFile (in the header, see
+//start.s), the overlays are read through it. Overlays only work in a .hhk loaded at its link address.
+
+const int OVERLAY_MAX = 8;
+
+#define OVERLAY(id) __attribute__((section(".overlay" #id), noinline))
+
+//Filled in by the launcher (in the header of the app, see app_template/start.s)
+extern "C" int32_t appFile;
+
+//Makes sure overlay id is loaded. Returns false if there is no such overlay, the launcher didn't open the file,
+//or reading it failed (then no overlay is loaded at that place any more).
+bool overlayEnsure(int id);
+bool overlayLoaded(int id);
@@ -0,0 +1,38 @@
+#pragma once
+#include <stdint.h>
+
+//Sampling profiler
+//Channel 1 of the UBC counts the instructions the CPU executes in an address range (usually the app itself)
+//and breaks into a handler after every period of them. The handler adds the address it interrupted to a
+//histogram with one counter per 2^bucketShift bytes. Functions that run longer get more samples.
+//
+//  profilerStart(PROFILER_APP_START, PROFILER_APP_SIZE, 4, 1000);
+//  ...the code to measure...
+//  profilerStop();			//always before the app exits: the handler is part of the app
+//  profilerSaveFile("\\\\fls0\\app.prof");	//or profilerSendSerial()
+//  profilerFree();
+//
+//Then on the PC: python3 tools/profile.py app.hhk app.prof
+//
+//Only instructions inside the range count, so time spent in OS functions doesn't show up. The handler runs
+//from the IL RAM (see onchip.hpp) so it doesn't count itself. The profiler uses the UBC through breakpoint.hpp,
+//so it can't run at the same time as other breakpoints (like the hit counter's).
+
+//Where apps are loaded, and the size to cover all of their code
+const uint32_t PROFILER_APP_START = 0x8CFF0000;
+const uint32_t PROFILER_APP_SIZE = 0x10000;
+
+//size has to be a power of two and start a multiple of it. period is the number of instructions between
+//two samples (1 to 4095). Returns false if the range is wrong or there isn't enough memory for the histogram.
+bool profilerStart(uint32_t start, uint32_t size, int bucketShift, uint32_t period);
+//Stops sampling and gives the UBC back to the OS, the histogram stays until profilerFree()
+void profilerStop();
+void profilerFree();
+
+uint32_t profilerSamples();
+
+//The histogram in the format tools/profile.py reads (all numbers 32 bit big endian):
+//"PROF", version (1), start, size, bucketShift, period, samples, n, then n times the address and the count
+//of every bucket that has samples.
+void profilerSendSerial();
+bool profilerSaveFile(const char *path);
@@ -0,0 +1,52 @@
+#pragma once
+#include <stdint.h>
+
+//Buffered, non-blocking serial port
+//Serial_Write() only takes as much as fits into the small transmit buffer of the OS (and the usual way to use it
+//is to loop until it does). serialWrite() puts the data into a bigger ring in the app instead and returns at
+//once; serialPump() moves as much of it as the OS has room for in one Serial_Write(), and moves what the OS
+//received into another ring for serialRead(). The OS sends and receives in the background (the SCIF FIFO is
+//driven by its interrupts), so calling serialPump() once per frame is enough for a constant stream:
+//
+//  SerialBuffer serial;
+//  serialBufferInit(serial, 9);	//115200 baud
+//  while(running){
+//      serialWriteDec(serial, frame); serialWrite(serial, ",", 1); serialWriteHex(serial, value, 8);
+//      serialWrite(serial, "\n", 1);
+//      serialPump(serial);
+//      ...
+//  }
+//  serialFlush(serial);
+
+const int SERIAL_TX_SIZE = 2048;	//both have to be powers of two
+const int SERIAL_RX_SIZE = 512;
+
+struct SerialBuffer {
+	uint8_t tx[SERIAL_TX_SIZE];
+	uint8_t rx[SERIAL_RX_SIZE];
+	uint32_t txHead, txTail;	//counting up, the index is txHead % SERIAL_TX_SIZE
+	uint32_t rxHead, rxTail;
+	uint32_t dropped;		//bytes that didn't fit into tx (or rx)
+};
+
+//Clears the rings and opens the port with the bit rate mode (see Serial_Open(), 5 = 9600, 9 = 115200, 8N1) if
+//it isn't open yet.
+void serialBufferInit(SerialBuffer &serial, int bitRate);
+
+//Sends what the OS has room for and gets what it received. Doesn't wait.
+void serialPump(SerialBuffer &serial);
+//Waits until everything has been given to the OS.
+void serialFlush(SerialBuffer &serial);
+
+//Adds count bytes to the transmit ring and returns how many fit (the rest is dropped).
+int serialWrite(SerialBuffer &serial, const void *data, int count);
+int serialWriteString(SerialBuffer &serial, const char *text);
+//digits hex digits of value, most significant first
+int serialWriteHex(SerialBuffer &serial, uint32_t value, int digits);
+int serialWriteDec(SerialBuffer &serial, int32_t value);
+
+//Takes up to count received bytes, returns how many.
+int serialRead(SerialBuffer &serial, void *data, int count);
+inline int serialAvailable(const SerialBuffer &serial){
+	return serial.rxTail - serial.rxHead;
+}
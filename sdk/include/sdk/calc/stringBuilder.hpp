@@ -0,0 +1,64 @@
+#pragma once
+#include <stdint.h>
+
+//Building strings in a buffer
+//A StringBuilder knows the length of its string, so appending doesn't look for the end first like strcat() does,
+//and it never writes past the end of the buffer: what doesn't fit is cut off (and truncated is set).
+//The string is always terminated.
+//
+//  char text[32];
+//  StringBuilder sb;
+//  stringBuilderInit(sb, text);
+//  appendString(sb, "Score: ");
+//  appendInt(sb, score, 4, '0');	//"Score: 0042"
+//  drawText(text, 4, 8, color);
+
+struct StringBuilder {
+	char *buffer;
+	int size;	//of the buffer, including the terminator
+	int length;	//of the string
+	bool truncated;	//something didn't fit
+};
+
+//Starts an empty string in buffer (size bytes, at least 1)
+inline void stringBuilderInit(StringBuilder &sb, char *buffer, int size){
+	sb.buffer = buffer;
+	sb.size = size;
+	sb.length = 0;
+	sb.truncated = false;
+	buffer[0] = '\0';
+}
+template<int N>
+inline void stringBuilderInit(StringBuilder &sb, char (&buffer)[N]){
+	stringBuilderInit(sb, buffer, N);
+}
+
+//Cuts the string back to length characters (e.g. to undo the last appends)
+inline void stringBuilderTruncate(StringBuilder &sb, int length){
+	if (length < sb.length){
+		sb.length = length;
+		sb.buffer[length] = '\0';
+	}
+}
+
+inline void appendChar(StringBuilder &sb, char c){
+	if (sb.length < sb.size - 1){
+		sb.buffer[sb.length++] = c;
+		sb.buffer[sb.length] = '\0';
+	} else {
+		sb.truncated = true;
+	}
+}
+void appendString(StringBuilder &sb, const char *text);
+//The first count characters of text
+void appendString(StringBuilder &sb, const char *text, int count);
+
+//Numbers, padded on the left with pad to at least width characters. With pad '0' a minus goes before the zeros.
+void appendInt(StringBuilder &sb, int32_t value, int width = 0, char pad = ' ');
+void appendUInt(StringBuilder &sb, uint32_t value, int width = 0, char pad = ' ');
+//Upper case, without "0x". Always at least digits digits (1 to 8) with leading zeros.
+void appendHex(StringBuilder &sb, uint32_t value, int digits = 1);
+
+//The digits of value written backwards from end (e.g. the end of a char[10]), two at a time.
+//Returns where the first digit is. Also used by serialWriteDec() in serialBuffer.hpp.
+char *formatUInt(char *end, uint32_t value);
@@ -0,0 +1,502 @@
+#pragma once
+#include <stdint.h>
+#include <sdk/calc/calc.hpp>
+#include <sdk/calc/div.hpp>
+#include <sdk/calc/onchip.hpp>
+#include <sdk/os/mem.hpp>
+
+//Surfaces
+//The drawing routines of calc.hpp draw into the vram. These do the same for any buffer: a Surface is the pixels,
+//the size and the stride of a buffer in one of the pixel formats below. Every routine is a template on the format,
+//so it is compiled with the inner loop of that format (no check of the format per pixel). A surface with a
+//Stride known at compile time gets the multiplications for the rows as constants.
+//
+//  uint8_t maskBits[(64/8) * 48];
+//  Surface<Mono1, 64/8> mask = {maskBits, 64, 48, 0, nullptr};	//64x48 pixels, 1 bit each
+//  surfaceFill(mask, 0);
+//  surfaceFillCircle(mask, 32, 24, 20, 1);
+//  surfaceCopy(screenSurface(), 100, 100, mask, 0, 0, 64, 48, Mono1ToRgb565{color(255, 0, 0), 0xFFFF});
+//
+//  Surface<Index8> canvasSurface = {canvas.pixels, canvas.width, canvas.height, canvas.width, nullptr};
+//  surfaceLine(canvasSurface, 0, 0, 100, 50, 3);	//then canvasMarkAll(canvas)
+//
+//line(), hline(), fillTriangle()... in calc.hpp are these on screenSurface().
+
+//The pixel formats. Storage is what a row is made of, Color the value of one pixel.
+//ADDRESSABLE formats have one Storage per pixel, so the routines can walk through them with a pointer.
+
+//16 bit colors (like the vram)
+struct Rgb565 {
+	typedef uint16_t Storage;
+	typedef uint16_t Color;
+	static constexpr bool ADDRESSABLE = true;
+
+	static inline void set(Storage *row, int x, Color color){ row[x] = color; }
+	static inline Color get(const Storage *row, int x){ return row[x]; }
+	static inline void fill(Storage *row, int x, int count, Color color){ fillSpan(row + x, count, color); }
+};
+
+//8 bit palette indices (like IndexedCanvas)
+struct Index8 {
+	typedef uint8_t Storage;
+	typedef uint8_t Color;
+	static constexpr bool ADDRESSABLE = true;
+
+	static inline void set(Storage *row, int x, Color color){ row[x] = color; }
+	static inline Color get(const Storage *row, int x){ return row[x]; }
+	static inline void fill(Storage *row, int x, int count, Color color){ memset(row + x, color, count); }
+};
+
+//1 bit per pixel (0 or 1), 8 pixels per byte, bit 7 is the leftmost one (like the rows of a Font).
+//The stride is in bytes.
+struct Mono1 {
+	typedef uint8_t Storage;
+	typedef uint8_t Color;
+	static constexpr bool ADDRESSABLE = false;
+
+	static inline void set(Storage *row, int x, Color color){
+		uint8_t bit = 0x80 >> (x & 7);
+		if (color) row[x >> 3] |= bit;
+		else row[x >> 3] &= ~bit;
+	}
+	static inline Color get(const Storage *row, int x){
+		return (row[x >> 3] >> (7 - (x & 7))) & 1;
+	}
+	//the partial bytes at both ends with a mask, the whole bytes in between with memset()
+	static inline void fill(Storage *row, int x, int count, Color color){
+		int end = x + count;
+		uint8_t *first = row + (x >> 3);
+		uint8_t *last = row + (end >> 3);
+		uint8_t head = 0xFF >> (x & 7);
+		uint8_t tail = ~(0xFF >> (end & 7));
+		uint8_t value = color ? 0xFF : 0;
+		if (first == last){
+			uint8_t mask = head & tail;
+			*first = (*first & ~mask) | (value & mask);
+			return;
+		}
+		*first = (*first & ~head) | (value & head);
+		memset(first + 1, value, last - first - 1);
+		if (tail) *last = (*last & ~tail) | (value & tail);
+	}
+};
+
+//width*height pixels, row y starts at pixels + y*stride (in Storage units).
+//With Stride the stride is a constant and the stride member isn't used.
+//dirty is extended by everything that is drawn, like the one of the vram, or nullptr.
+template<typename Format, int Stride = 0>
+struct Surface {
+	typename Format::Storage *pixels;
+	int width, height;
+	int stride;
+	DirtyRect *dirty;
+
+	inline int pitch() const { return Stride ? Stride : stride; }
+	inline typename Format::Storage *row(int y) const { return pixels + pitch() * y; }
+};
+
+//The vram, with the dirty rectangle of LCD_RefreshDirty()
+inline Surface<Rgb565> screenSurface(){
+	return {vram, width, height, width, &dirty};
+}
+
+template<typename Format, int Stride>
+inline void surfaceMark(const Surface<Format, Stride> &s, int x0, int y0, int x1, int y1){
+	if (s.dirty == nullptr) return;
+	if (x0 < s.dirty->x0) s.dirty->x0 = x0;
+	if (y0 < s.dirty->y0) s.dirty->y0 = y0;
+	if (x1 > s.dirty->x1) s.dirty->x1 = x1;
+	if (y1 > s.dirty->y1) s.dirty->y1 = y1;
+}
+
+template<typename Format, int Stride>
+inline void surfaceSetPixel(const Surface<Format, Stride> &s, int x, int y, typename Format::Color color){
+	if (x>=0 && x<s.width && y>=0 && y<s.height){
+		Format::set(s.row(y), x, color);
+		surfaceMark(s, x, y, x, y);
+	}
+}
+
+//0 outside of the surface
+template<typename Format, int Stride>
+inline typename Format::Color surfaceGetPixel(const Surface<Format, Stride> &s, int x, int y){
+	if (x>=0 && x<s.width && y>=0 && y<s.height)
+		return Format::get(s.row(y), x);
+	return 0;
+}
+
+//Spans and rectangles: clipped once per call, then filled a row at a time.
+template<typename Format, int Stride>
+void surfaceHline(const Surface<Format, Stride> &s, int x1, int x2, int y, typename Format::Color color){
+	if (x1>x2) { int z=x2; x2=x1; x1=z;}
+	if (y<0 || y>=s.height || x2<0 || x1>=s.width) return;
+	if (x1<0) x1=0;
+	if (x2>=s.width) x2=s.width-1;
+	surfaceMark(s, x1, y, x2, y);
+	Format::fill(s.row(y), x1, x2-x1+1, color);
+}
+
+template<typename Format, int Stride>
+void surfaceVline(const Surface<Format, Stride> &s, int x, int y1, int y2, typename Format::Color color){
+	if (y1>y2) { int z=y2; y2=y1; y1=z;}
+	if (x<0 || x>=s.width || y2<0 || y1>=s.height) return;
+	if (y1<0) y1=0;
+	if (y2>=s.height) y2=s.height-1;
+	surfaceMark(s, x, y1, x, y2);
+	typename Format::Storage *row = s.row(y1);
+	for (int y=y1; y<=y2; y++){
+		Format::set(row, x, color);
+		row += s.pitch();
+	}
+}
+
+template<typename Format, int Stride>
+void surfaceFillRect(const Surface<Format, Stride> &s, int x, int y, int w, int h, typename Format::Color color){
+	if (x<0) { w+=x; x=0; }
+	if (y<0) { h+=y; y=0; }
+	if (x+w>s.width)  w=s.width-x;
+	if (y+h>s.height) h=s.height-y;
+	if (w<=0 || h<=0) return;
+	surfaceMark(s, x, y, x+w-1, y+h-1);
+
+	typename Format::Storage *row = s.row(y);
+	while (h--){
+		Format::fill(row, x, w, color);
+		row += s.pitch();
+	}
+}
+
+template<typename Format, int Stride>
+void surfaceFill(const Surface<Format, Stride> &s, typename Format::Color color){
+	//rows without a gap in between are one span
+	if (!Format::ADDRESSABLE || s.pitch() != s.width){
+		surfaceFillRect(s, 0, 0, s.width, s.height, color);
+		return;
+	}
+	Format::fill(s.pixels, 0, s.width * s.height, color);
+	surfaceMark(s, 0, 0, s.width-1, s.height-1);
+}
+
+//Clips the line to the rectangle (0, 0) to (clipWidth-1, clipHeight-1) (Cohen-Sutherland). Moves the end points that
+//are outside onto its border. Returns false if no part of the line is inside.
+bool clipLine(int clipWidth, int clipHeight, int &x1, int &y1, int &x2, int &y2);
+
+//Lines (Bresenham): clipped first, then drawn without checking every pixel
+template<typename Format, int Stride>
+void surfaceLine(const Surface<Format, Stride> &s, int x1, int y1, int x2, int y2, typename Format::Color color){
+	//horizontal and vertical lines are spans
+	if (y1==y2) { surfaceHline(s, x1, x2, y1, color); return; }
+	if (x1==x2) { surfaceVline(s, x1, y1, y2, color); return; }
+
+	if (!clipLine(s.width, s.height, x1, y1, x2, y2)) return;
+	//the clipped part can be a span (then the steps below would go one pixel too far, e.g. with dx=1, dy=0)
+	if (y1==y2) { surfaceHline(s, x1, x2, y1, color); return; }
+	if (x1==x2) { surfaceVline(s, x1, y1, y2, color); return; }
+	surfaceMark(s, x1<x2 ? x1 : x2, y1<y2 ? y1 : y2, x1<x2 ? x2 : x1, y1<y2 ? y2 : y1);
+
+	int ix, iy; //step in x direction (1 or -1) and in y direction (one row up or down)
+	int dx = (x2>x1 ? (ix=1, x2-x1) : (ix=-1, x1-x2) );
+	int dy = (y2>y1 ? (iy=s.pitch(), y2-y1) : (iy=-s.pitch(), y1-y2) );
+	//the major axis steps every pixel, error is the fractional part of the other one (times the major length)
+	bool flat = dx>=dy;
+	int major = flat ? dx : dy, minor = flat ? dy : dx;
+	int error = 0;
+
+	if (Format::ADDRESSABLE){
+		//walk through the buffer with a pointer
+		typename Format::Storage *p = s.row(y1) + x1;
+		int stepMajor = flat ? ix : iy, stepMinor = flat ? iy : ix;
+		Format::set(p, 0, color);
+		for (int i=major; i>0; i--){
+			p += stepMajor;
+			error += minor;
+			if (error>=(major>>1)){
+				p += stepMinor;
+				error -= major;
+			}
+			Format::set(p, 0, color);
+		}
+	}else{
+		//pixels that share a byte: keep the row and the x coordinate
+		typename Format::Storage *row = s.row(y1);
+		int x = x1;
+		Format::set(row, x, color);
+		for (int i=major; i>0; i--){
+			if (flat) x += ix; else row += iy;
+			error += minor;
+			if (error>=(major>>1)){
+				if (flat) row += iy; else x += ix;
+				error -= major;
+			}
+			Format::set(row, x, color);
+		}
+	}
+}
+
+//Scanline triangle rasterizer
+//The triangle is split at its middle vertex (sorted by y) and filled row by row with horizontal spans.
+//Fill rule (top-left): a pixel is drawn if its center is inside the triangle. A pixel exactly on an
+//edge is only drawn if it's a top or left edge, so triangles sharing an edge never overlap and leave no gaps.
+//Pixel centers are at integer coordinates.
+
+//n / d rounded towards -infinity, d has to be positive. rem gets n - q*d (0 <= rem < d).
+inline int floorDiv(int n, int d, int &rem){
+	int q = sdiv32(n, d);
+	rem = n - q*d;
+	if (rem < 0){
+		q--;
+		rem += d;
+	}
+	return q;
+}
+
+//The x coordinate of an edge, stepped one row at a time without a division.
+//The exact x coordinate is x + rem/dy.
+struct TriangleEdge {
+	int x, rem;
+	int stepX, stepRem;
+	int dy;
+
+	//Start at row y on the edge from (xa,ya) to (xb,yb), ya < yb.
+	//Not inlined: it's only the setup, with two divisions that would make every rasterizeTriangle() bigger.
+	__attribute__((noinline)) void init(int xa, int ya, int xb, int yb, int y){
+		dy = yb - ya;
+		x = xa + floorDiv((xb-xa) * (y-ya), dy, rem);
+		stepX = floorDiv(xb-xa, dy, stepRem);
+	}
+	ALWAYS_INLINE void step(){
+		x += stepX;
+		rem += stepRem;
+		if (rem >= dy){
+			x++;
+			rem -= dy;
+		}
+	}
+	//The first pixel center that is on or right of the edge
+	ALWAYS_INLINE int ceil() const {
+		return rem ? x+1 : x;
+	}
+};
+
+//Calls span(y, xStart, xEnd) for the pixels of every row of the triangle (xEnd is exclusive), clipped to
+//(0, 0) to (clipWidth-1, clipHeight-1). Extends mark (if it isn't nullptr) by the rows and columns drawn.
+//Always inlined, so a HOT_CODE caller (see onchip.hpp) has the loop over the rows in the IL RAM. Every span is its own
+//instantiation anyway.
+template<typename Span>
+ALWAYS_INLINE inline void rasterizeTriangle(int clipWidth, int clipHeight, DirtyRect *mark, int x0, int y0, int x1, int y1, int x2, int y2, Span span){
+	//Sort the points by y coordinate
+	{
+		int z;
+		if(y0>y2){ z=x2; x2=x0; x0=z; z=y2; y2=y0; y0=z; }
+		if(y0>y1){ z=x1; x1=x0; x0=z; z=y1; y1=y0; y0=z; }
+		if(y1>y2){ z=x2; x2=x1; x1=z; z=y2; y2=y1; y1=z; }
+	}
+	if (y0 == y2 || y2 <= 0 || y0 >= clipHeight) return;
+
+	//The long edge goes from P0 to P2, the short edges from P0 to P1 and from P1 to P2.
+	//cross < 0: P1 is left of the long edge, so the short edges are on the left side.
+	int cross = (x1-x0)*(y2-y0) - (x2-x0)*(y1-y0);
+	if (cross == 0) return; //all points on one line
+	bool shortLeft = cross < 0;
+
+	{
+		int minX = x0, maxX = x0;
+		if (x1<minX) minX=x1;
+		if (x1>maxX) maxX=x1;
+		if (x2<minX) minX=x2;
+		if (x2>maxX) maxX=x2;
+		if (maxX < 0 || minX >= clipWidth) return;
+		if (mark != nullptr){
+			int mx0 = minX<0 ? 0 : minX, my0 = y0<0 ? 0 : y0;
+			int mx1 = maxX>=clipWidth ? clipWidth-1 : maxX, my1 = y2>clipHeight ? clipHeight-1 : y2-1;
+			if (mx0 < mark->x0) mark->x0 = mx0;
+			if (my0 < mark->y0) mark->y0 = my0;
+			if (mx1 > mark->x1) mark->x1 = mx1;
+			if (my1 > mark->y1) mark->y1 = my1;
+		}
+	}
+
+	//Rows from y0 (inclusive) to y2 (exclusive), the top-left rule for horizontal edges
+	int y = y0 < 0 ? 0 : y0;
+	TriangleEdge longEdge, shortEdge;
+	longEdge.init(x0, y0, x2, y2, y);
+
+	for (int part=0; part<2; part++){
+		int end;
+		if (part == 0){
+			end = y1;
+			if (y >= end) continue; //flat top, or the upper part is above the clip rectangle
+			shortEdge.init(x0, y0, x1, y1, y);
+		}else{
+			end = y2;
+			if (y < y1) y = y1;
+			if (y >= end) continue;
+			shortEdge.init(x1, y1, x2, y2, y);
+		}
+		if (end > clipHeight) end = clipHeight;
+
+		TriangleEdge &left  = shortLeft ? shortEdge : longEdge;
+		TriangleEdge &right = shortLeft ? longEdge : shortEdge;
+		for (; y<end; y++){
+			//left edges inclusive, right edges exclusive
+			int xs = left.ceil();
+			int xe = right.ceil();
+			if (xs < 0) xs = 0;
+			if (xe > clipWidth) xe = clipWidth;
+			if (xs < xe) span(y, xs, xe);
+			left.step();
+			right.step();
+		}
+	}
+}
+
+template<typename Format, int Stride>
+void surfaceFillTriangle(const Surface<Format, Stride> &s, int x0, int y0, int x1, int y1, int x2, int y2, typename Format::Color color){
+	rasterizeTriangle(s.width, s.height, s.dirty, x0, y0, x1, y1, x2, y2, [&s, color](int y, int xs, int xe){
+		Format::fill(s.row(y), xs, xe-xs, color);
+	});
+}
+
+//Circles and ellipses (midpoint algorithm)
+//For every row dy (from the center to the top) we find the rightmost pixel x inside the ellipse:
+//x*x/(a+0.5)^2 + dy*dy/(b+0.5)^2 <= 1, multiplied by (2a+1)^2*(2b+1)^2 so everything stays an integer.
+//t (the left side of this) is updated with additions only while we move down one row / left one pixel.
+//The radii have to be below 16384, so the products fit into 32 bits.
+template<typename Format, int Stride>
+void surfaceEllipseRows(const Surface<Format, Stride> &s, int x0, int y0, int a, int b, bool fill, typename Format::Color color){
+	if (a<0 || b<0 || a>=16384 || b>=16384) return;
+	if (x0+a<0 || x0-a>=s.width || y0+b<0 || y0-b>=s.height) return;
+
+	uint32_t A = (2*b+1)*(2*b+1);
+	uint32_t B = (2*a+1)*(2*a+1);
+	uint64_t limit = (uint64_t)A * B;
+	uint64_t t = (uint64_t)A * (uint32_t)(4*a*a); //the pixel (a, 0)
+	int x = a;
+
+	for (int dy=0; dy<=b; dy++){
+		//the rightmost pixel of the next row
+		int next = -1;
+		if (dy < b){
+			t += (uint64_t)B * (uint32_t)(8*dy+4);
+			next = x;
+			while (t > limit){
+				t -= (uint64_t)A * (uint32_t)(8*next-4);
+				next--;
+			}
+		}
+
+		for (int side=0; side<2; side++){
+			int y = side ? y0-dy : y0+dy;
+			if (side && dy==0) break;
+			if (fill){
+				surfaceHline(s, x0-x, x0+x, y, color);
+				continue;
+			}
+			//outline: from the pixel after the end of the next row to x, so there are no gaps
+			int inner = next+1;
+			if (inner > x) inner = x;
+			if (inner == 0){
+				surfaceHline(s, x0-x, x0+x, y, color);
+			}else{
+				surfaceHline(s, x0-x, x0-inner, y, color);
+				surfaceHline(s, x0+inner, x0+x, y, color);
+			}
+		}
+		x = next;
+	}
+}
+
+template<typename Format, int Stride>
+inline void surfaceCircle(const Surface<Format, Stride> &s, int x, int y, int radius, typename Format::Color color){
+	surfaceEllipseRows(s, x, y, radius, radius, false, color);
+}
+template<typename Format, int Stride>
+inline void surfaceFillCircle(const Surface<Format, Stride> &s, int x, int y, int radius, typename Format::Color color){
+	surfaceEllipseRows(s, x, y, radius, radius, true, color);
+}
+template<typename Format, int Stride>
+inline void surfaceEllipse(const Surface<Format, Stride> &s, int x, int y, int radiusX, int radiusY, typename Format::Color color){
+	surfaceEllipseRows(s, x, y, radiusX, radiusY, false, color);
+}
+template<typename Format, int Stride>
+inline void surfaceFillEllipse(const Surface<Format, Stride> &s, int x, int y, int radiusX, int radiusY, typename Format::Color color){
+	surfaceEllipseRows(s, x, y, radiusX, radiusY, true, color);
+}
+
+//Format conversion for surfaceCopy(): a function object that turns a source Color into a destination Color.
+
+//Keeps the value (for two surfaces of the same format, or 8 bit indices into a 1 bit mask and so on)
+struct SameColor {
+	template<typename Color>
+	inline Color operator()(Color color) const { return color; }
+};
+
+//1 bit to 16 bit: set pixels become on, the others off
+struct Mono1ToRgb565 {
+	uint16_t on, off;
+	inline uint16_t operator()(uint8_t bit) const { return bit ? on : off; }
+};
+
+//8 bit indices to 16 bit through a palette (like canvasPresent())
+struct Index8ToRgb565 {
+	const uint16_t *palette;
+	inline uint16_t operator()(uint8_t index) const { return palette[index]; }
+};
+
+//16 bit to 1 bit: 1 if the brightness (0 for black to 63 for white, green counts twice) is at least threshold
+//(1 to 63, 0 makes every pixel 1)
+struct Rgb565ToMono1 {
+	int threshold;
+	inline uint8_t operator()(uint16_t color) const {
+		int r = color >> 11, g = (color >> 5) & 0x3F, b = color & 0x1F;
+		//r+g+b is 0 to 125, *65>>7 makes that 0 to 63
+		return ((r + g + b) * 65 >> 7) >= threshold ? 1 : 0;
+	}
+};
+
+//One row of surfaceCopy(), converted pixel by pixel
+template<typename DstFormat, typename SrcFormat, typename Convert>
+struct SurfaceRowCopy {
+	static inline void copy(typename DstFormat::Storage *to, int x, const typename SrcFormat::Storage *from, int srcX, int w, Convert convert){
+		for (int i=0; i<w; i++)
+			DstFormat::set(to, x+i, convert(SrcFormat::get(from, srcX+i)));
+	}
+};
+//Same format without a conversion: memcpy() if there's one Storage per pixel
+template<typename Format>
+struct SurfaceRowCopy<Format, Format, SameColor> {
+	static inline void copy(typename Format::Storage *to, int x, const typename Format::Storage *from, int srcX, int w, SameColor convert){
+		if (Format::ADDRESSABLE){
+			memcpy(to + x, from + srcX, w * sizeof(typename Format::Storage));
+			return;
+		}
+		for (int i=0; i<w; i++)
+			Format::set(to, x+i, Format::get(from, srcX+i));
+	}
+};
+
+//Copies the w*h pixels at (srcX, srcY) of src to (x, y) of dst, converted by convert, clipped to both surfaces.
+//Between two surfaces of the same ADDRESSABLE format with SameColor the rows are copied with memcpy().
+template<typename DstFormat, int DstStride, typename SrcFormat, int SrcStride, typename Convert>
+void surfaceCopy(const Surface<DstFormat, DstStride> &dst, int x, int y, const Surface<SrcFormat, SrcStride> &src,
+		int srcX, int srcY, int w, int h, Convert convert){
+	//clip to the source, then to the destination
+	if (srcX<0) { w+=srcX; x-=srcX; srcX=0; }
+	if (srcY<0) { h+=srcY; y-=srcY; srcY=0; }
+	if (srcX+w>src.width)  w=src.width-srcX;
+	if (srcY+h>src.height) h=src.height-srcY;
+	if (x<0) { w+=x; srcX-=x; x=0; }
+	if (y<0) { h+=y; srcY-=y; y=0; }
+	if (x+w>dst.width)  w=dst.width-x;
+	if (y+h>dst.height) h=dst.height-y;
+	if (w<=0 || h<=0) return;
+	surfaceMark(dst, x, y, x+w-1, y+h-1);
+
+	typename DstFormat::Storage *to = dst.row(y);
+	const typename SrcFormat::Storage *from = src.row(srcY);
+	for (int j=0; j<h; j++){
+		SurfaceRowCopy<DstFormat, SrcFormat, Convert>::copy(to, x, from, srcX, w, convert);
+		to += dst.pitch();
+		from += src.pitch();
+	}
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <stdint.h>
+#include <sdk/calc/calc.hpp>
+
+//Text drawn directly into the vram, at any pixel position and in any color.
+//Much faster than Debug_PrintString(), and the text is clipped to the screen.
+
+//A proportional bitmap font. Glyphs are up to 8 pixels wide.
+struct Font {
+	uint8_t height;		//rows of every glyph (a line of text is height+1 pixels high)
+	uint8_t first, last;	//the first and the last character in the font
+	uint8_t spacing;	//empty columns between two glyphs
+	const uint8_t *widths;	//the width of every glyph
+	const uint8_t *rows;	//height bytes for every glyph, bit 7 is the leftmost column
+};
+
+extern const Font defaultFont;
+
+//Draw text with its top left corner at (x, y). '\n' starts a new line below x.
+//Characters that aren't in the font are drawn as '?'. Returns the x coordinate after the last character.
+int drawText(const char *text, int x, int y, uint16_t color, const Font &font = defaultFont);
+//The same, but fills the box around the text with background first
+int drawText(const char *text, int x, int y, uint16_t color, uint16_t background, const Font &font = defaultFont);
+
+//The size of text in pixels, without drawing it (for multiple lines: the width of the widest line)
+int textWidth(const char *text, const Font &font = defaultFont);
+int textHeight(const char *text, const Font &font = defaultFont);
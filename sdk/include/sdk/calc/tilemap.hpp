@@ -0,0 +1,72 @@
+#pragma once
+#include <stdint.h>
+#include <sdk/calc/blit.hpp>
+
+//Tile maps
+//A grid of tiles (one byte each) drawn into the vram. Every cell has a dirty bit: tileMapSet() only sets it if
+//the tile really changes, and tileMapDraw() only draws the cells that are dirty, so a game that changes a few
+//cells per tick only draws those (and LCD_RefreshDirty() only sends them, see markDirty()).
+//
+//The tiles either come from an atlas (the images of all tiles one below the other, tile i starts at row
+//i*tileHeight), or are filled with one color each (colors[tile]) if there is no atlas.
+//
+//  TileMap map;
+//  tileMapInit(map, 16, 25, 20, 20);
+//  map.y = 24;		//the map starts below the score
+//  map.colors = tileColors;
+//  tileMapDraw(map);	//everything is dirty after the init
+//  while(running){
+//      tileMapSet(map, headX, headY, TILE_SNAKE);
+//      tileMapDraw(map);
+//      LCD_RefreshDirty();
+//  }
+
+struct TileMap {
+	uint8_t *tiles;		//columns*rows tiles, row by row
+	uint32_t *dirty;	//rowWords bits for every row, bit c%32 of word c/32 is column c
+	int columns, rows, rowWords;
+	int tileWidth, tileHeight;
+	int spacing;		//pixels between the tiles that aren't drawn (e.g. for grid lines)
+
+	const Bitmap *atlas;	//the images of the tiles, or nullptr for colors
+	const uint16_t *colors;	//the color of every tile if there is no atlas
+
+	//the part of the screen the map is drawn into, everything else is clipped. The cell (0, 0) is at
+	//(x - scrollX, y - scrollY).
+	int x, y, viewWidth, viewHeight;
+	int scrollX, scrollY;
+	uint16_t background;	//what tileMapScroll() clears the view with (the spacing isn't drawn otherwise)
+};
+
+//Allocates the tiles (all 0 and dirty). The view starts at (0, 0) and is as big as the whole map.
+//Returns false if there isn't enough memory.
+bool tileMapInit(TileMap &map, int columns, int rows, int tileWidth, int tileHeight);
+void tileMapFree(TileMap &map);
+
+inline void tileMapMark(TileMap &map, int column, int row){
+	map.dirty[row * map.rowWords + (column >> 5)] |= 1u << (column & 31);
+}
+void tileMapMarkAll(TileMap &map);
+
+inline uint8_t tileMapGet(const TileMap &map, int column, int row){
+	if (column < 0 || column >= map.columns || row < 0 || row >= map.rows) return 0;
+	return map.tiles[row * map.columns + column];
+}
+//Marks the cell dirty if the tile changes. Cells outside the map are ignored.
+inline void tileMapSet(TileMap &map, int column, int row, uint8_t tile){
+	if (column < 0 || column >= map.columns || row < 0 || row >= map.rows) return;
+	uint8_t &cell = map.tiles[row * map.columns + column];
+	if (cell != tile){
+		cell = tile;
+		tileMapMark(map, column, row);
+	}
+}
+//Sets every cell to tile
+void tileMapFill(TileMap &map, uint8_t tile);
+
+//Moves the view: everything moves on the screen, so the view is cleared with background and every cell is drawn
+//again by the next tileMapDraw()
+void tileMapScroll(TileMap &map, int scrollX, int scrollY);
+
+//Draws the dirty cells that are in the view and clears the dirty bits. Returns the number of cells drawn.
+int tileMapDraw(TileMap &map);
@@ -0,0 +1,60 @@
+#pragma once
+#include <stdint.h>
+
+//Timer and frame pacing
+//timerInit() starts a TMU channel as a free running counter at peripheral clock / 4 and measures how fast it
+//counts against the RTC (the peripheral clock depends on the clock settings of the OS).
+//timerMicros() then returns the microseconds since timerInit(). Call timerEnd() before the app exits,
+//it gives the channel back to the OS the way it was.
+//
+//  timerInit();
+//  FramePacer pacer;
+//  pacerInit(pacer, 1000000 / 30);	//30 frames per second
+//  while(running){
+//      int steps = pacerWait(pacer);	//sleeps until the next frame is due
+//      for (int i=0; i<steps; i++) ...update the game by one fixed step...
+//      ...draw...
+//  }
+//  timerEnd();
+
+//The TMU channel used by the sdk (the OS uses the lower ones)
+const int TIMER_CHANNEL = 2;
+
+//Starts the timer. Takes about 1/8 second to calibrate. Returns false if the RTC isn't running.
+bool timerInit();
+//Stops the timer and restores the channel's registers
+void timerEnd();
+
+uint32_t timerTicks();	//raw counter value (counts up, wraps around)
+uint32_t timerRate();	//ticks per second
+
+//Microseconds since timerInit(), wraps around after about 71 minutes.
+//Has to be called at least every few minutes (before the counter wraps), the pacer and sleep functions do that.
+uint32_t timerMicros();
+
+//Wait until timerMicros() reaches time (works across the wrap around)
+void sleepUntil(uint32_t time);
+void sleepMicros(uint32_t us);
+
+//Frame times in microseconds
+struct FrameStats {
+	uint32_t min, max;
+	uint32_t total;	//all frame times added, for the average
+	uint32_t count;	//number of frames
+};
+
+//Fixed time step frame pacing
+struct FramePacer {
+	uint32_t period;	//microseconds per frame
+	uint32_t next;		//when the next frame is due
+	uint32_t lastFrame;	//when the last frame started
+	int maxSteps;		//if we are further behind than this, the frames in between are dropped
+	FrameStats stats;
+};
+
+void pacerInit(FramePacer &pacer, uint32_t period);
+//Sleeps until the next frame is due. Returns how many periods passed since the last call (usually 1,
+//more if the last frame took too long), so the game can do that many fixed updates.
+int pacerWait(FramePacer &pacer);
+void frameStatsReset(FrameStats &stats);
+uint32_t frameStatsAverage(const FrameStats &stats);
@@ -0,0 +1,74 @@
+#pragma once
+#include <stdint.h>
+#include <sdk/calc/timer.hpp>
+#include <sdk/cpu/tmu.hpp>
+
+//Event tracing
+//TRACE_BEGIN(id) and TRACE_END(id) put an 8 byte record with the raw counter of the timer (see timer.hpp) into a
+//ring in the RAM, that's a read of the counter and a few stores, so it hardly changes the timing that is being
+//measured. When the ring is full the oldest records are overwritten, so it always has the last few frames.
+//
+//  timerInit();
+//  traceInit(4096);
+//  traceName(1, "frame"); traceName(2, "draw");
+//  while(running){
+//      TRACE_BEGIN(1);
+//      ...
+//      TRACE_BEGIN(2); ...draw... TRACE_END(2);
+//      TRACE_END(1);
+//  }
+//  traceSaveFile("\\\\fls0\\app.trace");	//or traceSendSerial()
+//  traceFree();
+//  timerEnd();
+//
+//Then on the PC: python3 tools/trace.py app.trace app.json, and open app.json in chrome://tracing or Perfetto.
+
+enum TraceType : uint8_t {
+	TRACE_TYPE_BEGIN = 0,
+	TRACE_TYPE_END = 1,
+	TRACE_TYPE_INSTANT = 2,
+};
+
+struct TraceRecord {
+	uint32_t ticks;		//timerTicks()
+	uint16_t id;
+	uint8_t type;		//TraceType
+	uint8_t value;		//anything the app wants to see in the trace (the "value" argument in the JSON)
+};
+
+const int TRACE_MAX_NAMES = 64;	//ids below this can have a name
+
+struct TraceRing {
+	TraceRecord *records;
+	uint32_t mask;		//the number of records - 1
+	uint32_t next;		//counts up, the index is next & mask
+};
+
+extern TraceRing traceRing;
+
+//records has to be a power of two. Returns false if there isn't enough memory.
+bool traceInit(int records);
+void traceFree();
+//Forgets all records
+void traceClear();
+//The name the event id gets in the trace (the string isn't copied)
+void traceName(int id, const char *name);
+
+inline void traceRecord(uint16_t id, uint8_t type, uint8_t value){
+	if (traceRing.records == nullptr) return;
+	TraceRecord &record = traceRing.records[traceRing.next++ & traceRing.mask];
+	record.ticks = ~TMU_GetChannel(TIMER_CHANNEL)->TCNT;	//timerTicks(), without the call
+	record.id = id;
+	record.type = type;
+	record.value = value;
+}
+
+#define TRACE_BEGIN(id) traceRecord((id), TRACE_TYPE_BEGIN, 0)
+#define TRACE_END(id) traceRecord((id), TRACE_TYPE_END, 0)
+#define TRACE_INSTANT(id, value) traceRecord((id), TRACE_TYPE_INSTANT, (value))
+
+//The records in the format tools/trace.py reads (all numbers big endian):
+//"TRCE", version (1), timerRate(), n, then the n records from the oldest to the newest (ticks, id, type and
+//value, 8 bytes each), then m and m names: id (16 bit), length (16 bit), the characters padded to 4 bytes.
+void traceSendSerial();
+bool traceSaveFile(const char *path);
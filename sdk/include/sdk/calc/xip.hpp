@@ -0,0 +1,41 @@
+#pragma once
+#include <stdint.h>
+
+//Execute in place: big read only data of .bin apps stays in the flash
+//A .bin is copied into the RAM before it runs, all of it. Data marked XIP_DATA instead stays in the file,
+//the launcher only tells the app where the file is (the flash is mapped into memory). It doesn't take up any
+//RAM, and it doesn't count against the size the app can have:
+//
+//  XIP_DATA static const uint16_t title[320*528] = { ... };
+//  const uint16_t *pixels = xip(title);	//always go through xip(), never use title directly
+//
+//The linker script puts the .xip section at the end of the file and links it at address 0, xip() adds the
+//address of the section in the flash that the launcher stored in xipBase. In a .hhk the section is loaded
+//into the RAM with everything else and xipBase stays 0.
+//A file in the flash isn't always in one piece (see mappedFile.hpp). If the section isn't, the launcher copies it
+//into the RAM after the .bss instead, and refuses to start the app if it doesn't fit there.
+//Don't write to the file while the app runs, the pointers would then point to the old (deleted) data.
+
+#define XIP_DATA __attribute__((section(".xip")))
+
+//Set by the launcher (in the header of the .bin, see app_template/start.s)
+extern "C" uintptr_t xipBase;
+
+template<typename T>
+inline const T *xip(const T *data){
+	return reinterpret_cast<const T*>(xipBase + reinterpret_cast<uintptr_t>(data));
+}
+
+//The header of a .bin at 0x10 (before the name, description, author and version).
+//The first byte is 0, so launchers that don't know it just don't show the name.
+const uint32_t BIN_HEADER_MAGIC = 0x00484842; //"\0HHB"
+
+struct BinHeader {
+	uint32_t magic;
+	uint32_t loadSize;	//the bytes from the start of the file that are loaded into the RAM
+	uint32_t bssSize;	//cleared after them
+	uint32_t xipOffset;	//where the .xip section is in the file
+	uint32_t xipSize;
+	uint32_t xipBase;	//filled in by the launcher: the address of the .xip section in the flash
+	int32_t appFile;	//filled in by the launcher for a .hhk with overlays: the file, open for reading (for overlay.hpp), -1 otherwise
+};
@@ -0,0 +1,148 @@
+/**
+ * @file
+ * @brief Cache maintenance and prefetching.
+ *
+ * The SH7305 has a 32 KiB operand cache (copy-back) and a 32 KiB instruction
+ * cache with 32 byte lines, which don't see each other. Code that was written
+ * with normal stores (e.g. an app or an overlay copied into the RAM) sits in
+ * the operand cache, while the instruction cache may still hold whatever was
+ * at that address before. Call @ref CACHE_SyncCode on it before jumping there.
+ * Memory used by the DMAC needs @ref CACHE_Writeback and @ref CACHE_Purge in
+ * the same way, because the DMAC only sees the memory.
+ *
+ * The range functions only touch addresses that go through the cache: P2
+ * (0xA0000000 to 0xBFFFFFFF) and P4 (from 0xE0000000, with the on-chip RAM)
+ * are left alone.
+ */
+#pragma once
+#include <stdint.h>
+
+/// The size of a cache line in bytes.
+const uint32_t CACHE_LINE_SIZE = 32;
+
+/**
+ * Checks whether accesses to an address go through the cache.
+ *
+ * @param address The (virtual) address.
+ * @return true for P0, P1 and P3, false for P2 and P4.
+ */
+inline bool CACHE_IsCached(uint32_t address) {
+	return (address & 0xE0000000) != 0xA0000000 && address < 0xE0000000;
+}
+
+/**
+ * Writes the dirty operand cache lines of a range back to the memory (ocbwb).
+ * They stay in the cache.
+ *
+ * @param p The start of the range.
+ * @param size The size of the range in bytes.
+ */
+inline void CACHE_Writeback(const void *p, uint32_t size) {
+	uint32_t a = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(p)) & ~(CACHE_LINE_SIZE - 1);
+	uint32_t end = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(p)) + size;
+	if (!CACHE_IsCached(a)) return;
+	for (; a < end; a += CACHE_LINE_SIZE) {
+#ifdef __sh__
+		__asm__ volatile("ocbwb @%0" : : "r"(a) : "memory");
+#endif
+	}
+}
+
+/**
+ * Writes the dirty operand cache lines of a range back and removes them from
+ * the cache (ocbp), so the next read comes from the memory.
+ *
+ * @param p The start of the range.
+ * @param size The size of the range in bytes.
+ */
+inline void CACHE_Purge(const void *p, uint32_t size) {
+	uint32_t a = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(p)) & ~(CACHE_LINE_SIZE - 1);
+	uint32_t end = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(p)) + size;
+	if (!CACHE_IsCached(a)) return;
+	for (; a < end; a += CACHE_LINE_SIZE) {
+#ifdef __sh__
+		__asm__ volatile("ocbp @%0" : : "r"(a) : "memory");
+#endif
+	}
+}
+
+/**
+ * Removes the operand cache lines of a range without writing them back
+ * (ocbi), e.g. before the DMAC writes there.
+ *
+ * Whole lines are dropped: if the range doesn't start and end on a line
+ * boundary, what was written to the rest of the first and last line is lost.
+ *
+ * @param p The start of the range.
+ * @param size The size of the range in bytes.
+ */
+inline void CACHE_Invalidate(void *p, uint32_t size) {
+	uint32_t a = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(p)) & ~(CACHE_LINE_SIZE - 1);
+	uint32_t end = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(p)) + size;
+	if (!CACHE_IsCached(a)) return;
+	for (; a < end; a += CACHE_LINE_SIZE) {
+#ifdef __sh__
+		__asm__ volatile("ocbi @%0" : : "r"(a) : "memory");
+#endif
+	}
+}
+
+/**
+ * Removes the instruction cache lines of a range (icbi), so the code there is
+ * fetched from the memory again.
+ *
+ * @param p The start of the range.
+ * @param size The size of the range in bytes.
+ */
+inline void CACHE_InvalidateCode(const void *p, uint32_t size) {
+	uint32_t a = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(p)) & ~(CACHE_LINE_SIZE - 1);
+	uint32_t end = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(p)) + size;
+	if (!CACHE_IsCached(a)) return;
+	for (; a < end; a += CACHE_LINE_SIZE) {
+#ifdef __sh__
+		register uint32_t line __asm__("r4") = a;
+		// icbi @r4 (SH4A, the assembler only knows it with -m4a)
+		__asm__ volatile(".word 0x04E3" : : "r"(line) : "memory");
+#endif
+	}
+}
+
+/**
+ * Makes code that was just written to a range ready to run: writes it back
+ * from the operand cache and removes the old lines from the instruction
+ * cache.
+ *
+ * @param p The start of the range.
+ * @param size The size of the range in bytes.
+ */
+inline void CACHE_SyncCode(const void *p, uint32_t size) {
+	uint32_t a = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(p)) & ~(CACHE_LINE_SIZE - 1);
+	uint32_t end = static_cast<uint32_t>(reinterpret_cast<uintptr_t>(p)) + size;
+	if (!CACHE_IsCached(a)) return;
+	for (; a < end; a += CACHE_LINE_SIZE) {
+#ifdef __sh__
+		register uint32_t line __asm__("r4") = a;
+		__asm__ volatile(
+			"ocbwb @%0\n\t"
+			".word 0x04E3" // icbi @r4
+			: : "r"(line) : "memory");
+#endif
+	}
+}
+
+/**
+ * Starts loading the cache line of an address into the operand cache (pref)
+ * and goes on at once. Nothing happens for addresses that aren't cached.
+ *
+ * Issue it well before the data is read, e.g. for the next row of an image
+ * while the current one is drawn.
+ *
+ * @param p The address.
+ */
+inline void CACHE_Prefetch(const void *p) {
+#ifdef __sh__
+	__asm__ volatile("pref @%0" : : "r"(p));
+#else
+	(void)p;
+#endif
+}
@@ -0,0 +1,75 @@
+/**
+ * @file
+ * @brief DMAC (Direct Memory Access Controller).
+ *
+ * The SH7305 has 6 DMA channels. All addresses written to the channel
+ * registers must be physical addresses (i.e. with the top 3 bits cleared).
+ */
+#pragma once
+#include <stdint.h>
+
+/**
+ * The registers of one DMA channel.
+ */
+struct DMAC_Channel {
+	/// DMA source address register.
+	volatile uint32_t SAR;
+	/// DMA destination address register.
+	volatile uint32_t DAR;
+	/// DMA transfer count register (in units of the transfer size).
+	volatile uint32_t TCR;
+	/// DMA channel control register.
+	volatile uint32_t CHCR;
+};
+
+/**
+ * Returns the registers of DMA channel @p channel.
+ *
+ * @param channel The channel number, between 0 and 5 inclusive.
+ * @return The channel's registers.
+ */
+inline struct DMAC_Channel *DMAC_GetChannel(int channel) {
+	uint32_t base = channel < 4
+		? 0xFE008020 + channel * 0x10
+		: 0xFE008070 + (channel - 4) * 0x10;
+	return reinterpret_cast<struct DMAC_Channel *>(base);
+}
+
+/// DMA operation register.
+#define DMAC_REG_DMAOR (*reinterpret_cast<volatile uint16_t *>(0xFE008060))
+/// Module stop control register 0 (of the CPG), controls the DMAC's power.
+#define DMAC_REG_MSTPCR0 (*reinterpret_cast<volatile uint32_t *>(0xA4150030))
+
+/// CHCR.DE offset (bits).
+const uint32_t DMAC_CHCR_DE = 0;
+/// CHCR.TE offset (bits).
+const uint32_t DMAC_CHCR_TE = 1;
+/// CHCR.IE offset (bits).
+const uint32_t DMAC_CHCR_IE = 2;
+/// CHCR.TS_0 offset (bits), lower 2 bits of the transfer size.
+const uint32_t DMAC_CHCR_TS_0 = 3;
+/// CHCR.RS offset (bits).
+const uint32_t DMAC_CHCR_RS = 8;
+/// CHCR.SM offset (bits).
+const uint32_t DMAC_CHCR_SM = 12;
+/// CHCR.DM offset (bits).
+const uint32_t DMAC_CHCR_DM = 14;
+/// CHCR.TS_1 offset (bits), upper 2 bits of the transfer size.
+const uint32_t DMAC_CHCR_TS_1 = 20;
+
+/// CHCR.RS value: auto request (memory to memory transfer).
+const uint32_t DMAC_RS_AUTO = 0x4;
+/// CHCR.SM/CHCR.DM value: the address is fixed.
+const uint32_t DMAC_ADDR_FIXED = 0x0;
+/// CHCR.SM/CHCR.DM value: the address is incremented after each unit.
+const uint32_t DMAC_ADDR_INCREMENT = 0x1;
+
+/// DMAOR.DME offset (bits).
+const uint32_t DMAC_DMAOR_DME = 0;
+/// DMAOR.NMIF offset (bits).
+const uint32_t DMAC_DMAOR_NMIF = 1;
+/// DMAOR.AE offset (bits).
+const uint32_t DMAC_DMAOR_AE = 2;
+
+/// MSTPCR0.DMAC0 offset (bits). The DMAC is stopped while this bit is set.
+const uint32_t DMAC_MSTPCR0_DMAC0 = 21;
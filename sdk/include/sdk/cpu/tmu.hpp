@@ -0,0 +1,59 @@
+/**
+ * @file
+ * @brief TMU (Timer Unit) and the RTC's 64 Hz counter.
+ *
+ * The SH7305 has 3 TMU channels. Each one has a 32 bit counter (TCNT) that
+ * counts down at a fraction of the peripheral clock and is reloaded from TCOR
+ * when it underflows.
+ */
+#pragma once
+#include <stdint.h>
+
+/**
+ * The registers of one TMU channel.
+ */
+struct TMU_Channel {
+	/// Timer constant register, loaded into TCNT on an underflow.
+	volatile uint32_t TCOR;
+	/// Timer counter.
+	volatile uint32_t TCNT;
+	/// Timer control register.
+	volatile uint16_t TCR;
+	uint16_t reserved;
+};
+
+/**
+ * Returns the registers of TMU channel @p channel.
+ *
+ * @param channel The channel number, between 0 and 2 inclusive.
+ * @return The channel's registers.
+ */
+inline struct TMU_Channel *TMU_GetChannel(int channel) {
+	return reinterpret_cast<struct TMU_Channel *>(0xA4490008 + channel * 0x0C);
+}
+
+/// Timer start register. Bit n starts channel n.
+#define TMU_REG_TSTR (*reinterpret_cast<volatile uint8_t *>(0xA4490004))
+
+/// TCR.UNF offset (bits), set on an underflow.
+const uint16_t TMU_TCR_UNF = 8;
+/// TCR.UNIE offset (bits), underflow interrupt enable.
+const uint16_t TMU_TCR_UNIE = 5;
+/// TCR.TPSC offset (bits), the prescaler (3 bits).
+const uint16_t TMU_TCR_TPSC = 0;
+
+/// TCR.TPSC value: count at peripheral clock / 4.
+const uint16_t TMU_TPSC_4 = 0;
+/// TCR.TPSC value: count at peripheral clock / 16.
+const uint16_t TMU_TPSC_16 = 1;
+/// TCR.TPSC value: count at peripheral clock / 64.
+const uint16_t TMU_TPSC_64 = 2;
+/// TCR.TPSC value: count at peripheral clock / 256.
+const uint16_t TMU_TPSC_256 = 3;
+/// TCR.TPSC value: count at peripheral clock / 1024.
+const uint16_t TMU_TPSC_1024 = 4;
+
+/// RTC 64 Hz counter. The lower 7 bits count up 128 times per second.
+#define RTC_REG_R64CNT (*reinterpret_cast<volatile uint8_t *>(0xA413FEC0))
+/// How often per second R64CNT counts up.
+const uint32_t RTC_R64CNT_RATE = 128;
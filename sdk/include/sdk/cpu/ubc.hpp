@@ -1,21 +1,41 @@
 /**
  * @file
  * @brief UBC (User Break Controller).
+ *
+ * The UBC has two channels which compare the address (and for channel 1 the
+ * data) of bus cycles and break into the handler in DBR when they match.
+ * Channel 1 can also count matches and only break on every Nth one (CETR1).
  */
 #pragma once
 #include <stdint.h>
 
 /// Match condition setting register 0.
-volatile uint32_t &UBC_REG_CBR0 = *reinterpret_cast<uint32_t *>(0xFF200000);
+#define UBC_REG_CBR0 (*reinterpret_cast<volatile uint32_t *>(0xFF200000))
 /// Match operation setting register 0.
-volatile uint32_t &UBC_REG_CRR0 = *reinterpret_cast<uint32_t *>(0xFF200004);
+#define UBC_REG_CRR0 (*reinterpret_cast<volatile uint32_t *>(0xFF200004))
 /// Match address setting register 0.
-volatile uint32_t &UBC_REG_CAR0 = *reinterpret_cast<uint32_t *>(0xFF200008);
+#define UBC_REG_CAR0 (*reinterpret_cast<volatile uint32_t *>(0xFF200008))
 /// Match address mask setting register 0.
-volatile uint32_t &UBC_REG_CAMR0 = *reinterpret_cast<uint32_t *>(0xFF20000C);
+#define UBC_REG_CAMR0 (*reinterpret_cast<volatile uint32_t *>(0xFF20000C))
+
+/// Match condition setting register 1.
+#define UBC_REG_CBR1 (*reinterpret_cast<volatile uint32_t *>(0xFF200020))
+/// Match operation setting register 1.
+#define UBC_REG_CRR1 (*reinterpret_cast<volatile uint32_t *>(0xFF200024))
+/// Match address setting register 1.
+#define UBC_REG_CAR1 (*reinterpret_cast<volatile uint32_t *>(0xFF200028))
+/// Match address mask setting register 1.
+#define UBC_REG_CAMR1 (*reinterpret_cast<volatile uint32_t *>(0xFF20002C))
+/// Execution count break register 1 (12 bits): channel 1 breaks after this many matches.
+#define UBC_REG_CETR1 (*reinterpret_cast<volatile uint32_t *>(0xFF200038))
+
+/// Channel match flag register. Bit n is set when channel n matched.
+#define UBC_REG_CCMFR (*reinterpret_cast<volatile uint32_t *>(0xFF200600))
 /// Break control register.
-volatile uint32_t &UBC_REG_CBCR = *reinterpret_cast<uint32_t *>(0xFF200620);
+#define UBC_REG_CBCR (*reinterpret_cast<volatile uint32_t *>(0xFF200620))
 
+/// CBR.ETBE offset (bits), execution count break enable (channel 1 only).
+const uint32_t UBC_CBR_ETBE = 11;
 /// CBR.ID offset (bits).
 const uint32_t UBC_CBR_ID = 4;
 /// CBR.RW offset (bits).
@@ -32,3 +52,6 @@ const uint32_t UBC_CRR_BIE = 0;
 
 /// CBCR.UBDE offset (bits).
 const uint32_t UBC_CBCR_UBDE = 0;
+
+/// The largest value of CETR1.
+const uint32_t UBC_CETR1_MAX = 0xFFF;
@@ -0,0 +1,102 @@
+/**
+ * @file
+ * @brief Going through the files in folders (and their subfolders) once, for
+ * several kinds of files at the same time.
+ *
+ * A @ref DirWalker lists each folder with one @ref findFirst of @c "*" and
+ * calls the callback of every pattern that matches an entry, so looking for
+ * @c .hhk and @c .bin files costs one pass instead of one per extension.
+ * Subfolders are walked too, up to a depth given for each folder.
+ *
+ * Example: finding apps in two folders, and in folders in \\fls0\\bin
+ * @code{cpp}
+ * void FoundApp(const char *path, const struct findInfo &info, void *context) {
+ *     // path is the whole path, e.g. "\\fls0\\bin\\game\\game.hhk"
+ * }
+ *
+ * DirWalker walker;
+ * walker.AddPattern(".hhk", FoundApp);
+ * walker.AddPattern(".bin", FoundBin);
+ *
+ * const DirWalkerFolder folders[] = {
+ *     {"\\fls0\\", 0},     // only the files in \fls0
+ *     {"\\fls0\\bin\\", 2} // and two levels of folders in \fls0\bin
+ * };
+ * walker.Walk(folders, 2);
+ * @endcode
+ */
+
+#pragma once
+#include <stdint.h>
+#include <sdk/os/file.hpp>
+
+/// The longest path (including the terminator) of an entry.
+const int DIR_WALKER_MAX_PATH = 200;
+
+/// The number of patterns a walker can have.
+const int DIR_WALKER_MAX_PATTERNS = 8;
+
+/**
+ * The deepest a walk can go below a folder. Every level keeps a find handle
+ * open while its subfolders are walked.
+ */
+const int DIR_WALKER_MAX_DEPTH = 4;
+
+/**
+ * Called for every entry a pattern matches.
+ *
+ * @param path The path of the entry. Only valid during the call.
+ * @param info What @ref findNext returned about the entry.
+ * @param context The context given with the pattern.
+ */
+typedef void (*DirWalkerCallback)(const char *path, const struct findInfo &info, void *context);
+
+/**
+ * Decides if an entry matches, for patterns that aren't an extension.
+ *
+ * @return True if the callback should be called for the entry.
+ */
+typedef bool (*DirWalkerFilter)(const char *path, const struct findInfo &info);
+
+/**
+ * A folder to walk.
+ */
+struct DirWalkerFolder {
+	/// The path of the folder, with or without the backslash at the end.
+	const char *path;
+
+	/// How many levels of subfolders to walk, 0 for only the folder itself.
+	int maxDepth;
+};
+
+class DirWalker {
+public:
+	DirWalker();
+
+	int AddPattern(const char *extension, DirWalkerCallback callback, void *context = nullptr);
+	int AddFilter(DirWalkerFilter filter, DirWalkerCallback callback, void *context = nullptr);
+
+	int Walk(const char *folder, int maxDepth = 0);
+	int Walk(const DirWalkerFolder *folders, int count);
+
+private:
+	struct Pattern {
+		const char *extension;
+		DirWalkerFilter filter;
+		DirWalkerCallback callback;
+		void *context;
+	};
+
+	int Add(const char *extension, DirWalkerFilter filter, DirWalkerCallback callback, void *context);
+	int Match(int length, const struct findInfo &info);
+	int WalkFolder(int length, int depth);
+
+	Pattern m_patterns[DIR_WALKER_MAX_PATTERNS];
+	int m_numPatterns;
+
+	/// The path of the entry or folder being looked at.
+	char m_path[DIR_WALKER_MAX_PATH];
+
+	/// The wide pattern given to findFirst.
+	wchar_t m_findPath[DIR_WALKER_MAX_PATH];
+};
@@ -0,0 +1,76 @@
+/**
+ * @file
+ * @brief A buffered file, on top of the functions in file.hpp.
+ *
+ * Every call to @ref read or @ref write goes through the OS, which costs a lot
+ * more than copying a few bytes. A @ref FileStream reads ahead into a buffer
+ * and collects small writes until it has a whole block, so writing a line of
+ * a CSV log is usually just a copy.
+ *
+ * Example: logging to a file
+ * @code{cpp}
+ * FileStream log;
+ * if (log.Open("\\\\fls0\\log.csv", OPEN_WRITE | OPEN_CREATE | OPEN_APPEND) < 0) {
+ *     // An error occurred calling open
+ * }
+ * log.Write("1,2,3\n", 6);
+ * // closed (and written) when log goes out of scope, or with log.Close()
+ * @endcode
+ */
+
+#pragma once
+#include <stdint.h>
+#include <sdk/os/file.hpp>
+
+/**
+ * The default size of the read-ahead and of the write-behind buffer. Written
+ * blocks are always a multiple of the write-behind size, so the flash doesn't
+ * have to rewrite a sector for every small write.
+ */
+const int FILE_STREAM_BUFFER_SIZE = 4096;
+
+class FileStream {
+public:
+	FileStream();
+	~FileStream();
+
+	FileStream(const FileStream &) = delete;
+	FileStream &operator=(const FileStream &) = delete;
+
+	int Open(
+		const char *path, int flags,
+		int readAhead = FILE_STREAM_BUFFER_SIZE,
+		int writeBehind = FILE_STREAM_BUFFER_SIZE
+	);
+	int Close();
+
+	int Read(void *buf, int count);
+	int ReadLine(char *buf, int size);
+	int ReadU32BE(uint32_t *value);
+
+	int Write(const void *buf, int count);
+	int Flush();
+
+	int Seek(int offset, int whence);
+	int GetAddr(int offset, const void **addr);
+
+	/// The file descriptor, or a negative number if the stream isn't open.
+	int GetFD() const {
+		return m_fd;
+	}
+
+private:
+	int Fill();
+	void DropReadAhead();
+
+	int m_fd;
+
+	int m_readAhead;
+	uint8_t *m_readBuf;
+	int m_readPos;
+	int m_readLen;
+
+	int m_writeBehind;
+	uint8_t *m_writeBuf;
+	int m_writeLen;
+};
@@ -0,0 +1,94 @@
+/**
+ * @file
+ * @brief Using a file in the flash in place, without copying it into the RAM.
+ *
+ * @ref getAddr returns the address of a file's data in the memory, but a file
+ * in the flash isn't always in one piece: after a point it can continue
+ * somewhere else. A @ref MappedFile finds all the contiguous pieces (the
+ * @ref MappedFragment "fragments") once, so the data can be used where it is.
+ *
+ * Example: using a big table without loading it
+ * @code{cpp}
+ * MappedFile file;
+ * if (file.Open("\\\\fls0\\table.bin") < 0) {
+ *     // An error occurred calling open or getAddr
+ * }
+ * // a pointer into the flash, or into scratch if the range crosses the end of
+ * // a fragment
+ * uint8_t scratch[64];
+ * const uint8_t *entry = (const uint8_t *) file.Map(index * 64, 64, scratch);
+ *
+ * // or go through all of it
+ * for (const MappedFragment &fragment : file) {
+ *     // fragment.data, fragment.size
+ * }
+ * @endcode
+ *
+ * The pointers are only valid while the file is open and isn't changed.
+ */
+
+#pragma once
+#include <stdint.h>
+
+/**
+ * The granularity with which a file is checked for fragments. A fragment can
+ * only end at a multiple of this offset (the sector size of the file system).
+ */
+const uint32_t MAPPED_FILE_STEP = 512;
+
+/**
+ * A piece of the file that is contiguous in the memory.
+ */
+struct MappedFragment {
+	/// The offset in the file of the first byte.
+	uint32_t offset;
+
+	/// The number of bytes.
+	uint32_t size;
+
+	/// The address of the first byte.
+	const uint8_t *data;
+};
+
+class MappedFile {
+public:
+	MappedFile();
+	~MappedFile();
+
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	int Open(const char *path);
+	int Close();
+
+	const void *Map(uint32_t offset, uint32_t size, void *scratch) const;
+	int Read(uint32_t offset, void *buf, uint32_t size) const;
+	const MappedFragment *FindFragment(uint32_t offset) const;
+
+	/// The size of the file, in bytes.
+	uint32_t GetSize() const {
+		return m_size;
+	}
+
+	/// The number of fragments of the file, 1 if it's in one piece.
+	int GetNumFragments() const {
+		return m_numFragments;
+	}
+
+	/// The fragments in order, for range-based for loops.
+	const MappedFragment *begin() const {
+		return m_fragments;
+	}
+	const MappedFragment *end() const {
+		return m_fragments + m_numFragments;
+	}
+
+private:
+	int AddFragment(uint32_t offset, const uint8_t *data);
+
+	int m_fd;
+	uint32_t m_size;
+	MappedFragment *m_fragments;
+	int m_numFragments;
+	int m_capacity;
+};
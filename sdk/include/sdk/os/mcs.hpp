@@ -88,6 +88,12 @@ const int MCS_INDEX_OOB = 0x63;
 /**
  * Stores a decimal number. Both the mantissa and exponent are stored in BCD.
  *
+ * The mantissa holds 20 digits, most significant first (the upper nibble of
+ * @c mantissa[0] is the first digit). The value is d0.d1d2d3... times 10 to
+ * the power of the exponent. The exponent is stored as 3 BCD digits, biased by
+ * @ref OBCD_EXPONENT_BIAS, and bit @ref OBCD_NEGATIVE is set for negative
+ * numbers.
+ *
  * See ClassPad 300 SDK documentation for more details.
  */
 struct OBCD {
@@ -95,6 +101,21 @@ struct OBCD {
 	uint16_t exponent;
 };
 
+/**
+ * The value of the (binary, not BCD) exponent of an OBCD that means 10^0.
+ */
+const int OBCD_EXPONENT_BIAS = 500;
+
+/**
+ * Flag in @ref OBCD::exponent that is set for negative numbers.
+ */
+const uint16_t OBCD_NEGATIVE = 0x8000;
+
+/**
+ * The number of digits in the mantissa of an OBCD.
+ */
+const int OBCD_DIGITS = 20;
+
 /**
  * Stores a complex number, with real part @c re and imaginary part @c im.
  *
@@ -3,11 +3,24 @@
  * @brief Functions used for modifying and allocating memory.
  * 
  * Similar to the memory functions provided by the C standard library.
+ *
+ * @ref memcpy, @ref memset, @ref memmove, @ref memset16 and @ref memset32 are
+ * implemented in the SDK (in SH4 assembly, using long word and cache line
+ * stores). The OS versions are still available as @ref OS_memcpy and
+ * @ref OS_memset.
  */
 
 #pragma once
 #include <stdint.h>
 
+// In a HEAP_DEBUG build, malloc and free are counted and tracked by
+// heapMalloc and heapFree (see sdk/calc/heap.hpp). The declarations below
+// then declare those.
+#ifdef HEAP_DEBUG
+#define malloc heapMalloc
+#define free heapFree
+#endif
+
 /**
  * Frees memory allocated by @ref malloc, allowing it to be reused.
  * 
@@ -41,6 +54,18 @@ void *malloc(uint32_t size);
 extern "C"
 void *memcpy(void *destination, const void *source, int num);
 
+/**
+ * Copies one region of memory to another, which may overlap. Equivalent to the
+ * C standard library function with the same name.
+ *
+ * @param[out] destination A pointer to the destination of the copy.
+ * @param[in] source A pointer to the source for the copy.
+ * @param num The number of bytes to copy.
+ * @return @p destination
+ */
+extern "C"
+void *memmove(void *destination, const void *source, int num);
+
 /**
  * Sets a region of memory to a specific value. Equivalent to the C standard
  * library function with the same name.
@@ -55,3 +80,65 @@ void *memcpy(void *destination, const void *source, int num);
  */
 extern "C"
 void *memset(void *ptr, int value, int num);
+
+/**
+ * Fills @p count 16 bit values starting at @p dst with @p value, for example
+ * pixels of the VRAM.
+ *
+ * @param[out] dst A pointer to the region to fill, aligned to 2 bytes.
+ * @param value The value to fill the region with.
+ * @param count The number of 16 bit values to write.
+ * @return @p dst
+ */
+extern "C"
+void *memset16(uint16_t *dst, uint16_t value, int count);
+
+/**
+ * Fills @p count 32 bit values starting at @p dst with @p value.
+ *
+ * @param[out] dst A pointer to the region to fill, aligned to 4 bytes.
+ * @param value The value to fill the region with.
+ * @param count The number of 32 bit values to write.
+ * @return @p dst
+ */
+extern "C"
+void *memset32(uint32_t *dst, uint32_t value, int count);
+
+/**
+ * The OS's implementation of @ref malloc, also in a @c HEAP_DEBUG build.
+ *
+ * @param size The number of bytes of memory to allocate.
+ * @return A pointer to the allocated memory region.
+ */
+extern "C"
+void *OS_malloc(uint32_t size);
+
+/**
+ * The OS's implementation of @ref free, also in a @c HEAP_DEBUG build.
+ *
+ * @param ptr The pointer to the allocated region of memory to free.
+ */
+extern "C"
+void OS_free(void *ptr);
+
+/**
+ * The OS's implementation of @ref memcpy.
+ *
+ * @param[out] destination A pointer to the destination of the copy.
+ * @param[in] source A pointer to the source for the copy.
+ * @param num The number of bytes to copy.
+ * @return @p destination
+ */
+extern "C"
+void *OS_memcpy(void *destination, const void *source, int num);
+
+/**
+ * The OS's implementation of @ref memset.
+ *
+ * @param[out] ptr A pointer to the region of memory to fill.
+ * @param value The value to fill the memory region with.
+ * @param num The number of bytes to fill.
+ * @return @p ptr
+ */
+extern "C"
+void *OS_memset(void *ptr, int value, int num);
@@ -3,6 +3,9 @@
  * @brief String manipulation functions.
  * 
  * For documentation, see the C standard library.
+ *
+ * @ref strlen is implemented in the SDK, the OS version is available as
+ * @ref OS_strlen.
  */
 #pragma once
 
@@ -20,3 +23,6 @@ char *strcpy(char *destination, const char *source);
 
 extern "C"
 int strlen(const char *str);
+
+extern "C"
+int OS_strlen(const char *str);
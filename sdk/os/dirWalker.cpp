@@ -0,0 +1,197 @@
+#include <sdk/os/dirWalker.hpp>
+#include <sdk/os/file.hpp>
+#include <sdk/os/string.hpp>
+
+/**
+ * Creates a walker without any patterns.
+ */
+DirWalker::DirWalker() : m_numPatterns(0) {
+	m_path[0] = '\0';
+}
+
+int DirWalker::Add(const char *extension, DirWalkerFilter filter, DirWalkerCallback callback, void *context) {
+	if (m_numPatterns == DIR_WALKER_MAX_PATTERNS) {
+		return ENOMEM;
+	}
+
+	Pattern &pattern = m_patterns[m_numPatterns++];
+	pattern.extension = extension;
+	pattern.filter = filter;
+	pattern.callback = callback;
+	pattern.context = context;
+	return 0;
+}
+
+/**
+ * Calls @p callback for every file whose name ends with @p extension,
+ * ignoring the case.
+ *
+ * @param[in] extension The end of the name, e.g. @c ".hhk". Must stay valid
+ * while the walker is used.
+ * @param callback The function to call for the files.
+ * @param context Passed to @p callback.
+ * @return 0 on success, or @c ENOMEM if there are
+ * @ref DIR_WALKER_MAX_PATTERNS patterns already.
+ */
+int DirWalker::AddPattern(const char *extension, DirWalkerCallback callback, void *context) {
+	return Add(extension, nullptr, callback, context);
+}
+
+/**
+ * Calls @p callback for every entry, file or folder, that @p filter returns
+ * true for.
+ *
+ * @param filter The function that decides.
+ * @param callback The function to call for the entries.
+ * @param context Passed to @p callback.
+ * @return 0 on success, or @c ENOMEM if there are
+ * @ref DIR_WALKER_MAX_PATTERNS patterns already.
+ */
+int DirWalker::AddFilter(DirWalkerFilter filter, DirWalkerCallback callback, void *context) {
+	return Add(nullptr, filter, callback, context);
+}
+
+static char Lower(char c) {
+	return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+// True if the first length characters of path end with extension
+static bool EndsWith(const char *path, int length, const char *extension) {
+	int n = strlen(extension);
+	if (n > length) {
+		return false;
+	}
+	path += length - n;
+	for (int i = 0; i < n; ++i) {
+		if (Lower(path[i]) != Lower(extension[i])) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Calls the callback of every pattern that matches the entry in m_path.
+// Returns the number of calls.
+int DirWalker::Match(int length, const struct findInfo &info) {
+	bool isFile = info.type == info.EntryTypeFile;
+	int calls = 0;
+	for (int i = 0; i < m_numPatterns; ++i) {
+		const Pattern &pattern = m_patterns[i];
+		if (pattern.extension != nullptr) {
+			if (!isFile || !EndsWith(m_path, length, pattern.extension)) {
+				continue;
+			}
+		} else if (!pattern.filter(m_path, info)) {
+			continue;
+		}
+		pattern.callback(m_path, info, pattern.context);
+		calls++;
+	}
+	return calls;
+}
+
+// Walks the folder in m_path (length characters, ending with a backslash),
+// and its subfolders while depth > 0. Returns the number of callbacks called,
+// or the error of findFirst.
+int DirWalker::WalkFolder(int length, int depth) {
+	// one find for everything in the folder
+	if (length + 2 > DIR_WALKER_MAX_PATH) {
+		return ENAMETOOLONG;
+	}
+	for (int i = 0; i < length; ++i) {
+		m_findPath[i] = m_path[i];
+	}
+	m_findPath[length] = '*';
+	m_findPath[length + 1] = 0;
+
+	int findHandle = -1;
+	wchar_t name[DIR_WALKER_MAX_PATH];
+	struct findInfo info;
+	int ret = findFirst(m_findPath, &findHandle, name, &info);
+	if (ret < 0) {
+		findClose(findHandle);
+		return ret;
+	}
+
+	int calls = 0;
+	for (; ret >= 0; ret = findNext(findHandle, name, &info)) {
+		// the path of the entry (converting the name to a non-wide string in
+		// the process), skipping names that don't fit
+		int entryLength = length;
+		for (int i = 0; name[i] != 0; ++i) {
+			if (entryLength == DIR_WALKER_MAX_PATH - 1) {
+				entryLength = -1;
+				break;
+			}
+			m_path[entryLength++] = name[i];
+		}
+		if (entryLength < 0) {
+			continue;
+		}
+		m_path[entryLength] = '\0';
+
+		calls += Match(entryLength, info);
+
+		if (info.type == info.EntryTypeDirectory && depth > 0 &&
+			strcmp(m_path + length, ".") != 0 && strcmp(m_path + length, "..") != 0 &&
+			entryLength + 1 < DIR_WALKER_MAX_PATH) {
+			m_path[entryLength] = '\\';
+			m_path[entryLength + 1] = '\0';
+			ret = WalkFolder(entryLength + 1, depth - 1);
+			if (ret > 0) {
+				calls += ret;
+			}
+		}
+	}
+
+	findClose(findHandle);
+	m_path[length] = '\0';
+	return calls;
+}
+
+/**
+ * Walks a folder, calling the callbacks of the patterns for its entries.
+ * Folders that can't be listed (and entries with paths longer than
+ * @ref DIR_WALKER_MAX_PATH) are skipped.
+ *
+ * @param[in] folder The path of the folder, e.g. @c "\\fls0\\".
+ * @param maxDepth How many levels of subfolders to walk, at most
+ * @ref DIR_WALKER_MAX_DEPTH.
+ * @return The number of callbacks called, or a negative error code if
+ * @p folder can't be listed.
+ */
+int DirWalker::Walk(const char *folder, int maxDepth) {
+	int length = strlen(folder);
+	if (length + 2 > DIR_WALKER_MAX_PATH) {
+		return ENAMETOOLONG;
+	}
+	strcpy(m_path, folder);
+	if (length == 0 || m_path[length - 1] != '\\') {
+		m_path[length++] = '\\';
+		m_path[length] = '\0';
+	}
+
+	if (maxDepth > DIR_WALKER_MAX_DEPTH) {
+		maxDepth = DIR_WALKER_MAX_DEPTH;
+	}
+	return WalkFolder(length, maxDepth);
+}
+
+/**
+ * Walks several folders one after the other. Folders that can't be listed
+ * (e.g. because they don't exist) are skipped.
+ *
+ * @param[in] folders The folders and how deep to walk each of them.
+ * @param count The number of folders.
+ * @return The number of callbacks called.
+ */
+int DirWalker::Walk(const DirWalkerFolder *folders, int count) {
+	int calls = 0;
+	for (int i = 0; i < count; ++i) {
+		int ret = Walk(folders[i].path, folders[i].maxDepth);
+		if (ret > 0) {
+			calls += ret;
+		}
+	}
+	return calls;
+}
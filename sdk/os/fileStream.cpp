@@ -0,0 +1,308 @@
+#include <sdk/os/fileStream.hpp>
+#include <sdk/os/mem.hpp>
+
+/**
+ * Creates a stream that isn't open yet.
+ */
+FileStream::FileStream() :
+	m_fd(-1),
+	m_readAhead(0), m_readBuf(nullptr), m_readPos(0), m_readLen(0),
+	m_writeBehind(0), m_writeBuf(nullptr), m_writeLen(0) {
+
+}
+
+/**
+ * Closes the stream (writing what's left in the write-behind buffer), if it
+ * is open.
+ */
+FileStream::~FileStream() {
+	Close();
+}
+
+/**
+ * Opens a file, see @ref open.
+ *
+ * The buffers are only allocated when they are first needed, so a stream that
+ * is just used with @ref GetAddr costs no memory. A buffer size of 0 passes
+ * every call straight to the OS.
+ *
+ * @param[in] path The path to the file to open.
+ * @param flags A bitfield describing the mode in which to open the file, see
+ * @ref open_flags_values.
+ * @param readAhead The number of bytes to read at once.
+ * @param writeBehind The number of bytes to collect before writing them. Has
+ * to be a power of two.
+ * @return A file descriptor on success, or a negative error code on failure.
+ */
+int FileStream::Open(const char *path, int flags, int readAhead, int writeBehind) {
+	Close();
+	m_readAhead = readAhead;
+	m_writeBehind = writeBehind;
+	m_fd = open(path, flags);
+	return m_fd;
+}
+
+/**
+ * Writes what's left in the write-behind buffer and closes the file. Does
+ * nothing if the stream isn't open.
+ *
+ * @return 0 on success, or a negative error code on failure.
+ */
+int FileStream::Close() {
+	if (m_fd < 0) {
+		return 0;
+	}
+
+	int ret = Flush();
+	int closeRet = close(m_fd);
+	m_fd = -1;
+
+	if (m_readBuf != nullptr) {
+		free(m_readBuf);
+		m_readBuf = nullptr;
+	}
+	if (m_writeBuf != nullptr) {
+		free(m_writeBuf);
+		m_writeBuf = nullptr;
+	}
+	m_readPos = m_readLen = m_writeLen = 0;
+
+	return ret < 0 ? ret : closeRet;
+}
+
+/**
+ * Refills the read-ahead buffer.
+ *
+ * @return The number of bytes in it, 0 at the end of the file, or a negative
+ * error code on failure.
+ */
+int FileStream::Fill() {
+	if (m_readBuf == nullptr) {
+		m_readBuf = (uint8_t *) malloc(m_readAhead);
+		if (m_readBuf == nullptr) {
+			return ENOMEM;
+		}
+	}
+
+	m_readPos = 0;
+	m_readLen = 0;
+	int ret = read(m_fd, m_readBuf, m_readAhead);
+	if (ret < 0) {
+		return ret;
+	}
+	m_readLen = ret;
+	return ret;
+}
+
+/**
+ * Forgets the bytes that were read ahead, moving the file offset of the OS
+ * back to where the stream is.
+ */
+void FileStream::DropReadAhead() {
+	if (m_readPos < m_readLen) {
+		lseek(m_fd, m_readPos - m_readLen, SEEK_CUR);
+	}
+	m_readPos = m_readLen = 0;
+}
+
+/**
+ * Reads up to @p count bytes, see @ref read.
+ *
+ * @param[out] buf A buffer to place the read bytes into.
+ * @param count The maximum number of bytes to read.
+ * @return The number of bytes read (less than @p count only at the end of the
+ * file), or a negative error code on failure.
+ */
+int FileStream::Read(void *buf, int count) {
+	int ret = Flush();
+	if (ret < 0) {
+		return ret;
+	}
+
+	uint8_t *dest = (uint8_t *) buf;
+	int done = 0;
+	while (done < count) {
+		if (m_readPos < m_readLen) {
+			int chunk = m_readLen - m_readPos;
+			if (chunk > count - done) {
+				chunk = count - done;
+			}
+			memcpy(dest + done, m_readBuf + m_readPos, chunk);
+			m_readPos += chunk;
+			done += chunk;
+			continue;
+		}
+
+		// big reads don't need to go through the buffer
+		if (count - done >= m_readAhead) {
+			ret = read(m_fd, dest + done, count - done);
+			if (ret < 0) {
+				return done > 0 ? done : ret;
+			}
+			return done + ret;
+		}
+
+		ret = Fill();
+		if (ret <= 0) {
+			return (ret < 0 && done == 0) ? ret : done;
+		}
+	}
+	return done;
+}
+
+/**
+ * Reads a line of text, without the line break (@c \\n or @c \\r\\n), and
+ * terminates it. If the line is longer than @p size - 1 characters, the rest
+ * of it is skipped.
+ *
+ * @param[out] buf A buffer for the line.
+ * @param size The size of @p buf.
+ * @return The length of the line, @c EEOF at the end of the file, or a
+ * negative error code on failure.
+ */
+int FileStream::ReadLine(char *buf, int size) {
+	int length = 0;
+	bool any = false;
+	while (true) {
+		char c;
+		int ret = Read(&c, 1);
+		if (ret < 0) {
+			return ret;
+		}
+		if (ret == 0) {
+			if (!any) {
+				return EEOF;
+			}
+			break;
+		}
+		any = true;
+		if (c == '\n') {
+			break;
+		}
+		if (length < size - 1) {
+			buf[length++] = c;
+		}
+	}
+
+	if (length > 0 && buf[length - 1] == '\r') {
+		length--;
+	}
+	if (size > 0) {
+		buf[length] = '\0';
+	}
+	return length;
+}
+
+/**
+ * Reads a big endian 32 bit number.
+ *
+ * @param[out] value The number.
+ * @return 0 on success, @c EEOF if there weren't 4 bytes left, or a negative
+ * error code on failure.
+ */
+int FileStream::ReadU32BE(uint32_t *value) {
+	uint8_t bytes[4];
+	int ret = Read(bytes, sizeof(bytes));
+	if (ret < 0) {
+		return ret;
+	}
+	if (ret < 4) {
+		return EEOF;
+	}
+	*value = ((uint32_t) bytes[0] << 24) | ((uint32_t) bytes[1] << 16) |
+		((uint32_t) bytes[2] << 8) | bytes[3];
+	return 0;
+}
+
+/**
+ * Writes @p count bytes, see @ref write. They are collected in the
+ * write-behind buffer and written to the file once it is full, or by
+ * @ref Flush, @ref Seek or @ref Close.
+ *
+ * @param[in] buf A buffer of bytes to write to the file.
+ * @param count The number of bytes from @c buf to write to the file.
+ * @return @p count on success, or a negative error code on failure.
+ */
+int FileStream::Write(const void *buf, int count) {
+	DropReadAhead();
+
+	const uint8_t *src = (const uint8_t *) buf;
+	int done = 0;
+	if (m_writeBehind > 0 && m_writeBuf == nullptr) {
+		m_writeBuf = (uint8_t *) malloc(m_writeBehind);
+	}
+	if (m_writeBuf == nullptr) {
+		return write(m_fd, buf, count);
+	}
+
+	while (done < count) {
+		if (m_writeLen == 0 && count - done >= m_writeBehind) {
+			// whole blocks go straight to the file
+			int blocks = (count - done) & ~(m_writeBehind - 1);
+			int ret = write(m_fd, src + done, blocks);
+			if (ret < 0) {
+				return ret;
+			}
+			done += blocks;
+			continue;
+		}
+
+		int chunk = m_writeBehind - m_writeLen;
+		if (chunk > count - done) {
+			chunk = count - done;
+		}
+		memcpy(m_writeBuf + m_writeLen, src + done, chunk);
+		m_writeLen += chunk;
+		done += chunk;
+
+		if (m_writeLen == m_writeBehind) {
+			int ret = Flush();
+			if (ret < 0) {
+				return ret;
+			}
+		}
+	}
+	return count;
+}
+
+/**
+ * Writes what's in the write-behind buffer to the file.
+ *
+ * @return 0 on success, or a negative error code on failure.
+ */
+int FileStream::Flush() {
+	if (m_writeLen == 0) {
+		return 0;
+	}
+
+	int ret = write(m_fd, m_writeBuf, m_writeLen);
+	m_writeLen = 0;
+	return ret < 0 ? ret : 0;
+}
+
+/**
+ * Moves the position of the stream, see @ref lseek.
+ *
+ * @param offset The new offset, relative to some point.
+ * @param whence Where @p offset is relative to, see @ref lseek_whence_values.
+ * @return The new position on success, or a negative error code on failure.
+ */
+int FileStream::Seek(int offset, int whence) {
+	int ret = Flush();
+	if (ret < 0) {
+		return ret;
+	}
+	DropReadAhead();
+	return lseek(m_fd, offset, whence);
+}
+
+/**
+ * Retrieves the memory address of the file, see @ref getAddr.
+ *
+ * @param offset An offset to apply to the pointer to the file's data.
+ * @param[out] addr The address of the file's data.
+ * @return 0 on success, or a negative error code on failure.
+ */
+int FileStream::GetAddr(int offset, const void **addr) {
+	return getAddr(m_fd, offset, addr);
+}
@@ -2,5 +2,7 @@
 
 DEFINE_OS_FUNC free 0x800A76FC
 DEFINE_OS_FUNC malloc 0x800CFB00
-DEFINE_OS_FUNC memcpy 0x800A78AC
-DEFINE_OS_FUNC memset 0x800A7FC0
+DEFINE_OS_FUNC OS_free 0x800A76FC
+DEFINE_OS_FUNC OS_malloc 0x800CFB00
+DEFINE_OS_FUNC OS_memcpy 0x800A78AC
+DEFINE_OS_FUNC OS_memset 0x800A7FC0
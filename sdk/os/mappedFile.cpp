@@ -0,0 +1,195 @@
+#include <sdk/os/mappedFile.hpp>
+#include <sdk/os/file.hpp>
+#include <sdk/os/mem.hpp>
+
+/**
+ * Creates a mapping that isn't open yet.
+ */
+MappedFile::MappedFile() :
+	m_fd(-1), m_size(0),
+	m_fragments(nullptr), m_numFragments(0), m_capacity(0) {
+
+}
+
+/**
+ * Closes the file, if it is open.
+ */
+MappedFile::~MappedFile() {
+	Close();
+}
+
+/**
+ * Starts a new fragment, growing the array by doubling it.
+ *
+ * @return 0 on success, or @c ENOMEM.
+ */
+int MappedFile::AddFragment(uint32_t offset, const uint8_t *data) {
+	if (m_numFragments == m_capacity) {
+		int capacity = m_capacity == 0 ? 4 : m_capacity * 2;
+		MappedFragment *fragments = (MappedFragment *) malloc(capacity * sizeof(MappedFragment));
+		if (fragments == nullptr) {
+			return ENOMEM;
+		}
+		if (m_fragments != nullptr) {
+			memcpy(fragments, m_fragments, m_numFragments * sizeof(MappedFragment));
+			free(m_fragments);
+		}
+		m_fragments = fragments;
+		m_capacity = capacity;
+	}
+
+	MappedFragment &fragment = m_fragments[m_numFragments++];
+	fragment.offset = offset;
+	fragment.size = 0;
+	fragment.data = data;
+	return 0;
+}
+
+/**
+ * Opens a file for reading and finds its fragments. Costs one call to
+ * @ref getAddr for every @ref MAPPED_FILE_STEP bytes of the file.
+ *
+ * @param[in] path The path to the file to open.
+ * @return 0 on success, or a negative error code on failure. An empty file
+ * has no fragments.
+ */
+int MappedFile::Open(const char *path) {
+	Close();
+
+	int fd = open(path, OPEN_READ);
+	if (fd < 0) {
+		return fd;
+	}
+	m_fd = fd;
+
+	struct stat info;
+	int ret = fstat(fd, &info);
+	if (ret < 0) {
+		Close();
+		return ret;
+	}
+	m_size = info.fileSize;
+
+	for (uint32_t offset = 0; offset < m_size; offset += MAPPED_FILE_STEP) {
+		const void *addr;
+		ret = getAddr(fd, offset, &addr);
+		if (ret < 0) {
+			Close();
+			return ret;
+		}
+
+		MappedFragment *last = m_numFragments > 0 ? &m_fragments[m_numFragments - 1] : nullptr;
+		if (last == nullptr || last->data + (offset - last->offset) != addr) {
+			ret = AddFragment(offset, (const uint8_t *) addr);
+			if (ret < 0) {
+				Close();
+				return ret;
+			}
+			last = &m_fragments[m_numFragments - 1];
+		}
+
+		uint32_t step = m_size - offset < MAPPED_FILE_STEP ? m_size - offset : MAPPED_FILE_STEP;
+		last->size += step;
+	}
+	return 0;
+}
+
+/**
+ * Closes the file and frees the list of fragments. Does nothing if it isn't
+ * open.
+ *
+ * @return 0 on success, or a negative error code on failure.
+ */
+int MappedFile::Close() {
+	if (m_fragments != nullptr) {
+		free(m_fragments);
+		m_fragments = nullptr;
+	}
+	m_numFragments = m_capacity = 0;
+	m_size = 0;
+
+	if (m_fd < 0) {
+		return 0;
+	}
+	int ret = close(m_fd);
+	m_fd = -1;
+	return ret;
+}
+
+/**
+ * Finds the fragment that contains the byte at @p offset.
+ *
+ * @param offset The offset in the file.
+ * @return The fragment, or @c nullptr if @p offset is outside of the file.
+ */
+const MappedFragment *MappedFile::FindFragment(uint32_t offset) const {
+	if (offset >= m_size) {
+		return nullptr;
+	}
+
+	// binary search for the last fragment that starts at or before offset
+	int low = 0, high = m_numFragments - 1;
+	while (low < high) {
+		int middle = (low + high + 1) >> 1;
+		if (m_fragments[middle].offset <= offset) {
+			low = middle;
+		} else {
+			high = middle - 1;
+		}
+	}
+	return &m_fragments[low];
+}
+
+/**
+ * Returns a pointer to @p size bytes of the file at @p offset. That's the data
+ * in the flash if it's all in one fragment, otherwise it's copied into
+ * @p scratch.
+ *
+ * @param offset The offset in the file.
+ * @param size The number of bytes.
+ * @param[out] scratch A buffer of at least @p size bytes, only used if the
+ * range crosses the end of a fragment.
+ * @return The data, or @c nullptr if the range isn't all in the file.
+ */
+const void *MappedFile::Map(uint32_t offset, uint32_t size, void *scratch) const {
+	if (offset > m_size || size > m_size - offset) {
+		return nullptr;
+	}
+	if (size == 0) {
+		return scratch;
+	}
+
+	const MappedFragment *fragment = FindFragment(offset);
+	if (offset + size <= fragment->offset + fragment->size) {
+		return fragment->data + (offset - fragment->offset);
+	}
+
+	Read(offset, scratch, size);
+	return scratch;
+}
+
+/**
+ * Copies @p size bytes of the file at @p offset to @p buf.
+ *
+ * @param offset The offset in the file.
+ * @param[out] buf The buffer to copy to.
+ * @param size The number of bytes.
+ * @return The number of bytes copied (less than @p size at the end of the
+ * file).
+ */
+int MappedFile::Read(uint32_t offset, void *buf, uint32_t size) const {
+	uint8_t *dest = (uint8_t *) buf;
+	uint32_t done = 0;
+	const MappedFragment *fragment = FindFragment(offset);
+	while (fragment != nullptr && fragment != end() && done < size) {
+		uint32_t start = offset + done - fragment->offset;
+		uint32_t chunk = fragment->size - start;
+		if (chunk > size - done) {
+			chunk = size - done;
+		}
+		memcpy(dest + done, fragment->data + start, chunk);
+		done += chunk;
+		fragment++;
+	}
+	return done;
+}
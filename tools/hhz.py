@@ -0,0 +1,160 @@
+#!/usr/bin/env python3
+"""Pack a .bin app into a compressed .hhz for the launcher.
+
+usage: hhz.py input.bin output.hhz
+
+The part of the .bin that is loaded into the RAM is compressed as one LZ4 block
+(see sdk/include/sdk/calc/lz4.hpp), the launcher decompresses it straight to the
+load address. The name, description, author and version are stored uncompressed
+so the launcher can list the app without decompressing it, and the XIP_DATA
+section (see sdk/include/sdk/calc/xip.hpp) is stored uncompressed so it can stay
+in the flash.
+
+Layout (big endian, everything 4 byte aligned):
+    0   "HHZ1"
+    4   load address
+    8   load size (uncompressed)
+    12  offset of the LZ4 block in the file
+    16  size of the LZ4 block
+    20  .bss size
+    24  offset of the .xip section in the file (0 if there is none)
+    28  .xip size
+    32  flags (1: the .bin has a header, its xipBase has to be filled in)
+    36  name, description, author and version, each zero terminated
+
+Only needs the python standard library.
+"""
+
+import struct
+import sys
+
+HHZ_MAGIC = b"HHZ1"
+BIN_HEADER_MAGIC = 0x00484842
+BIN_HEADER_SIZE = 28
+DEFAULT_LOAD_ADDRESS = 0x8CFF0000
+FLAG_BIN_HEADER = 1
+
+# LZ4 block format limits
+MIN_MATCH = 4
+LAST_LITERALS = 5  # the last 5 bytes are always literals
+MF_LIMIT = 12  # no match may start in the last 12 bytes
+MAX_OFFSET = 0xFFFF
+
+
+def lz4_length(out, length):
+    while length >= 255:
+        out.append(255)
+        length -= 255
+    out.append(length)
+
+
+def lz4_sequence(out, data, literal_start, literal_end, offset, match_length):
+    literal_length = literal_end - literal_start
+    token = min(literal_length, 15) << 4
+    if match_length:
+        token |= min(match_length - MIN_MATCH, 15)
+    out.append(token)
+    if literal_length >= 15:
+        lz4_length(out, literal_length - 15)
+    out += data[literal_start:literal_end]
+    if match_length:
+        out += struct.pack("<H", offset)
+        if match_length - MIN_MATCH >= 15:
+            lz4_length(out, match_length - MIN_MATCH - 15)
+
+
+def lz4_compress(data):
+    """Greedy LZ4 block compression with a hash table of the last position of every 4 bytes."""
+    out = bytearray()
+    n = len(data)
+    table = {}
+    anchor = 0
+    pos = 0
+    match_limit = n - MF_LIMIT
+    while pos < match_limit:
+        key = data[pos:pos + MIN_MATCH]
+        candidate = table.get(key)
+        table[key] = pos
+        if candidate is None or pos - candidate > MAX_OFFSET:
+            pos += 1
+            continue
+
+        length = MIN_MATCH
+        end = n - LAST_LITERALS
+        while pos + length < end and data[candidate + length] == data[pos + length]:
+            length += 1
+
+        lz4_sequence(out, data, anchor, pos, pos - candidate, length)
+        for i in range(pos + 1, min(pos + length, match_limit)):
+            table[data[i:i + MIN_MATCH]] = i
+        pos += length
+        anchor = pos
+
+    lz4_sequence(out, data, anchor, n, 0, 0)
+    return bytes(out)
+
+
+def read_strings(data, pos):
+    """The name, description, author and version like the launcher reads them"""
+    strings = []
+    if pos >= len(data) or not 32 <= data[pos] < 127:
+        return [b""] * 4
+    for _ in range(4):
+        end = data.find(b"\0", pos)
+        if end < 0:
+            end = len(data)
+        strings.append(data[pos:end])
+        pos = end
+        while pos < len(data) and data[pos] == 0:
+            pos += 1
+    return strings
+
+
+def align(data):
+    return data + b"\0" * (-len(data) % 4)
+
+
+def pack(data):
+    load_address = DEFAULT_LOAD_ADDRESS
+    if len(data) >= 0x10 and data[0x0C] == 0x8C:
+        load_address = struct.unpack(">I", data[0x0C:0x10])[0]
+
+    flags = 0
+    load_size = len(data)
+    bss_size = 0
+    xip = b""
+    info = 0x10
+    if len(data) >= 0x10 + BIN_HEADER_SIZE:
+        magic, loaded, bss, xip_offset, xip_size, _, _ = struct.unpack(">7I", data[0x10:0x10 + BIN_HEADER_SIZE])
+        if magic == BIN_HEADER_MAGIC:
+            flags |= FLAG_BIN_HEADER
+            load_size = loaded
+            bss_size = bss
+            xip = data[xip_offset:xip_offset + xip_size]
+            info += BIN_HEADER_SIZE
+
+    strings = align(b"".join(s + b"\0" for s in read_strings(data, info)))
+    block = lz4_compress(data[:load_size])
+
+    header_size = 36
+    block_offset = header_size + len(strings)
+    xip_offset = block_offset + len(align(block)) if xip else 0
+    header = HHZ_MAGIC + struct.pack(
+        ">8I", load_address, load_size, block_offset, len(block), bss_size, xip_offset, len(xip), flags
+    )
+    return header + strings + align(block) + xip
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__.strip().split("\n\n")[1])
+    with open(sys.argv[1], "rb") as f:
+        data = f.read()
+    packed = pack(data)
+    with open(sys.argv[2], "wb") as f:
+        f.write(packed)
+    print("%s: %d -> %d bytes" % (sys.argv[2], len(data), len(packed)))
+
+
+if __name__ == "__main__":
+    main()
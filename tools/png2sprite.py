@@ -0,0 +1,164 @@
+#!/usr/bin/env python3
+"""Convert a png into a sprite header for sdk/include/sdk/calc/blit.hpp.
+
+usage: png2sprite.py [--rle] [--key RRGGBB] [--name NAME] input.png output.hpp
+
+Without --rle the header contains a Bitmap, transparent pixels (alpha < 128) get the
+key color (magenta by default, like BLIT_DEFAULT_KEY). With --rle it contains an
+RleSprite, transparent pixels aren't stored.
+
+Only needs the python standard library. Reads non-interlaced 8 bit pngs
+(grayscale, rgb, palette, with or without alpha).
+"""
+
+import argparse
+import os
+import re
+import struct
+import sys
+import zlib
+
+
+def read_png(path):
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:8] != b"\x89PNG\r\n\x1a\n":
+        sys.exit(path + ": not a png file")
+
+    pos = 8
+    idat = b""
+    palette = []
+    trns = b""
+    while pos < len(data):
+        length, kind = struct.unpack(">I4s", data[pos:pos + 8])
+        chunk = data[pos + 8:pos + 8 + length]
+        pos += 12 + length
+        if kind == b"IHDR":
+            width, height, depth, color_type, _, _, interlace = struct.unpack(">IIBBBBB", chunk)
+        elif kind == b"PLTE":
+            palette = [tuple(chunk[i:i + 3]) for i in range(0, len(chunk), 3)]
+        elif kind == b"tRNS":
+            trns = chunk
+        elif kind == b"IDAT":
+            idat += chunk
+        elif kind == b"IEND":
+            break
+
+    if depth != 8 or interlace != 0:
+        sys.exit(path + ": only non-interlaced 8 bit pngs are supported")
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[color_type]
+
+    raw = zlib.decompress(idat)
+    stride = width * channels
+    rows = []
+    prev = bytearray(stride)
+    for y in range(height):
+        start = y * (stride + 1)
+        filter_type = raw[start]
+        line = bytearray(raw[start + 1:start + 1 + stride])
+        for i in range(stride):
+            a = line[i - channels] if i >= channels else 0
+            b = prev[i]
+            c = prev[i - channels] if i >= channels else 0
+            if filter_type == 1:
+                line[i] = (line[i] + a) & 0xFF
+            elif filter_type == 2:
+                line[i] = (line[i] + b) & 0xFF
+            elif filter_type == 3:
+                line[i] = (line[i] + ((a + b) >> 1)) & 0xFF
+            elif filter_type == 4:
+                p = a + b - c
+                pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+                predictor = a if pa <= pb and pa <= pc else (b if pb <= pc else c)
+                line[i] = (line[i] + predictor) & 0xFF
+        rows.append(line)
+        prev = line
+
+    # convert everything to (r, g, b, a)
+    pixels = []
+    for line in rows:
+        row = []
+        for x in range(width):
+            p = line[x * channels:(x + 1) * channels]
+            if color_type == 0:
+                row.append((p[0], p[0], p[0], 255))
+            elif color_type == 2:
+                row.append((p[0], p[1], p[2], 255))
+            elif color_type == 3:
+                alpha = trns[p[0]] if p[0] < len(trns) else 255
+                row.append(palette[p[0]] + (alpha,))
+            elif color_type == 4:
+                row.append((p[0], p[0], p[0], p[1]))
+            else:
+                row.append(tuple(p))
+        pixels.append(row)
+    return width, height, pixels
+
+
+def rgb565(r, g, b):
+    return ((r & 0xF8) << 8) | ((g & 0xFC) << 3) | (b >> 3)
+
+
+def encode_rle(width, pixels):
+    data = []
+    for row in pixels:
+        runs = []
+        x = 0
+        while x < width:
+            skip = 0
+            while x < width and row[x][3] < 128:
+                skip += 1
+                x += 1
+            if x == width:
+                break
+            run = []
+            while x < width and row[x][3] >= 128:
+                run.append(rgb565(*row[x][:3]))
+                x += 1
+            runs.append((skip, run))
+        data.append(len(runs))
+        for skip, run in runs:
+            data += [skip, len(run)] + run
+    return data
+
+
+def format_array(values):
+    lines = []
+    for i in range(0, len(values), 12):
+        lines.append("\t" + ", ".join("0x%04X" % v for v in values[i:i + 12]) + ",")
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert a png into a sprite header")
+    parser.add_argument("input")
+    parser.add_argument("output")
+    parser.add_argument("--rle", action="store_true", help="write an RleSprite instead of a Bitmap")
+    parser.add_argument("--key", default="FF00FF", help="color of transparent pixels in a Bitmap (RRGGBB)")
+    parser.add_argument("--name", help="name of the variable (default: the file name)")
+    args = parser.parse_args()
+
+    name = args.name or re.sub(r"\W", "_", os.path.basename(args.input).split(".")[0])
+    width, height, pixels = read_png(args.input)
+
+    out = ["//generated by png2sprite.py from " + os.path.basename(args.input) + ", don't edit",
+           "#pragma once",
+           "#include <sdk/calc/blit.hpp>",
+           ""]
+    if args.rle:
+        data = encode_rle(width, pixels)
+        out += ["static const uint16_t %s_data[] = {" % name, format_array(data), "};",
+                "const RleSprite %s = {%d, %d, %s_data};" % (name, width, height, name)]
+    else:
+        key = int(args.key, 16)
+        key = rgb565(key >> 16, (key >> 8) & 0xFF, key & 0xFF)
+        data = [rgb565(*p[:3]) if p[3] >= 128 else key for row in pixels for p in row]
+        out += ["static const uint16_t %s_pixels[] = {" % name, format_array(data), "};",
+                "const Bitmap %s = {%d, %d, %s_pixels};" % (name, width, height, name)]
+
+    with open(args.output, "w") as f:
+        f.write("\n".join(out) + "\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+"""Show where the time went in a profile from sdk/include/sdk/calc/profiler.hpp.
+
+usage: profile.py [--baud BAUD] [--buckets] [--top N] app.hhk profile
+
+profile is a file written by profilerSaveFile(), or a serial port (like
+/dev/ttyUSB0) to read what profilerSendSerial() sends. The samples are summed
+up per function with the symbols of the app's .hhk file (an ELF file).
+
+Only needs the python standard library.
+"""
+
+import argparse
+import bisect
+import os
+import struct
+import sys
+
+BAUD_RATES = {9600: "B9600", 19200: "B19200", 38400: "B38400", 57600: "B57600", 115200: "B115200"}
+
+
+def read_symbols(path):
+    """Returns a sorted list of (address, size, name) of the functions in the ELF file."""
+    with open(path, "rb") as f:
+        data = f.read()
+    if data[:4] != b"\x7fELF" or data[4] != 1:
+        sys.exit(path + ": not a 32 bit ELF file")
+    endian = ">" if data[5] == 2 else "<"
+
+    shoff, = struct.unpack(endian + "I", data[32:36])
+    shentsize, shnum = struct.unpack(endian + "HH", data[46:50])
+    sections = [struct.unpack(endian + "IIIIIIIIII", data[shoff + i * shentsize:shoff + i * shentsize + 40])
+                for i in range(shnum)]
+
+    symbols = []
+    for _, kind, _, _, offset, size, link, _, _, entsize in sections:
+        if kind != 2:  # SHT_SYMTAB
+            continue
+        strtab = sections[link]
+        for pos in range(offset, offset + size, entsize):
+            name, value, symsize, info, _, shndx = struct.unpack(endian + "IIIBBH", data[pos:pos + 16])
+            # functions, and labels of the assembly code that don't have a type
+            if (info & 0xF) not in (0, 2) or shndx == 0 or name == 0:
+                continue
+            start = strtab[4] + name
+            end = data.index(b"\0", start)
+            symbols.append((value, symsize, data[start:end].decode("ascii", "replace")))
+    symbols.sort()
+    return symbols
+
+
+def open_input(path, baud):
+    f = open(path, "rb", buffering=0)
+    if os.isatty(f.fileno()):
+        import termios
+        import tty
+        tty.setraw(f.fileno())
+        attributes = termios.tcgetattr(f.fileno())
+        speed = getattr(termios, BAUD_RATES[baud])
+        attributes[4] = attributes[5] = speed
+        termios.tcsetattr(f.fileno(), termios.TCSANOW, attributes)
+        print("waiting for profilerSendSerial()...", file=sys.stderr)
+    return f
+
+
+def read_exactly(f, count):
+    data = b""
+    while len(data) < count:
+        chunk = f.read(count - len(data))
+        if not chunk:
+            sys.exit("the profile ends too early")
+        data += chunk
+    return data
+
+
+def read_profile(f):
+    # skip anything before the magic (a serial port may have received other things before)
+    window = b""
+    while window != b"PROF":
+        byte = f.read(1)
+        if not byte:
+            sys.exit("no profile found")
+        window = (window + byte)[-4:]
+    version, start, size, shift, period, samples, count = struct.unpack(">7I", read_exactly(f, 28))
+    if version != 1:
+        sys.exit("unknown profile version %d" % version)
+    data = read_exactly(f, count * 8)
+    buckets = [struct.unpack(">II", data[i:i + 8]) for i in range(0, len(data), 8)]
+    return start, size, shift, period, samples, buckets
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Show where the time went in a profile")
+    parser.add_argument("elf", help="the app's .hhk file")
+    parser.add_argument("profile", help="a profile file or a serial port")
+    parser.add_argument("--baud", type=int, default=115200, choices=sorted(BAUD_RATES),
+                        help="baud rate of the serial port (default 115200)")
+    parser.add_argument("--buckets", action="store_true", help="also list every address range with samples")
+    parser.add_argument("--top", type=int, default=30, help="how many functions to list (default 30)")
+    args = parser.parse_args()
+
+    symbols = read_symbols(args.elf)
+    addresses = [s[0] for s in symbols]
+    with open_input(args.profile, args.baud) as f:
+        start, size, shift, period, samples, buckets = read_profile(f)
+
+    totals = {}
+    for address, count in buckets:
+        i = bisect.bisect_right(addresses, address) - 1
+        if i >= 0 and (symbols[i][1] == 0 or address < symbols[i][0] + symbols[i][1]):
+            name = symbols[i][2]
+        else:
+            name = "0x%08X" % address
+        totals[name] = totals.get(name, 0) + count
+
+    print("%d samples, one every %d instructions, 0x%08X-0x%08X in %d byte buckets"
+          % (samples, period, start, start + size - 1, 1 << shift))
+    total = max(samples, 1)
+    for name, count in sorted(totals.items(), key=lambda t: -t[1])[:args.top]:
+        print("%8d %6.2f%%  %s" % (count, 100.0 * count / total, name))
+
+    if args.buckets:
+        print()
+        for address, count in buckets:
+            print("0x%08X %8d" % (address, count))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""Convert a trace from sdk/include/sdk/calc/trace.hpp into Chrome trace JSON.
+
+usage: trace.py [--baud BAUD] trace output.json
+
+trace is a file written by traceSaveFile(), or a serial port (like
+/dev/ttyUSB0) to read what traceSendSerial() sends. Open the JSON in
+chrome://tracing or https://ui.perfetto.dev to see the timeline.
+
+Only needs the python standard library.
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+
+BAUD_RATES = {9600: "B9600", 19200: "B19200", 38400: "B38400", 57600: "B57600", 115200: "B115200"}
+PHASES = {0: "B", 1: "E", 2: "i"}
+
+
+def open_input(path, baud):
+    f = open(path, "rb", buffering=0)
+    if os.isatty(f.fileno()):
+        import termios
+        import tty
+        tty.setraw(f.fileno())
+        attributes = termios.tcgetattr(f.fileno())
+        speed = getattr(termios, BAUD_RATES[baud])
+        attributes[4] = attributes[5] = speed
+        termios.tcsetattr(f.fileno(), termios.TCSANOW, attributes)
+        print("waiting for traceSendSerial()...", file=sys.stderr)
+    return f
+
+
+def read_exactly(f, count):
+    data = b""
+    while len(data) < count:
+        chunk = f.read(count - len(data))
+        if not chunk:
+            sys.exit("the trace ends too early")
+        data += chunk
+    return data
+
+
+def read_trace(f):
+    # skip anything before the magic (a serial port may have received other things before)
+    window = b""
+    while window != b"TRCE":
+        byte = f.read(1)
+        if not byte:
+            sys.exit("no trace found")
+        window = (window + byte)[-4:]
+    version, rate, count = struct.unpack(">3I", read_exactly(f, 12))
+    if version != 1:
+        sys.exit("unknown trace version %d" % version)
+    data = read_exactly(f, count * 8)
+    records = [struct.unpack(">IHBB", data[i:i + 8]) for i in range(0, len(data), 8)]
+
+    names = {}
+    named, = struct.unpack(">I", read_exactly(f, 4))
+    for _ in range(named):
+        id, length = struct.unpack(">HH", read_exactly(f, 4))
+        names[id] = read_exactly(f, (length + 3) & ~3)[:length].decode("ascii", "replace")
+    return rate, records, names
+
+
+def to_json(rate, records, names):
+    events = []
+    ticks = 0
+    last = records[0][0] if records else 0
+    for raw, id, kind, value in records:
+        # the counter wraps around, only the distance to the last record counts
+        ticks += (raw - last) & 0xFFFFFFFF
+        last = raw
+        event = {
+            "name": names.get(id, "event %d" % id),
+            "ph": PHASES.get(kind, "i"),
+            "ts": ticks * 1e6 / max(rate, 1),
+            "pid": 1,
+            "tid": 1,
+        }
+        if kind == 2:
+            event["s"] = "t"
+            event["args"] = {"value": value}
+        events.append(event)
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Convert a trace into Chrome trace JSON")
+    parser.add_argument("trace", help="a trace file or a serial port")
+    parser.add_argument("output", help="the JSON file to write")
+    parser.add_argument("--baud", type=int, default=115200, choices=sorted(BAUD_RATES),
+                        help="baud rate of the serial port (default 115200)")
+    args = parser.parse_args()
+
+    with open_input(args.trace, args.baud) as f:
+        rate, records, names = read_trace(f)
+    with open(args.output, "w") as f:
+        json.dump(to_json(rate, records, names), f)
+    print("%s: %d events" % (args.output, len(records)))
+
+
+if __name__ == "__main__":
+    main()
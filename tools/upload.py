@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+"""Send a .bin app over the serial port straight into the calculator's RAM.
+
+usage: upload.py /dev/ttyUSB0 app.bin
+
+Select "Receive over serial..." in the launcher first. The app is started as
+soon as it has been received, nothing is written to the flash. The protocol is
+described in launcher/upload.hpp: frames of at most 1024 bytes with an Adler-32
+each, which the calculator answers with ACK or NAK.
+
+Only needs the python standard library (termios, so Linux or macOS).
+"""
+
+import os
+import select
+import struct
+import sys
+import termios
+import time
+import zlib
+
+MAGIC = b"HHU1"
+MAX_FRAME = 1024
+FLAG_BIN_HEADER = 1
+ACK = 0x06
+NAK = 0x15
+BIN_HEADER_MAGIC = 0x00484842
+BIN_HEADER_SIZE = 28
+DEFAULT_LOAD_ADDRESS = 0x8CFF0000
+TIMEOUT = 2.0
+RETRIES = 10
+
+
+def parse(data):
+    """Splits a .bin the way the launcher loads it (see launcher/bins.cpp)."""
+    load_address = DEFAULT_LOAD_ADDRESS
+    if len(data) >= 0x10 and data[0x0C] == 0x8C:
+        load_address = struct.unpack(">I", data[0x0C:0x10])[0]
+
+    flags = 0
+    image = data
+    bss_size = 0
+    xip = b""
+    if len(data) >= 0x10 + BIN_HEADER_SIZE:
+        magic, loaded, bss, xip_offset, xip_size, _, _ = struct.unpack(">7I", data[0x10:0x10 + BIN_HEADER_SIZE])
+        if magic == BIN_HEADER_MAGIC:
+            flags |= FLAG_BIN_HEADER
+            image = data[:loaded]
+            bss_size = bss
+            xip = data[xip_offset:xip_offset + xip_size]
+
+    header = MAGIC + struct.pack(">5I", load_address, len(image), bss_size, len(xip), flags)
+    return header, image, xip
+
+
+def open_port(path):
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    attrs = termios.tcgetattr(fd)
+    attrs[0] = 0  # iflag: raw
+    attrs[1] = 0  # oflag
+    attrs[2] = termios.CS8 | termios.CREAD | termios.CLOCAL  # 8N1
+    attrs[3] = 0  # lflag
+    attrs[4] = attrs[5] = termios.B115200
+    attrs[6][termios.VMIN] = 0
+    attrs[6][termios.VTIME] = 0
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    termios.tcflush(fd, termios.TCIOFLUSH)
+    return fd
+
+
+def wait_reply(fd):
+    end = time.monotonic() + TIMEOUT
+    while True:
+        left = end - time.monotonic()
+        if left <= 0:
+            return None
+        ready, _, _ = select.select([fd], [], [], left)
+        if ready:
+            reply = os.read(fd, 1)
+            if reply and reply[0] in (ACK, NAK):
+                return reply[0]
+
+
+def send_frame(fd, sequence, data):
+    frame = struct.pack(">HH", sequence & 0xFFFF, len(data)) + data
+    frame += struct.pack(">I", zlib.adler32(frame))
+    for _ in range(RETRIES):
+        os.write(fd, frame)
+        if wait_reply(fd) == ACK:
+            return
+    sys.exit("no ACK for frame %d, is the launcher waiting for an upload?" % sequence)
+
+
+def main():
+    if len(sys.argv) != 3:
+        sys.exit(__doc__.strip().split("\n\n")[1])
+    with open(sys.argv[2], "rb") as f:
+        header, image, xip = parse(f.read())
+
+    fd = open_port(sys.argv[1])
+    start = time.monotonic()
+    sequence = 0
+    send_frame(fd, sequence, header)
+    # the image and the .xip data never share a frame
+    for part in (image, xip):
+        for offset in range(0, len(part), MAX_FRAME):
+            sequence += 1
+            send_frame(fd, sequence, part[offset:offset + MAX_FRAME])
+            sys.stdout.write("\r%d of %d bytes" % (min(offset + MAX_FRAME, len(part)), len(part)))
+            sys.stdout.flush()
+    os.close(fd)
+    print("\n%s: %d bytes in %.1f s" % (sys.argv[2], len(image) + len(xip), time.monotonic() - start))
+
+
+if __name__ == "__main__":
+    main()